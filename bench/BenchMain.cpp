@@ -0,0 +1,475 @@
+/*
+ * BenchMain.cpp - Headless benchmark for the Pixel Sim Engine
+ *
+ * Runs bgfx with the Noop renderer (no window, no VSync) and drives the
+ * real scenes plus synthetic stress scenes for a fixed number of frames
+ * at a fixed timestep, so results are reproducible between builds.
+ *
+ * Reports per scenario:
+ *   - Frames per second (CPU side: update + render + submit)
+ *   - p50 / p99 frame time over every measured frame
+ *   - Nanoseconds per sprite for the whole render (scene render() calls,
+ *     batching and draw submission, begin() to end())
+ *   - Heap allocations per frame
+ *   - Textures bound per frame
+ *
+ * Scenarios run on the game's streaming batch, which submits sprites in
+ * call order; the "/queued" ones repeat a scene on a queued batch, whose
+ * flush sorts and reorders sprites by texture, to show the swaps saved.
+ * "/recorded" parallax runs without tile grids, so its layers tile sprite
+ * by sprite on worker threads (SpriteBatch::Recorder).
+ *
+ * Also compares the PixelConvert texture-upload kernels against the
+ * per-pixel loops TextureManager used before.
+ *
+ * Usage (from the build directory, next to shaders/bin and assets):
+ *   ./pixel_sim_bench [frames]
+ */
+
+#include <bgfx/bgfx.h>
+#include <bgfx/platform.h>
+
+#include "TextureManager.h"
+#include "SpriteBatch.h"
+#include "Scene.h"
+#include "SailingScene.h"
+#include "PortScene.h"
+#include "OceanSystem.h"
+#include "ParallaxLayer.h"
+#include "FrameArena.h"
+#include "Profiler.h"
+#include "PixelConvert.h"
+#include "LayerCache.h"
+#include "JobSystem.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// -------------------------
+// Allocation counter
+// -------------------------
+static std::atomic<uint64_t> g_allocCount{0};
+
+void* operator new(std::size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// -------------------------
+// Constants
+// -------------------------
+static constexpr uint16_t GAME_W = 640;
+static constexpr uint16_t GAME_H = 360;
+static constexpr uint16_t VIEW_LAYERS = 0;
+static constexpr uint16_t VIEW_GAME = VIEW_LAYERS + LayerCache::DEFAULT_LAYERS;
+static constexpr float FIXED_DT = 1.0f / 60.0f;
+static constexpr uint32_t WARMUP_FRAMES = 60;
+static constexpr uint32_t DEFAULT_FRAMES = 2000;
+
+// Sprite batch a scenario renders with
+enum class BatchSetup {
+    Game,        // Streaming, as src/main.cpp sets it up
+    Queued,      // Layer sort and texture reordering at flush
+    NoTileGrids, // Streaming; parallax layers record on workers instead
+    Count
+};
+
+// Deterministic random numbers for the synthetic scenes
+struct BenchRandom {
+    uint32_t state;
+
+    explicit BenchRandom(uint32_t seed) : state(seed) {}
+
+    float next(float min, float max) {
+        state = state * 1664525u + 1013904223u;
+        return min + (float)(state >> 8) / 16777216.0f * (max - min);
+    }
+};
+
+// -------------------------
+// Synthetic stress scenes
+// -------------------------
+
+// N sprites spread over a few interleaved textures, moving and rotating
+class SpriteStressScene : public Scene {
+public:
+    SpriteStressScene(TextureManager& textures, uint32_t count) {
+        static const uint32_t colors[] = { 0xFFE05050, 0xFF50E050, 0xFF5050E0, 0xFFE0E050 };
+        for (int i = 0; i < 4; ++i) {
+            const std::string name = "bench_sprite_" + std::to_string(i);
+            m_textures.push_back(textures.createTestSpriteSheet(name, 16, 16, 4, { colors[i] }));
+        }
+
+        BenchRandom rng(1234);
+        m_sprites.resize(count);
+        for (Sprite& s : m_sprites) {
+            s.x = rng.next(0, GAME_W);
+            s.y = rng.next(0, GAME_H);
+            s.vx = rng.next(-40, 40);
+            s.vy = rng.next(-40, 40);
+            s.rotation = rng.next(0, 6.28f);
+            s.spin = rng.next(-2, 2);
+        }
+    }
+
+    void update(float dt) override {
+        for (Sprite& s : m_sprites) {
+            s.x += s.vx * dt;
+            s.y += s.vy * dt;
+            s.rotation += s.spin * dt;
+            if (s.x < -16) s.x += GAME_W + 32; else if (s.x > GAME_W + 16) s.x -= GAME_W + 32;
+            if (s.y < -16) s.y += GAME_H + 32; else if (s.y > GAME_H + 16) s.y -= GAME_H + 32;
+        }
+    }
+
+    void render(SpriteBatch& batch, float /*alpha*/) override {
+        const Rect frame(0, 0, 16, 16);
+        for (size_t i = 0; i < m_sprites.size(); ++i) {
+            const Sprite& s = m_sprites[i];
+            batch.drawRegion(m_textures[i % m_textures.size()], s.x, s.y, 12, 12, frame, s.rotation);
+        }
+    }
+
+private:
+    struct Sprite {
+        float x, y, vx, vy, rotation, spin;
+    };
+    std::vector<TextureHandle> m_textures;
+    std::vector<Sprite> m_sprites;
+};
+
+// Ocean swells at a given spawn density
+class SwellStressScene : public Scene {
+public:
+    SwellStressScene(TextureManager& textures, float density) {
+        m_ocean.init(textures);
+        m_ocean.setRegion(0, 160, GAME_W, GAME_H - 160);
+        m_ocean.setSwellDensity(density);
+        m_ocean.setRandomSeed(12345);
+    }
+
+    void update(float dt) override { m_ocean.update(dt); }
+    void render(SpriteBatch& batch, float alpha) override {
+        m_ocean.render(batch, alpha, m_manager ? m_manager->jobs() : nullptr);
+    }
+
+private:
+    OceanSystem m_ocean;
+};
+
+// N full-screen parallax layers
+class ParallaxStressScene : public Scene {
+public:
+    ParallaxStressScene(TextureManager& textures, int layers) {
+        TextureHandle tile = textures.createTestSpriteSheet("bench_tile", 32, 32, 4, 1,
+            [](int frame, int x, int y) -> uint32_t {
+                const uint8_t v = (uint8_t)(((x + frame * 8) ^ y) & 0x3F);
+                return 0x80000000 | (v << 16) | ((v + 64) << 8) | (v + 128);
+            }
+        );
+
+        for (int i = 0; i < layers; ++i) {
+            ParallaxLayer layer;
+            layer.setTexture(tile, 32, 32);
+            layer.setAnimation(4, 0.2f);
+            layer.setScroll(-10.0f - i * 5.0f);
+            layer.setVerticalBob(2.0f, 0.5f, i * 0.1f);
+            m_background.addLayer(layer);
+        }
+    }
+
+    void update(float dt) override { m_background.update(dt, m_manager ? m_manager->jobs() : nullptr); }
+    void render(SpriteBatch& batch, float /*alpha*/) override {
+        m_background.render(batch, 0, 0, GAME_W, GAME_H, m_manager ? m_manager->jobs() : nullptr);
+    }
+
+private:
+    ParallaxBackground m_background;
+};
+
+// -------------------------
+// Pixel conversion kernels
+// -------------------------
+static constexpr size_t CONVERT_PIXELS = 1024 * 1024;
+static constexpr int CONVERT_REPEATS = 20;
+
+// Best-of-N time in milliseconds
+static double timeKernel(const std::function<void()>& kernel) {
+    using Clock = std::chrono::steady_clock;
+    double best = 1e30;
+    for (int i = 0; i < CONVERT_REPEATS; ++i) {
+        const Clock::time_point start = Clock::now();
+        kernel();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+static void reportKernel(const char* name, double baselineMs, double simdMs) {
+    std::printf("%-18s %8.3f ms -> %8.3f ms  (%5.2fx, %6.2f GB/s)\n",
+                name, baselineMs, simdMs, baselineMs / simdMs,
+                CONVERT_PIXELS * 4 / (simdMs * 1e6));
+}
+
+static void runPixelConvertBench() {
+    std::vector<uint8_t> rgba(CONVERT_PIXELS * 4);
+    std::vector<uint8_t> rgb(CONVERT_PIXELS * 3);
+    std::vector<uint8_t> out(CONVERT_PIXELS * 4);
+    BenchRandom rng(99);
+    for (uint8_t& b : rgba) b = (uint8_t)rng.next(0, 256);
+    for (uint8_t& b : rgb) b = (uint8_t)rng.next(0, 256);
+
+    std::printf("PixelConvert (%s), 1024x1024, previous loop -> kernel:\n", PixelConvert::activePath());
+
+    // Old in-place swizzle in load()
+    double baseline = timeKernel([&] {
+        for (size_t i = 0; i < CONVERT_PIXELS; ++i) {
+            uint8_t* p = rgba.data() + i * 4;
+            std::swap(p[0], p[2]);
+        }
+    });
+    double simd = timeKernel([&] { PixelConvert::swapRedBlue(rgba.data(), CONVERT_PIXELS); });
+    reportKernel("swizzle in place", baseline, simd);
+
+    // Old channel-by-channel copy in createFromRGBA()
+    baseline = timeKernel([&] {
+        for (size_t i = 0; i < CONVERT_PIXELS; ++i) {
+            out[i * 4 + 0] = rgba[i * 4 + 2];
+            out[i * 4 + 1] = rgba[i * 4 + 1];
+            out[i * 4 + 2] = rgba[i * 4 + 0];
+            out[i * 4 + 3] = rgba[i * 4 + 3];
+        }
+    });
+    simd = timeKernel([&] { PixelConvert::swapRedBlue(rgba.data(), out.data(), CONVERT_PIXELS); });
+    reportKernel("swizzle copy", baseline, simd);
+
+    // Premultiply and expand modify their input, so each run restores it first
+    baseline = timeKernel([&] {
+        out = rgba;
+        PixelConvert::premultiplyAlphaScalar(out.data(), CONVERT_PIXELS);
+    });
+    simd = timeKernel([&] {
+        out = rgba;
+        PixelConvert::premultiplyAlpha(out.data(), CONVERT_PIXELS);
+    });
+    reportKernel("premultiply+copy", baseline, simd);
+
+    baseline = timeKernel([&] { PixelConvert::expandRGBToRGBAScalar(rgb.data(), out.data(), CONVERT_PIXELS); });
+    simd = timeKernel([&] { PixelConvert::expandRGBToRGBA(rgb.data(), out.data(), CONVERT_PIXELS); });
+    reportKernel("rgb->rgba", baseline, simd);
+    std::printf("\n");
+}
+
+// -------------------------
+// Runner
+// -------------------------
+struct Scenario {
+    const char* name;
+    std::function<std::unique_ptr<Scene>(TextureManager&)> create;
+    BatchSetup batch = BatchSetup::Game;
+};
+
+// Noop parses the platform's native shader profile
+static std::string shader(const char* name) {
+    return Platform::shaderPath(bgfx::getRendererType(), name);
+}
+
+static bool initBatch(SpriteBatch& sprites, BatchSetup setup) {
+    if (!sprites.init(shader("vs_sprite_compact").c_str(), shader("fs_sprite").c_str(),
+                      SpriteBatch::DEFAULT_MAX_SPRITES, SpriteBatch::Geometry::Vertices,
+                      SpriteBatch::VertexFormat::Compact)) {
+        return false;
+    }
+
+    sprites.setStreaming(setup != BatchSetup::Queued);
+    sprites.enableTextureSlots(shader("vs_sprite_slots_compact").c_str(), shader("fs_sprite_slots").c_str());
+    sprites.enableGradients(shader("vs_sprite").c_str(), shader("fs_gradient").c_str());
+    if (setup != BatchSetup::NoTileGrids) {
+        sprites.enableTileGrids(shader("vs_tile_grid").c_str(), shader("fs_sprite").c_str());
+    }
+    return true;
+}
+
+// Nearest-rank percentile in milliseconds (reorders samples)
+static double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0.0;
+    const size_t rank = (size_t)(p / 100.0 * (double)(samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + (std::ptrdiff_t)rank, samples.end());
+    return samples[rank];
+}
+
+static void runScenario(const Scenario& scenario, TextureManager& textures,
+                        SpriteBatch& sprites, LayerCache& layers, JobSystem& jobs,
+                        uint32_t frames) {
+    using Clock = std::chrono::steady_clock;
+    Profiler& profiler = Profiler::get();
+
+    SceneManager scenes;
+    scenes.setLayerCache(&layers);
+    scenes.setJobSystem(&jobs);
+    scenes.switchTo(scenario.create(textures));
+    textures.waitForLoads(); // Measure steady state, not background decoding
+
+    // Profiler keeps only its last HISTORY frames, so the run keeps its own
+    std::vector<double> frameMs;
+    frameMs.reserve(frames);
+
+    double renderMs = 0.0;
+    uint64_t spriteTotal = 0;
+    uint64_t swapTotal = 0;
+    uint64_t allocStart = 0;
+    Clock::time_point start;
+
+    for (uint32_t i = 0; i < WARMUP_FRAMES + frames; ++i) {
+        if (i == WARMUP_FRAMES) {
+            start = Clock::now();
+            allocStart = g_allocCount.load(std::memory_order_relaxed);
+        }
+
+        const Clock::time_point frameStart = Clock::now();
+        profiler.beginFrame();
+        scenes.update(FIXED_DT);
+        layers.render(sprites, FIXED_DT);
+
+        bgfx::setViewRect(VIEW_GAME, 0, 0, GAME_W, GAME_H);
+        bgfx::touch(VIEW_GAME);
+        const Clock::time_point renderStart = Clock::now();
+        sprites.begin(VIEW_GAME, GAME_W, GAME_H);
+        scenes.render(sprites);
+        sprites.end();
+        const Clock::time_point renderEnd = Clock::now();
+        profiler.recordBatch(sprites.getStats());
+
+        {
+            PROFILE_SCOPE(BgfxFrame);
+            bgfx::frame();
+        }
+        profiler.recordArena(FrameArena::get().getStats());
+        FrameArena::get().nextFrame();
+        profiler.endFrame();
+
+        if (i >= WARMUP_FRAMES) {
+            frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count());
+            renderMs += std::chrono::duration<double, std::milli>(renderEnd - renderStart).count();
+            spriteTotal += profiler.lastFrame().sprites;
+            swapTotal += sprites.getStats().textureSwaps;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const uint64_t allocs = g_allocCount.load(std::memory_order_relaxed) - allocStart;
+
+    std::printf("%-20s %8.1f fps  p50 %6.3f ms  p99 %6.3f ms  %7.1f ns/sprite  %7.2f allocs/frame  %7llu sprites/frame  %6.1f swaps/frame\n",
+                scenario.name,
+                frames / seconds,
+                percentile(frameMs, 50.0),
+                percentile(frameMs, 99.0),
+                spriteTotal ? renderMs * 1e6 / (double)spriteTotal : 0.0,
+                (double)allocs / frames,
+                (unsigned long long)(spriteTotal / frames),
+                (double)swapTotal / frames);
+}
+
+int main(int argc, char** argv) {
+    const uint32_t frames = (argc > 1) ? (uint32_t)std::strtoul(argv[1], nullptr, 10) : DEFAULT_FRAMES;
+    if (frames == 0) {
+        std::fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+        return 1;
+    }
+
+    // Single-threaded bgfx: render work is measured inside bgfx::frame()
+    bgfx::renderFrame();
+
+    bgfx::Init init;
+    init.type = bgfx::RendererType::Noop;
+    init.vendorId = BGFX_PCI_ID_NONE;
+    init.resolution.width  = GAME_W;
+    init.resolution.height = GAME_H;
+    init.resolution.reset  = BGFX_RESET_NONE;
+
+    if (!bgfx::init(init)) {
+        std::fprintf(stderr, "bgfx::init failed\n");
+        return 1;
+    }
+
+    int result = 0;
+    {
+        TextureManager textures;
+        LayerCache layers;
+        JobSystem jobs;
+        SpriteBatch batches[(size_t)BatchSetup::Count];
+        textures.enableAtlas();
+
+        bool batchesReady = true;
+        for (size_t i = 0; i < (size_t)BatchSetup::Count; ++i) {
+            batchesReady = batchesReady && initBatch(batches[i], (BatchSetup)i);
+        }
+
+        if (!batchesReady) {
+            std::fprintf(stderr, "Failed to initialize SpriteBatch (run from the build directory).\n");
+            result = 1;
+        } else {
+            layers.init(GAME_W, GAME_H, VIEW_LAYERS);
+
+            const Scenario scenarios[] = {
+                { "sailing",        [](TextureManager& t) { return std::make_unique<SailingScene>(t); } },
+                { "port",           [](TextureManager& t) { return std::make_unique<PortScene>(t); } },
+                { "sprites_1k",     [](TextureManager& t) { return std::make_unique<SpriteStressScene>(t, 1000); } },
+                { "sprites_10k",    [](TextureManager& t) { return std::make_unique<SpriteStressScene>(t, 10000); } },
+                { "swells_50/s",    [](TextureManager& t) { return std::make_unique<SwellStressScene>(t, 50.0f); } },
+                { "swells_500/s",   [](TextureManager& t) { return std::make_unique<SwellStressScene>(t, 500.0f); } },
+                { "parallax_4",     [](TextureManager& t) { return std::make_unique<ParallaxStressScene>(t, 4); } },
+                { "parallax_16",    [](TextureManager& t) { return std::make_unique<ParallaxStressScene>(t, 16); } },
+                { "sailing/queued", [](TextureManager& t) { return std::make_unique<SailingScene>(t); },
+                  BatchSetup::Queued },
+                { "port/queued",    [](TextureManager& t) { return std::make_unique<PortScene>(t); },
+                  BatchSetup::Queued },
+                { "sprites_10k/queued", [](TextureManager& t) { return std::make_unique<SpriteStressScene>(t, 10000); },
+                  BatchSetup::Queued },
+                { "parallax_16/recorded", [](TextureManager& t) { return std::make_unique<ParallaxStressScene>(t, 16); },
+                  BatchSetup::NoTileGrids },
+            };
+
+            runPixelConvertBench();
+
+            std::printf("pixel_sim_bench: %u frames per scenario (+%u warmup), dt %.4f s\n\n",
+                        frames, WARMUP_FRAMES, FIXED_DT);
+            for (const Scenario& scenario : scenarios) {
+                runScenario(scenario, textures, batches[(size_t)scenario.batch], layers, jobs, frames);
+            }
+        }
+
+        layers.shutdown();
+        for (SpriteBatch& sprites : batches) {
+            sprites.shutdown();
+        }
+        textures.clear();
+    }
+
+    bgfx::shutdown();
+    return result;
+}
@@ -2,6 +2,10 @@
 
 #include "SpriteBatch.h"
 #include "TextureManager.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 // Defines a single animation
@@ -66,6 +70,105 @@ struct Animation {
   bool empty() const { return frames.empty(); }
   int frameCount() const { return (int)frames.size(); }
   float totalDuration() const { return frameDuration * frames.size(); }
+
+  // Frame shown `elapsed` seconds into playback: wraps when looping,
+  // holds the last frame otherwise (no state, so any number of sprites
+  // can share one Animation)
+  int frameAt(float elapsed) const {
+    if (frames.empty() || frameDuration <= 0.0f) return 0;
+
+    const int last = frameCount() - 1;
+    if (loop) {
+      const float total = totalDuration();
+      elapsed = std::fmod(elapsed, total);
+      if (elapsed < 0.0f) elapsed += total;
+    } else if (elapsed < 0.0f) {
+      return 0;
+    }
+    return std::min((int)(elapsed / frameDuration), last);
+  }
+};
+
+// Identifies a clip registered with AnimationLibrary
+using AnimationClipId = uint16_t;
+
+// A texture and its frames, shared by every instance playing them
+struct AnimationClip {
+  std::string name;
+  TextureHandle texture;
+  Animation animation;
+};
+
+// Registered clips and the clock they all play against.
+//
+// Ambient animations (water, swells, flags) don't need an update() each:
+// an AnimationInstance stores when it started and how fast it plays, and
+// its frame is derived from the clock when it's drawn.
+//
+// Usage:
+//   AnimationLibrary& clips = AnimationLibrary::get();
+//   AnimationClipId water = clips.add("water", waterTex, Animation::fromGrid(0, 0, 64, 32, 4));
+//   AnimationInstance wave = { water, 1.0f, clips.now() };
+//
+//   clips.advance(dt);              // once per update step (SceneManager::update)
+//   wave.draw(batch, x, y, w, h);   // current frame from the clock
+class AnimationLibrary {
+  public:
+    static AnimationLibrary& get() {
+      static AnimationLibrary library;
+      return library;
+    }
+
+    // Register a clip, or replace the one with the same name (its id is
+    // kept, so scenes can register on every load)
+    AnimationClipId add(const std::string& name, const TextureHandle& texture, const Animation& animation) {
+      for (size_t i = 0; i < m_clips.size(); ++i) {
+        if (m_clips[i].name == name) {
+          m_clips[i].texture = texture;
+          m_clips[i].animation = animation;
+          return (AnimationClipId)i;
+        }
+      }
+      m_clips.push_back({ name, texture, animation });
+      return (AnimationClipId)(m_clips.size() - 1);
+    }
+
+    const AnimationClip& clip(AnimationClipId id) const { return m_clips[id]; }
+    size_t size() const { return m_clips.size(); }
+
+    // Shared clock in seconds
+    void advance(float dt) { m_time += dt; }
+    float now() const { return (float)m_time; }
+
+  private:
+    std::vector<AnimationClip> m_clips;
+    double m_time = 0.0; // Accumulated in double so long sessions don't drift
+};
+
+// Flyweight playback of a registered clip: no per-frame update
+struct AnimationInstance {
+  AnimationClipId clip = 0;
+  float speed = 1.0f;      // Playback rate (1.0 = normal)
+  float startTime = 0.0f;  // Clock time of frame 0 (earlier = further into the clip)
+
+  // Frame at clock time `time` (e.g. now() minus render interpolation lag)
+  int frame(float time) const {
+    const AnimationLibrary& library = AnimationLibrary::get();
+    if (clip >= library.size()) return 0;
+    return library.clip(clip).animation.frameAt((time - startTime) * speed);
+  }
+
+  void draw(SpriteBatch& batch, float x, float y, float width, float height,
+            Color tint = Color::white(), float lagSeconds = 0.0f) const {
+    const AnimationLibrary& library = AnimationLibrary::get();
+    if (clip >= library.size()) return;
+
+    const AnimationClip& c = library.clip(clip);
+    if (c.animation.empty() || !c.texture.isValid()) return;
+
+    const Rect& srcRect = c.animation.frames[frame(library.now() - lagSeconds)];
+    batch.drawRegion(c.texture, x, y, width, height, srcRect, tint);
+  }
 };
 
 // An instance of an animated sprite (tracks playback state)
@@ -95,25 +198,14 @@ class AnimatedSprite {
 
       m_elapsed += deltaTime * m_speed;
 
-      // Calculate current frame
-      float frameDur = m_animation->frameDuration;
-      int totalFrames = m_animation->frameCount();
-
+      // Looping keeps the elapsed time within one cycle
       if (m_animation->loop) {
-        // Loop: wrap around
-        float totalDur = frameDur * totalFrames;
-        while (m_elapsed >= totalDur) {
-          m_elapsed -= totalDur;
-        }
-        m_currentFrame = (int)(m_elapsed / frameDur);
-      } else {
-        // No loop: clamp to last frame
-        m_currentFrame = (int)(m_elapsed / frameDur);
-        if (m_currentFrame >= totalFrames) {
-          m_currentFrame = totalFrames - 1;
-          m_finished = true;
-        }
+        const float totalDur = m_animation->totalDuration();
+        if (totalDur > 0.0f && m_elapsed >= totalDur) m_elapsed = std::fmod(m_elapsed, totalDur);
+      } else if (m_elapsed >= m_animation->totalDuration()) {
+        m_finished = true;
       }
+      m_currentFrame = m_animation->frameAt(m_elapsed);
     }
 
     // Draw at position
@@ -0,0 +1,86 @@
+#pragma once
+
+/*
+ * FileWatcher.h
+ *
+ * Background thread reporting files written under a set of directories
+ * (development tooling: hot reload).
+ *
+ * Linux uses inotify and reports a file once its writer closes it (or an
+ * editor renames its temporary copy over it). Other platforms fall back to
+ * scanning modification times every POLL_INTERVAL_MS.
+ *
+ * Usage:
+ *   FileWatcher watcher;
+ *   watcher.watch("assets");
+ *   watcher.watch("shaders/bin/spirv");
+ *   watcher.start();
+ *
+ *   // Each frame, on the main thread:
+ *   for (const std::string& path : watcher.takeChanges()) {
+ *       // path is "assets/ship.png": the directory as given, then the file
+ *   }
+ *   // The thread is stopped when the watcher is destroyed
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class FileWatcher {
+public:
+    static constexpr uint32_t POLL_INTERVAL_MS = 250; // Scan period without inotify
+
+    FileWatcher() = default;
+    ~FileWatcher();
+
+    // Non-copyable (owns the thread)
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    /**
+     * Watch a directory and its current subdirectories (call before start()).
+     *
+     * @return false if it is not a directory
+     */
+    bool watch(const std::string& directory);
+
+    /**
+     * Start the watcher thread.
+     *
+     * @return false if nothing is watched or the platform watch failed
+     */
+    bool start();
+
+    /**
+     * Stop and join the watcher thread (changes not taken yet are kept).
+     */
+    void stop();
+
+    bool isRunning() const { return m_thread.joinable(); }
+
+    /**
+     * Paths written since the last call, each reported once.
+     */
+    std::vector<std::string> takeChanges();
+
+private:
+    void run();
+    void report(std::string path);
+
+    std::vector<std::string> m_directories;
+#if defined(__linux__)
+    int m_inotify = -1;
+    std::unordered_map<int, std::string> m_watches; // Watch descriptor -> directory
+#endif
+    std::thread m_thread;
+    std::atomic<bool> m_stopping{false};
+
+    std::mutex m_mutex;
+    std::unordered_set<std::string> m_changes;
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+/*
+ * FixedTimestep.h
+ *
+ * Fixed-rate simulation clock for the main loop.
+ *
+ * Frame time is accumulated and consumed in whole steps, so the
+ * simulation advances identically regardless of display rate. A cap on
+ * steps per frame keeps a long stall from turning into a burst of
+ * updates; the leftover fraction of a step is the render interpolation
+ * alpha (0 = previous step's state, 1 = current).
+ *
+ * Usage:
+ *   FixedTimestep timestep(1.0f / 30.0f);   // 30 Hz sim at any frame rate
+ *
+ *   // Each frame:
+ *   const int steps = timestep.advance(frameSeconds);
+ *   for (int i = 0; i < steps; ++i) {
+ *       scenes.update(timestep.step());
+ *   }
+ *   scenes.render(batch, timestep.alpha());
+ */
+
+#include <cmath>
+#include <cstdint>
+
+class FixedTimestep {
+public:
+    static constexpr float DEFAULT_STEP = 1.0f / 60.0f;
+    static constexpr int DEFAULT_MAX_STEPS = 5;
+
+    /**
+     * @param stepSeconds Simulation step (e.g. 1/60 or 1/30)
+     * @param maxSteps Steps run per frame at most; time beyond that is dropped
+     */
+    explicit FixedTimestep(float stepSeconds = DEFAULT_STEP, int maxSteps = DEFAULT_MAX_STEPS)
+        : m_step(stepSeconds > 0.0f ? stepSeconds : DEFAULT_STEP),
+          m_maxSteps(maxSteps > 0 ? maxSteps : 1) {}
+
+    /**
+     * Add a frame's elapsed time.
+     *
+     * @param frameSeconds Wall-clock time since the previous frame (negative is ignored)
+     * @return Number of step() sized updates to run this frame (0..maxSteps)
+     */
+    int advance(float frameSeconds) {
+        if (frameSeconds > 0.0f) m_accumulator += frameSeconds;
+
+        int steps = (int)std::floor(m_accumulator / m_step);
+        m_accumulator -= (float)steps * m_step;
+        if (m_accumulator < 0.0f) m_accumulator = 0.0f; // Rounding
+
+        // Falling behind: run the cap and let the rest of the stall go
+        if (steps > m_maxSteps) {
+            m_droppedSteps += (uint64_t)(steps - m_maxSteps);
+            steps = m_maxSteps;
+        }
+        return steps;
+    }
+
+    /**
+     * Forget accumulated time (e.g. after a load screen).
+     */
+    void reset() { m_accumulator = 0.0f; }
+
+    float step() const { return m_step; }
+    int maxSteps() const { return m_maxSteps; }
+
+    // Fraction of the next step already elapsed (0..1)
+    float alpha() const { return std::fmin(m_accumulator / m_step, 1.0f); }
+
+    // Steps skipped by the per-frame cap since construction
+    uint64_t droppedSteps() const { return m_droppedSteps; }
+
+private:
+    float m_step;
+    int m_maxSteps;
+    float m_accumulator = 0.0f;
+    uint64_t m_droppedSteps = 0;
+};
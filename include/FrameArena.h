@@ -0,0 +1,143 @@
+#pragma once
+
+/*
+ * FrameArena.h
+ *
+ * Bump allocator for data that only lives for a frame (sort keys,
+ * scratch arrays, staging copies).
+ *
+ * Two buffers alternate: nextFrame() switches to the other one and
+ * resets it, so memory from frame N stays valid until frame N + 2 starts.
+ * That covers memory handed to bgfx::makeRef(), which the render thread
+ * reads one frame later. Nothing is freed individually.
+ *
+ * When a frame needs more than the buffer holds, the rest comes from the
+ * heap (counted in Stats::heapAllocations) and the buffer grows the next
+ * time it is reset, so a steady-state frame ends up allocating nothing.
+ *
+ * Usage:
+ *   FrameArena& arena = FrameArena::get();
+ *
+ *   // Anywhere during the frame (thread-safe):
+ *   float* keys = arena.allocateArray<float>(count);
+ *   FrameVector<uint32_t> order;          // vector backed by the arena
+ *   order.reserve(count);                 // growing wastes the old block
+ *
+ *   // Once per frame, after bgfx::frame():
+ *   profiler.recordArena(arena.getStats());
+ *   arena.nextFrame();
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class FrameArena {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 20; // Per buffer
+
+    // Usage of the current frame
+    struct Stats {
+        uint32_t allocations = 0;     // allocate() calls
+        uint32_t heapAllocations = 0; // Calls the buffer couldn't hold
+        size_t bytesUsed = 0;         // Including heap fallbacks
+        size_t capacity = 0;          // Of the current buffer
+    };
+
+    // The engine-wide arena, reset by the main loop
+    static FrameArena& get();
+
+    /**
+     * @param capacity Bytes per buffer (grows on demand)
+     */
+    explicit FrameArena(size_t capacity = DEFAULT_CAPACITY);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * Allocate memory valid until the second nextFrame() from now.
+     * Safe to call from any thread, but not concurrently with nextFrame().
+     *
+     * @param alignment Power of two
+     */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * Uninitialized storage for `count` objects of a trivially
+     * destructible type (destructors never run).
+     */
+    template<typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    /**
+     * Switch to the other buffer and reset it, growing it if it overflowed
+     * two frames ago. Call once per frame on the main thread after
+     * bgfx::frame(), with no allocations in flight.
+     */
+    void nextFrame();
+
+    Stats getStats() const;
+
+private:
+    struct HeapBlock {
+        void* data;
+        size_t alignment;
+    };
+
+    struct Buffer {
+        std::unique_ptr<std::byte[]> data;
+        size_t capacity = 0;
+        std::atomic<size_t> used{0};
+        size_t heapBytes = 0;               // Guarded by m_heapMutex
+        std::vector<HeapBlock> heapBlocks;  // Freed on reset
+    };
+
+    void* allocateHeap(Buffer& buffer, size_t size, size_t alignment);
+    void reset(Buffer& buffer);
+
+    Buffer m_buffers[2];
+    uint32_t m_current = 0;
+    std::atomic<uint32_t> m_allocations{0};
+    std::atomic<uint32_t> m_heapAllocations{0};
+    std::mutex m_heapMutex;
+};
+
+/**
+ * STL allocator drawing from a FrameArena (the engine's by default).
+ * deallocate() is a no-op, so containers must not outlive the frame
+ * after next; reserve() up front since growing leaves the old block behind.
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() noexcept : m_arena(&FrameArena::get()) {}
+    explicit ArenaAllocator(FrameArena& arena) noexcept : m_arena(&arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : m_arena(other.arena()) {}
+
+    T* allocate(size_t count) { return m_arena->allocateArray<T>(count); }
+    void deallocate(T*, size_t) noexcept {}
+
+    FrameArena* arena() const noexcept { return m_arena; }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return m_arena == other.arena(); }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return m_arena != other.arena(); }
+
+private:
+    FrameArena* m_arena;
+};
+
+template<typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
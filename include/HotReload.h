@@ -0,0 +1,105 @@
+#pragma once
+
+/*
+ * HotReload.h
+ *
+ * Development mode: picks up edited textures and shaders while the game
+ * runs, without a restart.
+ *   - PNGs written under the texture directory are decoded again and
+ *     uploaded over their existing textures (TextureManager::reload), so
+ *     every TextureHandle held by scenes stays valid. The watched directory
+ *     can be the source tree's while the game loads a copy: changes map
+ *     back to the paths textures were loaded with through textureKeyDir
+ *   - A changed .sc source runs the shader rebuild command on a background
+ *     thread; the compiled binaries it writes (or any written by hand) make
+ *     SpriteBatch swap in fresh programs between frames
+ *
+ * Usage:
+ *   textures.enableHotReload(); // Before loading anything
+ *
+ *   HotReload hotReload;
+ *   HotReload::Config config;
+ *   config.textureDir = "/path/to/repo/assets"; // Loaded as "assets/..."
+ *   config.shaderDir = Platform::shaderDirectory(platform.renderer());
+ *   config.shaderSourceDir = "../shaders";
+ *   config.rebuildCommand = "cmake --build . --target shaders";
+ *   hotReload.init(config, textures, sprites);
+ *
+ *   // Each frame, outside sprites.begin()/end():
+ *   if (hotReload.update()) layerCache.invalidateAll();
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class FileWatcher;
+class SpriteBatch;
+class TextureManager;
+
+class HotReload {
+public:
+    // Quiet time after the last compiled shader write before programs are swapped
+    // (longer than FileWatcher::POLL_INTERVAL_MS, so a scan can't split a rebuild)
+    static constexpr int SHADER_SETTLE_MS = 300;
+
+    struct Config {
+        std::string textureDir = "assets";    // PNGs, watched recursively
+        std::string textureKeyDir = "assets"; // Same files as loaded (TextureManager paths)
+        std::string shaderDir;             // Compiled shaders of the running renderer (empty = off)
+        std::string shaderSourceDir;       // .sc sources (empty = no rebuilds)
+        std::string rebuildCommand;        // Run through the shell when a source changes
+    };
+
+    HotReload();
+    ~HotReload();
+
+    // Non-copyable (owns threads)
+    HotReload(const HotReload&) = delete;
+    HotReload& operator=(const HotReload&) = delete;
+
+    /**
+     * Start watching (call after the batch's programs are loaded).
+     *
+     * @return true if at least one directory is being watched
+     */
+    bool init(const Config& config, TextureManager& textures, SpriteBatch& sprites);
+
+    /**
+     * Stop the watcher and rebuild threads (waits for a running rebuild).
+     */
+    void shutdown();
+
+    /**
+     * Apply changes seen since the last call (main thread, between frames).
+     *
+     * @return true if any texture or program was replaced
+     */
+    bool update();
+
+private:
+    void requestRebuild();
+    void rebuildLoop();
+
+    using Clock = std::chrono::steady_clock;
+
+    Config m_config;
+    TextureManager* m_textures = nullptr;
+    SpriteBatch* m_sprites = nullptr;
+
+    std::unique_ptr<FileWatcher> m_watcher;
+    bool m_shadersDirty = false;
+    Clock::time_point m_shaderWriteTime;
+
+    // Shader rebuilds (one at a time; requests during a build coalesce)
+    std::thread m_builder;
+    std::mutex m_buildMutex;
+    std::condition_variable m_buildRequested;
+    bool m_rebuildPending = false;
+    bool m_stopping = false;
+    std::atomic<bool> m_building{false};
+};
@@ -0,0 +1,164 @@
+#pragma once
+
+/*
+ * JobSystem.h
+ *
+ * Work-stealing job scheduler for short, CPU-bound frame work
+ * (scene and subsystem updates). Blocking work such as file IO belongs
+ * on a ThreadPool instead, so it never stalls a frame's jobs.
+ *
+ * Each worker owns a queue: it runs its own newest job first and steals
+ * the oldest job from another queue when it runs dry. The thread that
+ * waits on a graph or parallelFor() runs jobs too, so nested waits
+ * inside jobs can't deadlock.
+ *
+ * Usage:
+ *   JobSystem jobs;                      // hardware threads - 1 workers
+ *
+ *   TaskGraph graph;                     // build once, run every frame
+ *   auto ocean  = graph.add([&] { ocean.update(dt); });
+ *   auto spray  = graph.add([&] { updateSpray(dt); });
+ *   auto spawn  = graph.add([&] { spawnSpray(); });
+ *   graph.precede(spray, spawn);         // spawn runs after spray
+ *   jobs.run(graph);                     // returns when every task is done
+ *
+ *   jobs.parallelFor(layers.size(), 1, [&](size_t begin, size_t end) { ... });
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * A set of tasks and the order constraints between them.
+ * Tasks without a path between them may run concurrently.
+ */
+class TaskGraph {
+public:
+    using TaskId = uint32_t;
+
+    /**
+     * Add a task.
+     *
+     * @return Id for precede()
+     */
+    TaskId add(std::function<void()> task);
+
+    /**
+     * Make `after` wait until `before` has finished.
+     */
+    void precede(TaskId before, TaskId after);
+
+    void clear();
+    size_t size() const { return m_tasks.size(); }
+    bool empty() const { return m_tasks.empty(); }
+
+private:
+    friend class JobSystem;
+
+    struct Task {
+        std::function<void()> run;
+        std::vector<TaskId> successors;
+        uint32_t dependencies = 0;
+    };
+
+    // True if every task is reachable without a cycle (checked once per edit)
+    bool isAcyclic();
+
+    std::vector<Task> m_tasks;
+
+    // Run state, reused so running a built graph doesn't allocate
+    std::unique_ptr<std::atomic<uint32_t>[]> m_pending; // Unfinished dependencies per task
+    size_t m_pendingSize = 0;
+    int m_acyclic = -1; // -1 = not checked since the last edit
+};
+
+class JobSystem {
+public:
+    /**
+     * @param workerCount Worker threads (0 = hardware threads - 1, which
+     *                    may be none; the waiting thread always helps)
+     */
+    explicit JobSystem(size_t workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * Run every task of a graph, respecting precede() order, and return
+     * once all have finished. A graph with a cycle is rejected (nothing runs).
+     * A graph must not be run by two threads at once.
+     *
+     * @return false if the graph has a cycle
+     */
+    bool run(TaskGraph& graph);
+
+    /**
+     * Run body(begin, end) over [0, count) in chunks of `grain` indices
+     * and return once every chunk is done. The body is called through a
+     * reference (never copied), so capturing lambdas don't allocate.
+     */
+    template<typename Body>
+    void parallelFor(size_t count, size_t grain, Body&& body) {
+        using Fn = std::remove_reference_t<Body>;
+        auto call = [](void* context, size_t begin, size_t end) {
+            (*static_cast<Fn*>(context))(begin, end);
+        };
+        parallelFor(count, grain, call, const_cast<void*>(static_cast<const void*>(std::addressof(body))));
+    }
+
+    size_t workerCount() const { return m_workers.size(); }
+
+private:
+    // Queued unit of work; points at state owned by the waiting caller
+    struct Job {
+        void (*execute)(void* context, uint32_t index);
+        void* context;
+        uint32_t index;
+    };
+
+    // Ring buffer of jobs; grows when full and keeps its storage, so a
+    // steady frame queues without allocating
+    struct alignas(64) Queue {
+        static constexpr size_t INITIAL_CAPACITY = 256;
+
+        std::mutex mutex;
+        std::vector<Job> jobs = std::vector<Job>(INITIAL_CAPACITY);
+        size_t head = 0;  // Oldest job
+        size_t count = 0;
+
+        void pushBack(const Job& job);
+        Job popBack();
+        Job popFront();
+    };
+
+    using ForBody = void (*)(void* context, size_t begin, size_t end);
+
+    struct GraphRun;
+    struct ForRun;
+    static void runTask(void* context, uint32_t index);
+    static void runChunk(void* context, uint32_t index);
+    void parallelFor(size_t count, size_t grain, ForBody body, void* context);
+
+    void push(const Job& job);
+    bool pop(Job& job);
+    void helpUntilDone(const std::atomic<uint32_t>& remaining);
+    void workerLoop(size_t index);
+    size_t currentQueue() const;
+
+    std::vector<std::thread> m_workers;
+    std::vector<std::unique_ptr<Queue>> m_queues; // One per worker, then one for other threads
+    std::atomic<size_t> m_queued{0};
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+/*
+ * LayerCache.h
+ *
+ * Render-target cache for static or slowly changing scene layers.
+ *
+ * A layer is drawn once into its own framebuffer and composited into the
+ * frame as a single sprite until it is invalidated (or its refresh
+ * interval elapses), so unchanged backdrops cost one quad per frame.
+ *
+ * Usage:
+ *   LayerCache cache;
+ *   cache.init(640, 360, VIEW_LAYERS);
+ *   scenes.setLayerCache(&cache);
+ *
+ *   // In a scene's onEnter():
+ *   m_backdrop = cache->acquire([this](SpriteBatch& b) { drawBackdrop(b); });
+ *
+ *   // Each frame, outside begin()/end() and before the game view:
+ *   cache.render(batch, dt);
+ *
+ *   // In the scene's render() (optionally just the covered region):
+ *   cache->draw(batch, m_backdrop);
+ *
+ *   // In onExit():
+ *   cache->release(m_backdrop);
+ *
+ * Layers store straight alpha: exact for opaque and cut-out pixel art,
+ * partially transparent pixels composite slightly darker.
+ */
+
+#include "SpriteBatch.h"
+#include "TextureManager.h"
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class LayerCache {
+public:
+    // Draws the layer's content (the batch is already begun on the layer's view)
+    using DrawFunc = std::function<void(SpriteBatch& batch)>;
+
+    static constexpr uint16_t DEFAULT_LAYERS = 4;
+
+    LayerCache() = default;
+    ~LayerCache();
+
+    LayerCache(const LayerCache&) = delete;
+    LayerCache& operator=(const LayerCache&) = delete;
+
+    /**
+     * Create the layer render targets.
+     *
+     * @param width, height Size of every layer (normally the game canvas)
+     * @param firstView First of `layers` consecutive views used for
+     *                  redraws; they must come before the view they are
+     *                  composited into
+     * @param layers Number of layers that can be held at once
+     * @return true on success
+     */
+    bool init(uint16_t width, uint16_t height, bgfx::ViewId firstView,
+              uint16_t layers = DEFAULT_LAYERS);
+
+    void shutdown();
+
+    /**
+     * Take a free layer. It is drawn on the next render().
+     *
+     * @param draw Fills the layer (call sites usually capture the scene)
+     * @param refreshSeconds Redraw interval for low-frequency content
+     *                       (0 = static, only redrawn when invalidated)
+     * @return Layer id, or -1 if every layer is taken (draw directly instead)
+     */
+    int acquire(DrawFunc draw, float refreshSeconds = 0.0f);
+
+    /**
+     * Give a layer back (no-op for -1 or after shutdown).
+     */
+    void release(int layer);
+
+    /**
+     * Redraw a layer on the next render() (e.g. after its textures changed).
+     */
+    void invalidate(int layer);
+    void invalidateAll();
+
+    /**
+     * Redraw every layer that is dirty or due for a refresh.
+     * Call once per frame outside SpriteBatch begin()/end().
+     */
+    void render(SpriteBatch& batch, float dt);
+
+    /**
+     * Composite a whole layer over the canvas as one sprite.
+     */
+    void draw(SpriteBatch& batch, int layer, Color tint = Color::white()) const;
+
+    /**
+     * Composite only `region` of a layer (canvas pixels, drawn in place).
+     * Saves fill when the layer's content covers part of the canvas.
+     */
+    void draw(SpriteBatch& batch, int layer, const Rect& region,
+              Color tint = Color::white()) const;
+
+    bool isValid(int layer) const;
+
+    /**
+     * Texture holding a layer's last redraw (invalid handle for a bad id).
+     */
+    TextureHandle texture(int layer) const;
+
+    // Layer redraws since init (each costs one begin()/end() on its own view)
+    uint32_t redrawCount() const { return m_redraws; }
+
+private:
+    struct Layer {
+        bgfx::FrameBufferHandle framebuffer = BGFX_INVALID_HANDLE;
+        TextureHandle texture;
+        DrawFunc draw;
+        float refreshSeconds = 0.0f;
+        float refreshTimer = 0.0f;
+        bool inUse = false;
+        bool dirty = false;
+    };
+
+    std::vector<Layer> m_layers;
+    uint16_t m_width = 0;
+    uint16_t m_height = 0;
+    bgfx::ViewId m_firstView = 0;
+    uint32_t m_redraws = 0;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+/*
+ * MappedFile.h
+ *
+ * Read-only memory-mapped file (mmap on POSIX, file mapping on Windows).
+ *
+ * Usage:
+ *   MappedFile file;
+ *   if (file.open("assets/textures.cooked")) {
+ *       const uint8_t* bytes = file.data();
+ *       size_t size = file.size();
+ *   }
+ *   // Unmapped when closed or destroyed
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // Non-copyable (owns the mapping)
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Move-able
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * Map a whole file read-only.
+     *
+     * @return true on success (an empty file fails)
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+};
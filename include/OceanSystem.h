@@ -20,9 +20,12 @@
 #include "TextureManager.h"
 #include "Animation.h"
 #include "SpriteBatch.h"
+#include "ParticleSystem.h"
 #include <vector>
 #include <string>
 
+class JobSystem;
+
 // Configuration for a swell type
 struct SwellType {
   std::string texturePath;
@@ -64,6 +67,11 @@ class OceanSystem {
      * Set base water color (drawn behind swells).
      */
     void setBaseColor(Color topColor, Color bottomColor);
+    
+    /**
+     * Quantize the base gradient into dithered color bands (0 = smooth).
+     */
+    void setBaseBands(uint8_t bands) { m_baseBands = bands; }
 
     /**
      * Set how busy the ocean is.
@@ -76,6 +84,11 @@ class OceanSystem {
      */
     void setScrollSpeed(float multiplier) { m_speedMultiplier = multiplier; }
 
+    /**
+     * Reseed swell spawning (same seed = same sequence of swells).
+     */
+    void setRandomSeed(unsigned int seed) { m_randomSeed = seed; }
+
     /**
      * Add a custom swell type.
      */
@@ -83,8 +96,9 @@ class OceanSystem {
 
     /**
      * Clear all swell types (to replace with custom ones).
+     * Active swells are removed with them.
      */
-    void clearSwellTypes() { m_swellTypes.clear(); }
+    void clearSwellTypes();
 
     /**
      * Update swell spawning and movement.
@@ -93,31 +107,23 @@ class OceanSystem {
 
     /**
      * Render the ocean.
+     *
+     * @param alpha Interpolation between the last two updates (1 = latest);
+     *              swells are drawn (1 - alpha) of the last step behind
+     * @param jobs When given, large swell counts are recorded in parallel
+     *             (see ParticleSystem::render), still back to front
      */
-    void render(SpriteBatch& batch);
+    void render(SpriteBatch& batch, float alpha = 1.0f, JobSystem* jobs = nullptr);
 
     /**
      * Get number of active swells (for debugging).
      */
     size_t activeSwellCount() const { return m_swells.size(); }
 
-  private:
-    struct LoadedSwellType {
-      SwellType config;
-      TextureHandle texture;
-      Animation animation;
-    };
-
-    struct ActiveSwell {
-      int typeIndex;
-      AnimatedSprite sprite;
-      float x, y;
-      float speed;
-      float scale;
-      float depth;
-      Color tint;
-    };
+    // Most swells alive at once (spawns beyond are skipped)
+    static constexpr size_t MAX_SWELLS = 16384;
 
+  private:
     void spawnSwell();
     float randomFloat(float min, float max);
     int randomInt(int min, int max);
@@ -133,19 +139,20 @@ class OceanSystem {
     // Base water
     Color m_baseColorTop = Color(30, 60, 120);
     Color m_baseColorBottom = Color(10, 30, 60);
-    TextureHandle m_baseTex;
+    uint8_t m_baseBands = 0;
 
-    // Swell types
-    std::vector<LoadedSwellType> m_swellTypes;
+    // Swell types (type i is emitter i of m_swells)
+    std::vector<SwellType> m_swellTypes;
     float m_totalSpawnWeight = 0;
 
-    // Active swells
-    std::vector<ActiveSwell> m_swells;
+    // Active swells, drawn back to front by depth
+    ParticleSystem m_swells;
 
     // Spawning
     float m_swellDensity = 3.0f;    // Swells per second
     float m_spawnTimer = 0;
     float m_speedMultiplier = 1.0f;
+    float m_lastDt = 0.0f; // For render interpolation
 
     // For random variation
     unsigned int m_randomSeed = 12345;
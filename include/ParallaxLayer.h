@@ -20,9 +20,10 @@
 
 #include "TextureManager.h"
 #include "Animation.h"
+#include "SpriteBatch.h"
 #include <vector>
 
-class SpriteBatch;
+class JobSystem;
 
 class ParallaxLayer {
   public:
@@ -90,17 +91,36 @@ class ParallaxLayer {
     /**
      * Render the layer, tiling to fill the given region.
      *
+     * Uses one cached tile grid draw when the batch has tile grids enabled
+     * (SpriteBatch::enableTileGrids), otherwise one sprite per tile.
+     *
      * @param batch SpriteBatch to draw with
      * @param x, y Top-left of region to fill
      * @param width, height Size of region to fill
      */
     void render(SpriteBatch& batch, float x, float y, float width, float height);
 
+    /**
+     * Render the layer one sprite per tile into a recorder (any thread).
+     */
+    void render(SpriteBatch::Recorder& recorder, float x, float y, float width, float height);
+
+    /**
+     * Most tiles render() can draw for a region (recorder capacity).
+     */
+    uint32_t maxTiles(float width, float height) const;
+
     // Getters
     float getScrollX() const { return m_scrollX; }
     float getScrollY() const { return m_scrollY; }
 
   private:
+    // Top-left of the first tile once scroll and bob are applied
+    void tileOrigin(float x, float y, float& startX, float& startY) const;
+
+    template<typename Target>
+    void renderTiles(Target& target, float x, float y, float width, float height) const;
+
     TextureHandle m_texture;
     float m_tileWidth = 64.0f;
     float m_tileHeight = 64.0f;
@@ -164,15 +184,21 @@ class ParallaxBackground {
     void clear() { m_layers.clear(); }
 
     /**
-     * Update all layers.
+     * Update all layers (in parallel across jobs' workers when given).
      */
-    void update(float dt);
+    void update(float dt, JobSystem* jobs = nullptr);
 
     /**
      * Render all layers to fill the given region.
+     *
+     * With jobs, per-tile layers are recorded in parallel (one recorder per
+     * layer) and still land back to front; tile grid layers are one draw
+     * each and stay on the calling thread.
      */
-    void render(SpriteBatch& batch, float x, float y, float width, float height);
+    void render(SpriteBatch& batch, float x, float y, float width, float height,
+                JobSystem* jobs = nullptr);
 
   private:
     std::vector<ParallaxLayer> m_layers;
+    std::vector<SpriteBatch::Recorder> m_recorders; // One per layer, reused
 };
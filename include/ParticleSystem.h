@@ -0,0 +1,237 @@
+#pragma once
+
+/*
+ * ParticleSystem.h
+ *
+ * Fixed-capacity particle pool shared by every scene effect (spray,
+ * clouds, ocean swells).
+ *
+ * Particles are stored as parallel arrays and integrated by one SIMD
+ * kernel. Dead particles are swapped with the last live one, so
+ * removal is O(1) and nothing is allocated after init(). Emitters are
+ * plain data: spawn rate, lifetime, velocity, gravity, size/alpha over
+ * life, bounds behaviour and appearance.
+ *
+ * Usage:
+ *   ParticleSystem spray;
+ *   spray.init(256);
+ *
+ *   ParticleEmitter e;
+ *   e.texture = sprayTex;
+ *   e.rate = 20.0f;                       // per second, from update()
+ *   e.lifetimeMin = 0.5f; e.lifetimeMax = 1.0f;
+ *   e.gravityY = 60.0f;
+ *   e.alphaEnd = 0.0f;                    // fade out over life
+ *   const uint16_t id = spray.addEmitter(e);
+ *
+ *   spray.emitter(id).spawnX = bowX;      // move the spawn box any time
+ *   spray.update(dt);
+ *   spray.render(batch, lag);             // one pass, back to front
+ */
+
+#include "Animation.h"
+#include "SpriteBatch.h"
+#include "TextureManager.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// What happens to a particle outside its emitter's bounds
+enum class ParticleBounds {
+    None, // Bounds ignored
+    Kill, // Removed once fully outside
+    Wrap  // Position wrapped to the opposite edge
+};
+
+// Data description of one kind of particle
+struct ParticleEmitter {
+    // Appearance
+    TextureHandle texture;
+    Animation animation;              // Frames cycled over time (empty = whole texture)
+    float width = 8.0f;               // Base size in pixels (times scale)
+    float height = 8.0f;
+    float originX = 0.0f;             // Point of the sprite at the particle position (0-1)
+    float originY = 0.0f;
+    Color color = Color::white();
+
+    // Size and alpha multipliers at birth and death (linear over life)
+    float sizeStart = 1.0f, sizeEnd = 1.0f;
+    float alphaStart = 1.0f, alphaEnd = 1.0f;
+
+    // Continuous emission from update() (0 = only emit()/spawn())
+    float rate = 0.0f;
+
+    // emit() picks each of these uniformly from its range
+    float spawnX = 0.0f, spawnY = 0.0f;   // Spawn box
+    float spawnW = 0.0f, spawnH = 0.0f;
+    float lifetimeMin = 1.0f, lifetimeMax = 1.0f; // Seconds (<= 0 = until culled by bounds)
+    float velocityXMin = 0.0f, velocityXMax = 0.0f;
+    float velocityYMin = 0.0f, velocityYMax = 0.0f;
+    float scaleMin = 1.0f, scaleMax = 1.0f;
+    float depthMin = 0.0f, depthMax = 0.0f;       // Draw order with setSortByDepth()
+    bool randomStartFrame = false;
+
+    // Constant acceleration in pixels/s^2
+    float gravityX = 0.0f, gravityY = 0.0f;
+
+    // An axis with zero extent is unbounded
+    ParticleBounds boundsMode = ParticleBounds::None;
+    Rect bounds;
+};
+
+// Initial state of one explicitly spawned particle
+struct ParticleSpawn {
+    float x = 0.0f, y = 0.0f;
+    float vx = 0.0f, vy = 0.0f;
+    float lifetime = 0.0f;   // Seconds (<= 0 = until culled by bounds)
+    float scale = 1.0f;
+    float depth = 0.0f;
+    float animTime = 0.0f;   // Start offset into the emitter's animation
+    Color color = Color::white();
+};
+
+class ParticleSystem {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+    /**
+     * Allocate the pool. Clears particles; emitters are kept.
+     *
+     * @param capacity Most particles alive at once (spawns beyond are dropped)
+     */
+    void init(size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * Register an emitter.
+     *
+     * @return Emitter id for emit()/spawn()/emitter()
+     */
+    uint16_t addEmitter(const ParticleEmitter& emitter);
+
+    /**
+     * Edit an emitter (e.g. move its spawn box). Changes apply to live
+     * particles too, except the values picked at spawn.
+     */
+    ParticleEmitter& emitter(uint16_t id) { return m_emitters[id]; }
+    const ParticleEmitter& emitter(uint16_t id) const { return m_emitters[id]; }
+    size_t emitterCount() const { return m_emitters.size(); }
+
+    /**
+     * Remove every emitter and particle.
+     */
+    void clearEmitters();
+
+    /**
+     * Spawn `count` particles with values drawn from the emitter's ranges.
+     *
+     * @return Particles spawned (fewer when the pool is full)
+     */
+    size_t emit(uint16_t emitter, size_t count = 1);
+
+    /**
+     * Spawn one particle with explicit initial state.
+     *
+     * @return false if the pool is full or the emitter id is invalid
+     */
+    bool spawn(uint16_t emitter, const ParticleSpawn& particle);
+
+    /**
+     * Integrate, age and cull every particle, then run continuous emission.
+     *
+     * @param motionScale Multiplies displacement (not ageing), e.g. a scroll speed
+     */
+    void update(float dt, float motionScale = 1.0f);
+
+    /**
+     * Draw every particle in one pass (spawn order, or depth order when
+     * sorting is enabled).
+     *
+     * @param lagSeconds Draw moving particles this far behind (render
+     *                   interpolation, see FixedTimestep::alpha)
+     * @param jobs When given, large systems are recorded in parallel chunks
+     *             (SpriteBatch::Recorder) in the same order
+     */
+    void render(SpriteBatch& batch, float lagSeconds = 0.0f, JobSystem* jobs = nullptr);
+
+    /**
+     * Draw back to front by each particle's depth (ties in spawn order).
+     * Spawns are inserted in order and kills compacted, so render() never sorts.
+     */
+    void setSortByDepth(bool enabled);
+
+    /**
+     * Blend mode render() draws with (Additive for glows and spray);
+     * the batch's own mode is restored afterwards.
+     */
+    void setBlendMode(SpriteBatch::BlendMode mode) { m_blendMode = mode; }
+
+    void setRandomSeed(uint32_t seed) { m_randomSeed = seed; }
+
+    // Kill every particle (emitters are kept)
+    void clear();
+
+    size_t size() const { return m_count; }
+    size_t capacity() const { return m_capacity; }
+
+    // Spawns refused because the pool was full, since init()
+    uint64_t droppedCount() const { return m_dropped; }
+
+private:
+    // Particles recorded per job when rendering in parallel
+    static constexpr size_t PARTICLES_PER_RECORDER = 256;
+
+    void integrate(float dt, float motionScale);
+    void cull();
+    void kill(size_t i);
+    void insertOrder(size_t i);
+    void compactOrder();
+
+    // Depth order: (depth, spawn serial) ascending
+    bool drawsBefore(uint32_t a, uint32_t b) const {
+        if (m_depth[a] != m_depth[b]) return m_depth[a] < m_depth[b];
+        return m_serial[a] < m_serial[b];
+    }
+
+    template<typename Target>
+    void drawRange(Target& target, size_t begin, size_t end, float lagSeconds) const;
+
+    float randomFloat(float min, float max);
+
+    std::vector<ParticleEmitter> m_emitters;
+    std::vector<float> m_emitTimers; // Per emitter, for rate
+
+    // Particle i lives at index i of every array; [0, m_count) are alive
+    std::vector<float> m_x, m_y;
+    std::vector<float> m_vx, m_vy;
+    std::vector<float> m_ax, m_ay;
+    std::vector<float> m_age;
+    std::vector<float> m_lifetime;
+    std::vector<float> m_animOffset; // Clip time at spawn; frame = clip at age + offset
+    std::vector<float> m_scale;
+    std::vector<float> m_depth;
+    std::vector<Color> m_color;
+    std::vector<uint16_t> m_emitter;
+    std::vector<uint32_t> m_serial;  // Spawn order, breaks depth ties
+
+    size_t m_count = 0;
+    size_t m_capacity = 0;
+    uint32_t m_nextSerial = 0;
+    uint64_t m_dropped = 0;
+    float m_motionScale = 1.0f;      // Of the last update (render interpolation)
+    SpriteBatch::BlendMode m_blendMode = SpriteBatch::BlendMode::Alpha;
+
+    // Depth order: m_order[k] is the k-th particle to draw and m_orderPos
+    // its inverse. Kills leave holes that cull() compacts away
+    static constexpr uint32_t ORDER_HOLE = UINT32_MAX;
+    bool m_sortByDepth = false;
+    bool m_orderHoles = false;
+    std::vector<uint32_t> m_order;
+    std::vector<uint32_t> m_orderPos;
+
+    std::vector<SpriteBatch::Recorder> m_recorders; // Reused by render()
+
+    uint32_t m_randomSeed = 12345;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+/*
+ * PixelConvert.h
+ *
+ * 8-bit pixel format conversion kernels used when preparing texture uploads.
+ *
+ * Each kernel picks the fastest path at runtime:
+ *   - AVX2 / SSSE3 byte shuffles on x86
+ *   - NEON vld3/vld4 de-interleaving on ARM
+ *   - Scalar fallback (also exposed as *Scalar for testing and benchmarks)
+ *
+ * Usage:
+ *   PixelConvert::swapRedBlue(pixels, width * height);      // RGBA <-> BGRA in place
+ *   PixelConvert::premultiplyAlpha(pixels, width * height);
+ *   PixelConvert::expandRGBToRGBA(rgb, rgba, width * height);
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PixelConvert {
+
+/**
+ * Swap bytes 0 and 2 of every 4-byte pixel (RGBA <-> BGRA), in place.
+ */
+void swapRedBlue(uint8_t* pixels, size_t pixelCount);
+
+/**
+ * Copying variant: dst receives src with red and blue swapped.
+ * src and dst must not overlap (use the in-place overload for that).
+ */
+void swapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+
+/**
+ * Multiply the color channels by alpha (byte 3), in place.
+ * Rounds exactly like (c * a + 127) / 255.
+ */
+void premultiplyAlpha(uint8_t* pixels, size_t pixelCount);
+
+/**
+ * Expand packed 3-byte pixels to 4 bytes, filling byte 3 with alpha.
+ * Channel order is preserved (RGB -> RGBA, BGR -> BGRA).
+ */
+void expandRGBToRGBA(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount, uint8_t alpha = 255);
+
+// Reference implementations (one pixel at a time)
+void swapRedBlueScalar(uint8_t* pixels, size_t pixelCount);
+void swapRedBlueScalar(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+void premultiplyAlphaScalar(uint8_t* pixels, size_t pixelCount);
+void expandRGBToRGBAScalar(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount, uint8_t alpha = 255);
+
+/**
+ * Name of the SIMD path selected for this CPU ("avx2", "ssse3", "neon" or "scalar").
+ */
+const char* activePath();
+
+} // namespace PixelConvert
@@ -0,0 +1,117 @@
+#pragma once
+
+/*
+ * Platform.h
+ *
+ * Window and renderer setup: creates the SDL window, hands its native
+ * handles to bgfx and picks the renderer at runtime.
+ *   - macOS: CAMetalLayer from SDL_Metal_CreateView (Metal)
+ *   - Windows: HWND (Direct3D 12, Direct3D 11, Vulkan)
+ *   - Linux / BSD: X11 or Wayland (Vulkan)
+ * Handles other than Metal's come from SDL_GetWindowWMInfo.
+ *
+ * Compiled shaders live in one directory per shader profile under
+ * shaders/bin (metal, dx11, spirv), as the CMake build writes them, so
+ * one build directory serves every renderer the platform has.
+ *
+ * Usage:
+ *   Platform::Config config;
+ *   Platform::parseRenderer("vulkan", config.renderer);
+ *
+ *   Platform platform;
+ *   if (!platform.init(config)) return 1;
+ *   batch.init(platform.shaderPath("vs_sprite").c_str(),
+ *              platform.shaderPath("fs_sprite").c_str());
+ *
+ *   // On SDL_WINDOWEVENT_SIZE_CHANGED:
+ *   platform.resize();
+ *
+ *   platform.shutdown(); // After every bgfx resource is destroyed
+ */
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+#include <string>
+
+struct SDL_Window;
+
+class Platform {
+public:
+    struct Config {
+        const char* title = "Pixel Sim Engine";
+        int width = 1280;  // Window size in points
+        int height = 720;
+        bgfx::RendererType::Enum renderer = bgfx::RendererType::Count; // Count = platform default
+        uint32_t reset = BGFX_RESET_VSYNC;
+    };
+
+    /**
+     * Parse a renderer name: auto, vulkan, d3d12, d3d11, metal or noop.
+     *
+     * @return false for an unknown name (out is left unchanged)
+     */
+    static bool parseRenderer(const char* name, bgfx::RendererType::Enum& out);
+
+    /**
+     * The renderer a request resolves to on this machine: the request if
+     * bgfx supports it here and its shaderDirectory() exists, otherwise
+     * (or for Count) the first such of Metal on macOS, Direct3D 12 / 11
+     * then Vulkan on Windows, and Vulkan elsewhere. Count when none is,
+     * leaving the choice to bgfx.
+     */
+    static bgfx::RendererType::Enum resolveRenderer(bgfx::RendererType::Enum requested);
+
+    /**
+     * Directory of the shaders compiled for `renderer` ("shaders/bin/spirv").
+     * Noop uses the platform's default profile: its shaders are parsed, not run.
+     */
+    static const char* shaderDirectory(bgfx::RendererType::Enum renderer);
+
+    // shaderDirectory(renderer) + "/" + name + ".bin"
+    static std::string shaderPath(bgfx::RendererType::Enum renderer, const char* name);
+
+    Platform() = default;
+    ~Platform();
+
+    // Non-copyable
+    Platform(const Platform&) = delete;
+    Platform& operator=(const Platform&) = delete;
+
+    /**
+     * Initialize SDL, open the window and initialize bgfx on it.
+     *
+     * @return true on success (on failure everything is torn down again)
+     */
+    bool init(const Config& config);
+
+    /**
+     * Shut down bgfx, close the window and quit SDL.
+     */
+    void shutdown();
+
+    /**
+     * Re-read the drawable size and reset the backbuffer to it.
+     */
+    void resize();
+
+    SDL_Window* window() const { return m_window; }
+    bgfx::RendererType::Enum renderer() const { return m_renderer; } // Running renderer
+    int backWidth() const { return m_backWidth; }                    // Drawable pixels
+    int backHeight() const { return m_backHeight; }
+
+    // Compiled shader for the running renderer
+    std::string shaderPath(const char* name) const { return shaderPath(m_renderer, name); }
+
+private:
+    bool setPlatformData(bgfx::PlatformData& pd);
+    void readDrawableSize();
+
+    SDL_Window* m_window = nullptr;
+    void* m_metalView = nullptr; // SDL_MetalView (macOS)
+    bool m_sdl = false;
+    bool m_bgfx = false;
+    bgfx::RendererType::Enum m_renderer = bgfx::RendererType::Noop;
+    uint32_t m_reset = BGFX_RESET_VSYNC;
+    int m_backWidth = 0;
+    int m_backHeight = 0;
+};
@@ -15,14 +15,29 @@ class PortScene : public Scene {
 public:
     PortScene(TextureManager& textures);
     
+    float loadStep() override;
     void onEnter() override;
     void onExit() override;
     void update(float dt) override;
-    void render(SpriteBatch& batch) override;
+    void render(SpriteBatch& batch, float alpha) override;
     bool handleEvent(const SDL_Event& event) override;
     
 private:
+    void createSky();
+    void createWater();
+    void createDock();
+    void createBuilding();
+    void createCrane();
+    void createShip();
+    void setSail();
+    
+    // Sky, buildings and crane: static, so cached in a layer when available
+    void drawBackdrop(SpriteBatch& batch);
+    
+    static constexpr int LOAD_STAGES = 6;
+    
     TextureManager& m_textures;
+    int m_loadStage = 0;
     
     // Textures
     TextureHandle m_skyTex;
@@ -35,7 +50,13 @@ private:
     // Animations
     Animation m_shipAnim;
     AnimatedSprite m_ship;
+    AnimationInstance m_water; // Shared clip, frame from the library clock
+    
+    // Cached backdrop (-1 = drawn directly)
+    LayerCache* m_layerCache = nullptr;
+    int m_backdropLayer = -1;
     
     // State
     float m_time = 0.0f;
+    float m_lastDt = 0.0f; // Length of the latest update (render interpolation)
 };
@@ -0,0 +1,207 @@
+#pragma once
+
+/*
+ * Profiler.h
+ *
+ * Lightweight frame profiler with an on-canvas HUD.
+ *
+ * Features:
+ *   - Scoped CPU timers for fixed engine sections (PROFILE_SCOPE)
+ *   - GPU and render-thread submit times pulled from bgfx::getStats()
+ *   - Ring buffer of recent frames with p50/p99 frame times
+ *   - Overlay drawn through SpriteBatch with a built-in 3x5 pixel font
+ *   - Optional per-frame CSV or JSON capture for comparing builds
+ *
+ * Usage:
+ *   Profiler& profiler = Profiler::get();
+ *   profiler.initOverlay(textures);
+ *
+ *   // Each frame:
+ *   profiler.beginFrame();
+ *   { PROFILE_SCOPE(SceneUpdate); scenes.update(dt); }
+ *   ...
+ *   profiler.drawOverlay(batch, 4, 4);   // before batch.end()
+ *   profiler.recordBatch(batch.getStats());
+ *   profiler.recordArena(FrameArena::get().getStats());
+ *   profiler.endFrame();
+ *
+ * Build with ENGINE_PROFILER=0 to compile the scoped timers out.
+ */
+
+#include "FrameArena.h"
+#include "SpriteBatch.h"
+#include "TextureManager.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifndef ENGINE_PROFILER
+#define ENGINE_PROFILER 1
+#endif
+
+// Timed engine sections (times accumulate when a section runs more than once)
+enum class ProfileSection : uint8_t {
+    SceneUpdate,
+    SceneRender,
+    OceanUpdate,
+    SpriteFlush,
+    BgfxFrame,
+    Count
+};
+
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t SECTION_COUNT = (size_t)ProfileSection::Count;
+    static constexpr size_t HISTORY = 240; // Frames kept for percentiles and the graph
+
+    // One recorded frame (all times in milliseconds)
+    struct FrameSample {
+        float frameMs = 0.0f;   // Interval since the previous frame
+        float cpuMs = 0.0f;     // beginFrame() to endFrame()
+        float sectionMs[SECTION_COUNT] = {};
+        float gpuMs = 0.0f;
+        float submitMs = 0.0f;  // bgfx render thread CPU time
+        uint32_t drawCalls = 0;
+        uint32_t sprites = 0;
+        uint32_t arenaBytes = 0;      // Frame arena usage
+        uint32_t arenaHeapAllocs = 0; // Frame arena overflows (heap allocations)
+    };
+
+    static Profiler& get();
+
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    /**
+     * Create the HUD font and panel textures (call after bgfx is initialized).
+     */
+    void initOverlay(TextureManager& textures);
+
+    void beginFrame();
+
+    /**
+     * Close the frame: reads bgfx stats, pushes the sample into the ring
+     * buffer and appends it to the capture file if one is open.
+     */
+    void endFrame();
+
+    /**
+     * Record SpriteBatch statistics for the current frame.
+     */
+    void recordBatch(const SpriteBatch::Stats& stats);
+
+    /**
+     * Record frame arena usage for the current frame (before nextFrame()).
+     */
+    void recordArena(const FrameArena::Stats& stats);
+
+    // Called by ProfileScope; safe from any thread
+    void addTime(ProfileSection section, Clock::duration elapsed) {
+        m_sectionNs[(size_t)section].fetch_add(
+            (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+            std::memory_order_relaxed);
+    }
+
+    /**
+     * Frame time percentile over the history (p in 0..100).
+     */
+    float frameTimePercentile(float p) const;
+
+    const FrameSample& lastFrame() const;
+    size_t frameCount() const { return m_count; }
+
+    static const char* sectionName(ProfileSection section);
+
+    // -------------------------
+    // Overlay
+    // -------------------------
+    void setOverlayVisible(bool visible) { m_overlayVisible = visible; }
+    void toggleOverlay() { m_overlayVisible = !m_overlayVisible; }
+    bool isOverlayVisible() const { return m_overlayVisible; }
+
+    /**
+     * Draw the HUD at (x, y) in canvas pixels (call between begin()/end()).
+     */
+    void drawOverlay(SpriteBatch& batch, float x, float y) const;
+
+    // -------------------------
+    // Capture
+    // -------------------------
+
+    /**
+     * Start writing one row per frame to path (".json" = JSON array, else CSV).
+     * @return true if the file was opened
+     */
+    bool startCapture(const std::string& path);
+    void stopCapture();
+    bool isCapturing() const { return m_capture != nullptr; }
+
+private:
+    Profiler() = default;
+
+    void writeCaptureRow(const FrameSample& sample);
+    float drawText(SpriteBatch& batch, float x, float y, const char* text, Color color) const;
+
+    // Current frame
+    std::atomic<uint64_t> m_sectionNs[SECTION_COUNT] = {};
+    Clock::time_point m_frameStart{};
+    Clock::time_point m_lastFrameStart{};
+    bool m_hasLastFrame = false;
+    SpriteBatch::Stats m_batchStats{};
+    FrameArena::Stats m_arenaStats{};
+
+    // History ring buffer
+    std::array<FrameSample, HISTORY> m_history{};
+    size_t m_head = 0;   // Next write position
+    size_t m_count = 0;  // Frames recorded in total
+    mutable std::vector<float> m_scratch;
+
+    // Overlay
+    bool m_overlayVisible = false;
+    TextureHandle m_font;
+    TextureHandle m_panel;
+
+    // Capture
+    std::FILE* m_capture = nullptr;
+    bool m_captureJson = false;
+    bool m_captureFirstRow = true;
+};
+
+// Times the enclosing scope into a ProfileSection
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileSection section)
+        : m_section(section)
+        , m_start(Profiler::Clock::now())
+    {}
+
+    ~ProfileScope() {
+        Profiler::get().addTime(m_section, Profiler::Clock::now() - m_start);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfileSection m_section;
+    Profiler::Clock::time_point m_start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if ENGINE_PROFILER
+#define PROFILE_SCOPE(section) \
+    ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(ProfileSection::section)
+#else
+#define PROFILE_SCOPE(section) ((void)0)
+#endif
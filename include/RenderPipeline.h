@@ -0,0 +1,135 @@
+#pragma once
+
+/*
+ * RenderPipeline.h
+ *
+ * Renders the game at a fixed canvas resolution and scales it to the
+ * window.
+ *
+ * The canvas is an offscreen framebuffer (with a depth buffer when the
+ * GPU supports it, see SpriteBatch::begin). present() blits it to the
+ * backbuffer with a quad held in a static vertex buffer, rebuilt only by
+ * resize(). Two upscalers:
+ *   - Integer: the largest whole multiple that fits, letterboxed and
+ *     point sampled (fs_blit)
+ *   - SharpBilinear: fills the window keeping the aspect ratio; texels stay
+ *     square and only their edges blend over one window pixel (fs_blit_sharp)
+ *
+ * When the backbuffer is an exact multiple of the canvas, the canvas view
+ * draws straight into the backbuffer with a scaled viewport instead and
+ * the blit is skipped. The picture is the same for sprites on whole
+ * pixels; rotated and sub-pixel sprites come out at window resolution.
+ *
+ * Usage:
+ *   RenderPipeline pipeline;
+ *   RenderPipeline::Config config;
+ *   config.canvasWidth = 640;
+ *   config.canvasHeight = 360;
+ *   pipeline.init(platform.shaderPath("vs_blit").c_str(),
+ *                 platform.shaderPath("fs_blit").c_str(),
+ *                 config, VIEW_GAME, VIEW_BLIT, backW, backH);
+ *
+ *   // On window resize:
+ *   pipeline.resize(backW, backH);
+ *
+ *   // Each frame:
+ *   pipeline.beginFrame();
+ *   batch.begin(pipeline.canvasView(), pipeline.canvasWidth(),
+ *               pipeline.canvasHeight(), pipeline.hasDepth());
+ *   ...
+ *   batch.end();
+ *   pipeline.present();
+ */
+
+#include <bgfx/bgfx.h>
+#include <cstdint>
+
+class RenderPipeline {
+public:
+    enum class Upscale {
+        Integer,      // Whole multiples, letterboxed (fs_blit)
+        SharpBilinear // Fills the window, sharp texel edges (fs_blit_sharp)
+    };
+
+    struct Config {
+        uint16_t canvasWidth = 640;
+        uint16_t canvasHeight = 360;
+        Upscale upscale = Upscale::Integer;
+        bool depth = true;           // Canvas depth buffer, if supported
+        bool directWhenExact = true; // Skip the canvas at exact multiples
+    };
+
+    // Backbuffer pixels the canvas covers
+    struct Viewport {
+        int x = 0, y = 0, w = 0, h = 0;
+    };
+
+    RenderPipeline() = default;
+    ~RenderPipeline();
+
+    // Non-copyable
+    RenderPipeline(const RenderPipeline&) = delete;
+    RenderPipeline& operator=(const RenderPipeline&) = delete;
+
+    /**
+     * Create the canvas and load the blit program (after bgfx::init()).
+     *
+     * @param vsPath Compiled vs_blit shader
+     * @param fsPath Compiled fs_blit shader (fs_blit_sharp for SharpBilinear)
+     * @param canvasView View the game draws into
+     * @param blitView View that composites the canvas to the backbuffer
+     * @return true on success
+     */
+    bool init(const char* vsPath, const char* fsPath, const Config& config,
+              bgfx::ViewId canvasView, bgfx::ViewId blitView,
+              uint16_t backWidth, uint16_t backHeight);
+
+    void shutdown();
+
+    /**
+     * Fit the canvas to a new backbuffer size (call after bgfx::reset()).
+     * Rebuilds the blit quad and picks the direct path if it now applies.
+     */
+    void resize(uint16_t backWidth, uint16_t backHeight);
+
+    /**
+     * Touch the canvas view for this frame; draw into canvasView() in
+     * canvas coordinates afterwards.
+     */
+    void beginFrame();
+
+    /**
+     * Composite the canvas to the backbuffer (nothing in direct mode).
+     */
+    void present();
+
+    bgfx::ViewId canvasView() const { return m_canvasView; }
+    uint16_t canvasWidth() const { return m_config.canvasWidth; }
+    uint16_t canvasHeight() const { return m_config.canvasHeight; }
+    bool hasDepth() const { return m_direct || m_canvasDepth; }
+    bool isDirect() const { return m_direct; }
+    const Viewport& viewport() const { return m_viewport; }
+
+private:
+    void configureViews();
+    void rebuildBlitQuad();
+
+    Config m_config;
+    bgfx::ViewId m_canvasView = 0;
+    bgfx::ViewId m_blitView = 0;
+    uint16_t m_backWidth = 0;
+    uint16_t m_backHeight = 0;
+
+    bgfx::TextureHandle m_canvasColor = BGFX_INVALID_HANDLE;
+    bgfx::FrameBufferHandle m_canvas = BGFX_INVALID_HANDLE;
+    bool m_canvasDepth = false;
+
+    bgfx::ProgramHandle m_program = BGFX_INVALID_HANDLE;
+    bgfx::UniformHandle m_texUniform = BGFX_INVALID_HANDLE;
+    bgfx::UniformHandle m_paramsUniform = BGFX_INVALID_HANDLE; // u_blitParams (SharpBilinear)
+    bgfx::VertexBufferHandle m_quad = BGFX_INVALID_HANDLE;
+
+    Viewport m_viewport;
+    float m_scale = 1.0f; // Backbuffer pixels per canvas pixel
+    bool m_direct = false;
+};
@@ -12,22 +12,31 @@
 #include "TextureManager.h"
 #include "ParallaxLayer.h"
 #include "OceanSystem.h"
+#include "ParticleSystem.h"
+#include "JobSystem.h"
 
 class SailingScene : public Scene {
   public:
     SailingScene(TextureManager& textures);
 
+    float loadStep() override;
+    void finishLoading() override;
     void onEnter() override;
     void onExit() override;
     void update(float dt) override;
-    void render(SpriteBatch& batch) override;
+    void render(SpriteBatch& batch, float alpha) override;
     bool handleEvent(const SDL_Event& event) override;
 
   private:
     void createTextures();
     void loadAssets();
+    void initOcean();
+    void dock();
+
+    enum LoadStage { LoadTextures, LoadShip, LoadOcean, LoadUploads, LoadDone };
 
     TextureManager& m_textures;
+    int m_loadStage = LoadTextures;
 
     // Ship
     TextureHandle m_shipSheet;
@@ -36,32 +45,22 @@ class SailingScene : public Scene {
     float m_shipX = 0.0f;
     float m_shipBaseY = 0.0f;
 
-    // Sky
-    TextureHandle m_skyTex;
-
     // Dynamic ocean
     OceanSystem m_ocean;
 
-    // Clouds (simple Parallax)
+    // Clouds (immortal particles wrapping across the sky)
     TextureHandle m_cloudTex;
-    struct Cloud {
-      float x, y;
-      float speed;
-      float scale;
-    };
-    std::vector<Cloud> m_clouds;
+    ParticleSystem m_clouds;
 
-    // Spray particles
-    struct SprayParticle {
-      float x, y;
-      float vx, vy;
-      float life;
-      float maxLife;
-    };
-    std::vector<SprayParticle> m_spray;
+    // Spray thrown up at the ship's bow
     TextureHandle m_sprayTex;
-    float m_sprayTimer = 0.0f;
+    ParticleSystem m_spray;
+    uint16_t m_sprayEmitter = 0;
 
     // State
     float m_time = 0.0f;
+    float m_lastDt = 0.0f; // Length of the latest update (render interpolation)
+
+    // Independent subsystem updates, run in parallel when a JobSystem is set
+    TaskGraph m_updateGraph;
 };
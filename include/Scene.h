@@ -10,24 +10,32 @@
  *  class MenuScene : public Scene {
  *  public:
  *    void update(float dt) override { ... }
- *    void render(SpriteBatch& batch) override { ... }
+ *    void render(SpriteBatch& batch, float alpha) override { ... }
  *  };
  *
  * // In main:
  * SceneManager scenes;
  * scenes.switchTo(std::make_unique<Menu_Scene>());
  *
- * // In game loop:
- * scenes.update(deltaTime);
- * scenes.render(spriteBatch);
+ * // In game loop (fixed steps, see FixedTimestep):
+ * scenes.update(timestep.step());
+ * scenes.render(spriteBatch, timestep.alpha());
+ *
+ * // Background preloading (loads a slice per frame, then cross-fades):
+ * scenes.prefetch<PortScene>(textures);
+ * scenes.switchToPrefetched(0.5f);
  */
 
 #include <memory>
+#include <cstdint>
 #include <functional>
+#include <utility>
 
 // Forward declarations
 class SpriteBatch;
 class SceneManager;
+class LayerCache;
+class JobSystem;
 union SDL_Event;
 
 // Base class for all scenes
@@ -41,12 +49,27 @@ class Scene {
     // Called when leaving this scene (before destruction or switch)
     virtual void onExit() {}
 
-    // Called every frame to update game logic
+    // Incremental asset loading. SceneManager calls this once per frame
+    // while the scene is prefetched: do one bounded slice of work and
+    // return overall progress (1 = ready to enter, nothing left to load).
+    // Constructors should stay cheap and leave the heavy work to this.
+    virtual float loadStep() { return 1.0f; }
+
+    // Finish all remaining loading immediately (used by a direct switchTo)
+    virtual void finishLoading() {
+      while (loadStep() < 1.0f) {}
+    }
+
+    // Called once per simulation step to update game logic
+    // (a fixed dt when driven by FixedTimestep; zero or more times per frame)
     virtual void update(float dt) = 0;
 
     // Called every frame to render
     // @param batch The SpriteBatch to draw with (already has begin() called)
-    virtual void render(SpriteBatch& batch) = 0;
+    // @param alpha How far the frame is between the previous update and the
+    //              latest one (0..1); moving things can draw their state
+    //              interpolated by (1 - alpha) of a step behind
+    virtual void render(SpriteBatch& batch, float alpha) = 0;
 
     // Called for each SDL event (input handling)
     // Return true if the event was consumed (stop propagation)
@@ -56,6 +79,10 @@ class Scene {
     void setManager(SceneManager* manager) { m_manager = manager; }
 
   protected:
+    // Canvas size in pixels, from the manager (default size without one)
+    float canvasWidth() const;
+    float canvasHeight() const;
+
     SceneManager* m_manager = nullptr;
 };
 
@@ -71,13 +98,52 @@ class SceneManager {
 
     /**
      * Switch to a new scene.
-     * The current scene's onExit() is called, then it's destroyed.
+     * The new scene finishes loading (instant if it was prefetched), the
+     * current scene's onExit() is called, then it's destroyed.
      * The new scene's onEnter() is called.
      *
      * @param scene The new scene (takes ownership)
      */
     void switchTo(std::unique_ptr<Scene> scene);
 
+    /**
+     * Construct a scene and load its assets in the background, one
+     * loadStep() per update(), while the current scene keeps running.
+     * Replaces any scene prefetched earlier.
+     */
+    template <typename T, typename... Args>
+    void prefetch(Args&&... args) {
+      prefetch(std::make_unique<T>(std::forward<Args>(args)...));
+    }
+
+    /**
+     * Prefetch an already constructed scene (takes ownership).
+     */
+    void prefetch(std::unique_ptr<Scene> scene);
+
+    /**
+     * Loading progress of the prefetched scene (0..1, 0 if none).
+     */
+    float prefetchProgress() const { return m_prefetchProgress; }
+    bool hasPrefetch() const { return m_prefetched != nullptr; }
+    bool isPrefetchReady() const { return m_prefetched && m_prefetchProgress >= 1.0f; }
+
+    /**
+     * Switch to the prefetched scene as soon as it has finished loading.
+     * Until then the current scene keeps updating and rendering.
+     *
+     * The outgoing scene fades as one image from a free LayerCache layer
+     * (drawn directly over the new scene when there is none).
+     *
+     * @param fadeSeconds Cross-fade from the outgoing scene (0 = cut)
+     */
+    void switchToPrefetched(float fadeSeconds = 0.0f);
+
+    /**
+     * True while a prefetched switch is waiting or cross-fading.
+     */
+    bool isTransitioning() const { return m_switchWhenReady || m_outgoingScene != nullptr; }
+
     /**
      * Queue a scene switch for the end of the current frame.
      * Useful when switching scenes from within a scene's update().
@@ -98,8 +164,9 @@ class SceneManager {
      * Render the current scene.
      *
      * @param batch The SpriteBatch to draw with (already has begin() called)
+     * @param alpha Interpolation between the last two updates (1 = latest)
      */
-    void render(SpriteBatch& batch);
+    void render(SpriteBatch& batch, float alpha = 1.0f);
 
     /**
      * Pass an SDL event to the current scene.
@@ -119,10 +186,57 @@ class SceneManager {
      */
     Scene* getCurrentScene() { return m_currentScene.get(); }
 
+    /**
+     * Render-target cache scenes keep their static layers in.
+     * Optional: scenes draw everything directly when it's null.
+     */
+    void setLayerCache(LayerCache* cache) { m_layerCache = cache; }
+    LayerCache* layerCache() const { return m_layerCache; }
+
+    /**
+     * Job system scenes may spread their update work over.
+     * Optional: scenes update serially when it's null.
+     */
+    void setJobSystem(JobSystem* jobs) { m_jobs = jobs; }
+    JobSystem* jobs() const { return m_jobs; }
+
+    /**
+     * Size of the canvas scenes draw on (set before the first switch;
+     * scenes lay themselves out while loading).
+     */
+    static constexpr uint16_t DEFAULT_CANVAS_WIDTH = 640;
+    static constexpr uint16_t DEFAULT_CANVAS_HEIGHT = 360;
+    void setCanvasSize(uint16_t width, uint16_t height) {
+      m_canvasWidth = width;
+      m_canvasHeight = height;
+    }
+    uint16_t canvasWidth() const { return m_canvasWidth; }
+    uint16_t canvasHeight() const { return m_canvasHeight; }
+
   private:
     void processQueuedSwitch();
+    void processPrefetch();
+    void enterScene(std::unique_ptr<Scene> scene);
+    void finishFade();
 
     std::unique_ptr<Scene> m_currentScene;
     std::unique_ptr<Scene> m_queuedScene;
     bool m_hasPendingSwitch = false;
+
+    // Background loading
+    std::unique_ptr<Scene> m_prefetched;
+    float m_prefetchProgress = 0.0f;
+    bool m_switchWhenReady = false;
+
+    // Cross-fade (outgoing scene is drawn over the new one, fading out)
+    std::unique_ptr<Scene> m_outgoingScene;
+    float m_fadeDuration = 0.0f;
+    float m_fadeRequested = 0.0f;
+    float m_fadeTime = 0.0f;
+    int m_fadeLayer = -1; // LayerCache layer holding the outgoing scene
+
+    LayerCache* m_layerCache = nullptr;
+    JobSystem* m_jobs = nullptr;
+    uint16_t m_canvasWidth = DEFAULT_CANVAS_WIDTH;
+    uint16_t m_canvasHeight = DEFAULT_CANVAS_HEIGHT;
 };
@@ -0,0 +1,89 @@
+#pragma once
+
+/*
+ * SpatialGrid.h
+ *
+ * Uniform hashed grid for finding the entities inside a rect (usually
+ * the visible part of a large scrolling world).
+ *
+ * Entities are ids with a bounding rect. Cells are hashed, so the world
+ * has no fixed extent; an entity is listed in every cell it overlaps.
+ * Moving an entity within its cells only updates its rect.
+ *
+ * Usage:
+ *   SpatialGrid grid(128.0f);                // cell size in world pixels
+ *   grid.insert(id, Rect(x, y, w, h));       // again after it moves
+ *
+ *   // Each frame:
+ *   grid.query(Rect(cameraX, cameraY, 640, 360), visible);
+ *   for (uint32_t id : visible) drawEntity(id);
+ *
+ * Results come back in ascending id order, so ids assigned in draw
+ * order keep painter's order.
+ */
+
+#include "SpriteBatch.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class SpatialGrid {
+public:
+    static constexpr float DEFAULT_CELL_SIZE = 128.0f;
+
+    /**
+     * @param cellSize Cell edge in world units; around the size of a
+     *                 typical entity or a fraction of the view works well
+     */
+    explicit SpatialGrid(float cellSize = DEFAULT_CELL_SIZE);
+
+    /**
+     * Add an entity, or move it if the id is already present.
+     * Ids index a dense table, so keep them small and contiguous.
+     */
+    void insert(uint32_t id, const Rect& bounds);
+
+    void remove(uint32_t id);
+    bool contains(uint32_t id) const;
+
+    /**
+     * Append the ids of entities overlapping `area` to `out`, each once,
+     * in ascending order.
+     */
+    void query(const Rect& area, std::vector<uint32_t>& out) const;
+
+    void clear();
+    size_t size() const { return m_size; }
+    float cellSize() const { return m_cellSize; }
+
+private:
+    struct CellRange {
+        int32_t x0, y0, x1, y1; // Inclusive
+    };
+
+    struct Entry {
+        Rect bounds;
+        CellRange cells;
+        bool active = false;
+    };
+
+    CellRange cellRange(const Rect& bounds) const;
+    static uint64_t cellKey(int32_t x, int32_t y) {
+        return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+    }
+
+    void link(uint32_t id, const CellRange& cells);
+    void unlink(uint32_t id, const CellRange& cells);
+
+    float m_cellSize;
+    float m_invCellSize;
+    std::vector<Entry> m_entries; // Indexed by id
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells;
+    size_t m_size = 0;
+
+    // Marks ids already returned by the current query
+    mutable std::vector<uint32_t> m_visited;
+    mutable uint32_t m_queryStamp = 0;
+};
@@ -7,9 +7,20 @@
  * 
  * Features:
  *   - Batches sprites by texture to minimize draw calls
+ *   - Indexed quads: 4 vertices per sprite, shared static index buffer
  *   - Supports position, scale, rotation, tint color
- *   - Handles alpha blending
- *   - Automatic depth sorting (optional)
+ *   - Blend modes: alpha, premultiplied, additive, multiply, opaque
+ *   - Optional depth testing: opaque sprites front to back with depth writes
+ *   - Layers: queued sprites radix-sorted by layer and submission order
+ *   - Streaming mode: vertices written straight into bgfx transient memory
+ *   - Transparent UV remapping for atlased textures (TextureHandle sub-rects)
+ *   - Texture-slot mode: up to 8 textures per draw call, chosen per vertex
+ *   - Optional GPU instancing: one compact record per sprite
+ *   - Optional compact vertices: 12 bytes instead of 24 (16 instead of 28 with slots)
+ *   - Vertical gradient fills with optional dithered banding
+ *   - Static tile grids (parallax layers) placed by uniforms in one draw
+ *   - Recorders: sprites recorded on worker threads, merged in painter's order
+ *   - Cull rect: sprites entirely off the canvas are dropped before queueing
  * 
  * Usage:
  *   SpriteBatch batch;
@@ -24,12 +35,18 @@
  * 
  * Performance tips:
  *   - Draw sprites with the same texture consecutively when possible
- *   - The batcher auto-sorts by texture, but pre-sorting saves work
+ *   - Enable TextureManager atlasing so interleaved small sprites share a page
+ *   - Queued batches reorder non-overlapping sprites by texture, but
+ *     pre-sorting saves work; streaming batches never reorder or sort
  *   - Default max batch size is 8192 sprites (configurable)
  */
 
 #include <bgfx/bgfx.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <cstdint>
+#include <string>
 #include <vector>
 
 // Forward declare
@@ -71,6 +88,33 @@ public:
     // Max sprites per batch (can be overridden in init)
     static constexpr uint32_t DEFAULT_MAX_SPRITES = 8192;
     
+    // Max textures bound per draw call in texture-slot mode
+    static constexpr uint8_t MAX_TEXTURE_SLOTS = 8;
+    
+    // How sprites reach the GPU
+    enum class Geometry {
+        Vertices,  // 4 CPU-built vertices per sprite
+        Instanced  // One 48-byte instance record per sprite, expanded on the GPU
+    };
+    
+    // Vertex layout for Geometry::Vertices
+    enum class VertexFormat {
+        Float,   // Float position and UVs (vs_sprite, vs_sprite_slots)
+        Compact  // 1/8 pixel int16 position, uint16 UVs (vs_sprite_compact,
+                 // vs_sprite_slots_compact); canvas within +-4095 pixels
+    };
+    
+    // How sprites combine with what is already drawn
+    enum class BlendMode : uint8_t {
+        Alpha,         // Straight alpha (default)
+        Premultiplied, // Texture and tint carry premultiplied color
+        Additive,      // Color * alpha added (glows, spray)
+        Multiply,      // Darkens by the color (shadows); premultiplied input like
+                       // Premultiplied (PixelConvert::premultiplyAlpha), so
+                       // transparent texels keep the target
+        Opaque         // No blending; texels must be fully opaque (sky, water fills)
+    };
+    
     SpriteBatch() = default;
     ~SpriteBatch();
     
@@ -84,16 +128,88 @@ public:
      * @param vsPath Path to compiled vertex shader (.bin)
      * @param fsPath Path to compiled fragment shader (.bin)
      * @param maxSprites Maximum sprites per batch (affects memory usage)
+     * @param geometry Vertices, or Instanced (vsPath must then be vs_sprite_inst)
+     * @param format Vertex layout with Geometry::Vertices (vsPath must match it)
      * @return true on success
+     * 
+     * Instanced batches always stream in submission order (see setStreaming);
+     * the draw API is identical. Draw order never comes from the vertices,
+     * so compact vertices only trade position and UV precision.
      */
     bool init(const char* vsPath, const char* fsPath, 
-              uint32_t maxSprites = DEFAULT_MAX_SPRITES);
+              uint32_t maxSprites = DEFAULT_MAX_SPRITES,
+              Geometry geometry = Geometry::Vertices,
+              VertexFormat format = VertexFormat::Float);
+    
+    /**
+     * Enable texture-slot mode (call after init(), outside begin()/end()).
+     * 
+     * Loads the multi-sampler program and binds up to `slots` textures per
+     * draw call, selected by a per-vertex slot index. A texture change only
+     * starts a new draw call once the current run's slot table is full, so
+     * interleaved layers keep painter's order without a submit per swap.
+     * 
+     * @param vsPath Compiled vs_sprite_slots shader (vs_sprite_slots_compact with
+     *               compact vertices, vs_sprite_inst when instanced)
+     * @param fsPath Compiled fs_sprite_slots shader
+     * @param slots Textures per draw (clamped to MAX_TEXTURE_SLOTS and GPU limits)
+     * @return true on success (otherwise the batch stays single-texture)
+     */
+    bool enableTextureSlots(const char* vsPath, const char* fsPath,
+                            uint8_t slots = MAX_TEXTURE_SLOTS);
+    
+    /**
+     * Load the gradient program used by drawGradientRect() (call after init()).
+     * 
+     * @param vsPath Compiled vs_sprite shader
+     * @param fsPath Compiled fs_gradient shader
+     * @return true on success
+     * 
+     * Gradients always use float vertices (u carries the band count), so
+     * this is vs_sprite even with compact vertices. Without it, gradients
+     * with float vertices fall back to smooth fills through the sprite
+     * program; other batches skip them.
+     */
+    bool enableGradients(const char* vsPath, const char* fsPath);
+    
+    /**
+     * Load the program used by drawTileGrid() (call after init()).
+     * 
+     * @param vsPath Compiled vs_tile_grid shader
+     * @param fsPath Compiled fs_sprite shader
+     * @return true on success (otherwise drawTileGrid() always declines)
+     */
+    bool enableTileGrids(const char* vsPath, const char* fsPath);
+    bool hasTileGrids() const { return bgfx::isValid(m_tileProgram); }
+    
+    /**
+     * Load every program again from the shader files it was created from
+     * and swap it in (call outside begin()/end(), e.g. between frames).
+     * 
+     * @return true if all reloaded; a program that fails keeps its old version
+     * 
+     * Draws already submitted keep rendering with the old programs, which
+     * bgfx destroys once that frame is done.
+     */
+    bool reloadShaders();
     
     /**
      * Shutdown and release GPU resources.
      */
     void shutdown();
     
+    /**
+     * Enable or disable streaming mode (call outside begin()/end()).
+     * 
+     * In streaming mode begin() reserves a transient vertex buffer and every
+     * draw call writes its 4 vertices directly into it, recording only where
+     * the texture changes. Sprites are submitted strictly in call order (no
+     * layer sort or texture reordering; see setLayer).
+     * Unused space in the reserved buffer is lost for the frame.
+     */
+    void setStreaming(bool enabled);
+    bool isStreaming() const { return m_streaming; }
+    
     /**
      * Begin a new batch.
      * 
@@ -102,8 +218,14 @@ public:
      * @param viewId bgfx view ID to render to
      * @param screenWidth Width of render target in pixels
      * @param screenHeight Height of render target in pixels
+     * @param depthTest The target has a depth buffer, cleared to 1.0. Opaque
+     *                  draws then go first, front to back, writing depth, and
+     *                  everything else is depth tested against them, so
+     *                  covered pixels are never shaded; painter's order is
+     *                  unchanged. Otherwise opaque draws only skip blending.
      */
-    void begin(bgfx::ViewId viewId, uint16_t screenWidth, uint16_t screenHeight);
+    void begin(bgfx::ViewId viewId, uint16_t screenWidth, uint16_t screenHeight,
+               bool depthTest = false);
     
     /**
      * Draw a sprite (full texture).
@@ -159,6 +281,82 @@ public:
                     float rotation, float originX = 0.5f, float originY = 0.5f,
                     Color color = Color::white());
     
+    /**
+     * Draw a vertical gradient fill (top color to bottom color) as one quad.
+     * 
+     * @param bands Number of flat color bands, ordered-dithered into each
+     *              other in the fragment shader (0 or 1 = smooth)
+     */
+    void drawGradientRect(float x, float y, float width, float height,
+                          Color topColor, Color bottomColor,
+                          uint8_t bands = 0);
+    
+    // Placement of one drawTileGrid() call, in screen pixels
+    struct TileGridParams {
+        float x = 0.0f, y = 0.0f;          // Top-left of tile (0, 0)
+        float tileWidth = 0.0f, tileHeight = 0.0f;
+        float limitX = 0.0f, limitY = 0.0f; // Tiles whose top-left reaches a limit are skipped
+        
+        // Each row shifts by sin((rowY * waveFrequency + wavePhase) * 2pi) * waveAmplitude
+        float waveAmplitude = 0.0f;
+        float waveFrequency = 0.0f;
+        float wavePhase = 0.0f;
+    };
+    
+    /**
+     * Draw a cols x rows grid of one texture region with a single draw call.
+     * 
+     * The grid's vertices are built once per size and cached by the batch;
+     * position, wave and frame come from uniforms, so the per-frame cost
+     * doesn't grow with the number of tiles. Keeps painter's order with
+     * the sprites around it.
+     * 
+     * @param srcRect Region of texture drawn in every tile, in pixels
+     * @return false if tile grids aren't enabled or cols * rows exceeds maxSprites
+     *         (nothing is drawn; the caller should fall back to drawRegion)
+     */
+    bool drawTileGrid(const TextureHandle& texture, uint16_t cols, uint16_t rows,
+                      const TileGridParams& params, const Rect& srcRect,
+                      Color color = Color::white());
+    
+    /**
+     * Multiply the alpha of everything drawn from now on (255 = unchanged).
+     * Reset to 255 by begin(); used for scene cross-fades.
+     */
+    void setAlpha(uint8_t alpha) { m_alpha = alpha; }
+    uint8_t getAlpha() const { return m_alpha; }
+    
+    /**
+     * Drop sprites and gradients that lie entirely outside `rect` (canvas
+     * pixels) before they are queued or streamed. Reset to the whole
+     * canvas by begin(); rotated sprites are tested by their bounding circle.
+     */
+    void setCullRect(const Rect& rect) { m_cullRect = rect; }
+    const Rect& getCullRect() const { return m_cullRect; }
+    
+    /**
+     * Layer for sprites and gradients queued from now on (reset to 0 by
+     * begin()). A queued batch draws lower layers first and keeps call order
+     * within a layer, so a background can be drawn after the sprites on top
+     * of it. Only sprites queued since the last flush are sorted (a full
+     * queue, a tile grid or reserveRecorders() flushes); streaming batches
+     * draw strictly in call order and ignore layers.
+     */
+    void setLayer(uint8_t layer) { m_layer = layer; }
+    uint8_t getLayer() const { return m_layer; }
+    
+    /**
+     * Blend mode for everything drawn from now on (reset to Alpha by begin()).
+     * Runs break where the mode changes; queued batches also group
+     * non-overlapping sprites by mode. Opaque sprites blend as Alpha while
+     * setAlpha() fades them.
+     */
+    void setBlendMode(BlendMode mode) { m_blendMode = mode; }
+    BlendMode getBlendMode() const { return m_blendMode; }
+    
+    // Whether the current batch was begun with depth testing
+    bool isDepthTested() const { return m_depthTest; }
+    
     /**
      * End the batch and submit all draw calls.
      */
@@ -170,11 +368,38 @@ public:
     struct Stats {
         uint32_t spriteCount = 0;
         uint32_t drawCalls   = 0;
-        uint32_t textureSwaps = 0;
+        uint32_t textureSwaps = 0; // Textures bound (per run, per slot)
+        uint32_t culledSprites = 0; // Dropped by the cull rect
     };
     
     Stats getStats() const { return m_stats; }
     
+    // Per-thread recording context (see below)
+    class Recorder;
+    
+    /**
+     * Reserve painter's order positions for `count` recorders at this point
+     * of the batch (main thread, inside begin()/end()).
+     * 
+     * Recorder i started with the returned value + i draws after everything
+     * drawn to the batch so far and before everything drawn after this call,
+     * whatever order the recorders finish in.
+     * 
+     * @return First reserved position (pass to Recorder::begin)
+     */
+    uint32_t reserveRecorders(uint32_t count);
+    
+    /**
+     * Collect a finished recorder (main thread, after every recorder ended).
+     * Adds its stats and submits anything it couldn't submit itself.
+     */
+    void merge(Recorder& recorder);
+    
+    // Recorders write vertices, so instanced batches draw directly instead
+    bool supportsRecorders() const { return m_geometry == Geometry::Vertices; }
+    
+    VertexFormat getVertexFormat() const { return m_vertexFormat; }
+    
 private:
     // Vertex format for sprites
     struct SpriteVertex {
@@ -182,34 +407,426 @@ private:
         float u, v;         // Texture coordinates
         uint32_t color;     // ABGR packed color
         
+        static SpriteVertex make(float x, float y, float z, float u, float v,
+                                 uint32_t color, float /*slot*/) {
+            return { x, y, z, u, v, color };
+        }
+        static bgfx::VertexLayout& getLayout();
+    };
+    
+    // Vertex format for texture-slot mode (adds the sampler slot index)
+    struct SpriteVertexSlot {
+        float x, y, z;      // Position
+        float u, v;         // Texture coordinates
+        uint32_t color;     // ABGR packed color
+        float slot;         // Index into the draw's texture table
+        
+        static SpriteVertexSlot make(float x, float y, float z, float u, float v,
+                                     uint32_t color, float slot) {
+            return { x, y, z, u, v, color, slot };
+        }
         static bgfx::VertexLayout& getLayout();
     };
     
-    // A queued sprite
+    // VertexFormat::Compact quantization: positions are normalized int16
+    // scaled by POSITION_RANGE (1/8 pixel steps); UVs are 16-bit fractions
+    // offset by -32768, since bgfx has no unsigned 16-bit attribute.
+    // Depth stays on the CPU (sort key and submit order), not in the vertex.
+    static constexpr float POSITION_SUBPIXELS = 8.0f;
+    static constexpr float POSITION_RANGE = 32767.0f / POSITION_SUBPIXELS; // Matches vs_sprite_compact.sc
+    static int16_t packPosition(float p) {
+        const float q = std::round(p * POSITION_SUBPIXELS);
+        return (int16_t)std::clamp(q, -32767.0f, 32767.0f);
+    }
+    static int16_t packUV(float t) {
+        return (int16_t)((int32_t)(std::clamp(t, 0.0f, 1.0f) * 65535.0f + 0.5f) - 32768);
+    }
+    
+    // Compact vertex (12 bytes)
+    struct SpriteVertexCompact {
+        int16_t x, y;       // Position
+        int16_t u, v;       // Texture coordinates
+        uint32_t color;     // ABGR packed color
+        
+        static SpriteVertexCompact make(float x, float y, float /*z*/, float u, float v,
+                                        uint32_t color, float /*slot*/) {
+            return { packPosition(x), packPosition(y), packUV(u), packUV(v), color };
+        }
+        static bgfx::VertexLayout& getLayout();
+    };
+    static_assert(sizeof(SpriteVertexCompact) == 12, "compact vertex must stay 12 bytes");
+    
+    // Compact vertex for texture-slot mode (16 bytes)
+    struct SpriteVertexSlotCompact {
+        int16_t x, y;       // Position
+        int16_t u, v;       // Texture coordinates
+        uint32_t color;     // ABGR packed color
+        uint8_t slot[4];    // Index into the draw's texture table (x only)
+        
+        static SpriteVertexSlotCompact make(float x, float y, float /*z*/, float u, float v,
+                                            uint32_t color, float slot) {
+            return { packPosition(x), packPosition(y), packUV(u), packUV(v), color,
+                     { (uint8_t)slot, 0, 0, 0 } };
+        }
+        static bgfx::VertexLayout& getLayout();
+    };
+    static_assert(sizeof(SpriteVertexSlotCompact) == 16, "compact slot vertex must stay 16 bytes");
+    
+    // Instance record for Geometry::Instanced (i_data0..i_data2)
+    struct SpriteInstance {
+        float x, y, width, height;  // Top-left and size
+        float u0, v0, u1, v1;       // UV rect
+        float rotation;             // Radians
+        float origin;               // originX | originY << 12, 12 bits each
+        float rgb;                  // 24-bit packed color (R low)
+        float alphaSlot;            // alpha | slot << 8
+        
+        static SpriteInstance make(float x, float y, float width, float height,
+                                   float rotation, float originX, float originY,
+                                   float u0, float v0, float u1, float v1,
+                                   uint32_t color, float slot);
+    };
+    static_assert(sizeof(SpriteInstance) == 48, "instance stride must be a multiple of 16");
+    
+    // A queued sprite (invalid texture = gradient quad)
     struct SpriteItem {
         bgfx::TextureHandle texture;
         SpriteVertex vertices[4];
-        float depth; // For sorting (lower = behind)
+        uint64_t key; // See sortKey
+    };
+    
+    // Queued sprites sort by a packed key, most significant bits first:
+    //   layer (8) | depth (32) | blend state (8) | texture (16)
+    // Layer and depth fix painter's order; blend state and texture only
+    // order sprites that are free to swap places (see reorderGroups)
+    static constexpr uint32_t KEY_ORDER_SHIFT = 24;
+    static constexpr uint64_t KEY_STATE_MASK = (1ull << KEY_ORDER_SHIFT) - 1;
+    uint64_t sortKey(bgfx::TextureHandle texture) const {
+        // Depth is never negative, so its bits order like its value
+        return ((uint64_t)m_layer << 56) |
+               ((uint64_t)std::bit_cast<uint32_t>(m_currentDepth) << KEY_ORDER_SHIFT) |
+               ((uint64_t)drawBlend() << 16) |
+               texture.idx;
+    }
+    static BlendMode keyBlend(uint64_t key) { return (BlendMode)((key >> 16) & 0xFF); }
+    
+    // A run of consecutive quads drawn with one submit.
+    // Holds every texture the run samples (just one unless slots are enabled).
+    // Gradient runs sample nothing; when streaming they index m_gradientVerts.
+    // Tile grid runs hold no quads and stand for one m_tileGridDraws entry.
+    struct DrawRun {
+        uint32_t firstQuad;
+        uint32_t quadCount;
+        uint8_t textureCount;
+        bgfx::TextureHandle textures[MAX_TEXTURE_SLOTS];
+        bool gradient = false;
+        int32_t tileGrid = -1;
+        BlendMode blend = BlendMode::Alpha;
+        uint32_t order = 0; // Painter's order position (see drawKey)
+        
+        // Slot of texture in this run, or -1 if not bound yet
+        int findSlot(bgfx::TextureHandle texture) const {
+            for (uint8_t i = 0; i < textureCount; ++i) {
+                if (textures[i].idx == texture.idx) return i;
+            }
+            return -1;
+        }
+        
+        // Slot of texture, binding it if fewer than maxTextures are bound; -1 when full
+        int bind(bgfx::TextureHandle texture, uint8_t maxTextures, uint32_t& swaps) {
+            const int slot = findSlot(texture);
+            if (slot >= 0) return slot;
+            if (textureCount >= maxTextures) return -1;
+            
+            textures[textureCount] = texture;
+            swaps++;
+            return textureCount++;
+        }
+    };
+    
+    // Submits carry (order << ORDER_SHIFT | sub) as their view depth; every
+    // batch run and recorder has its own order, recorder runs number the sub
+    static constexpr uint32_t ORDER_SHIFT = 12;
+    static constexpr uint32_t MAX_SUB_DRAWS = 1u << ORDER_SHIFT;
+    static uint32_t drawKey(uint32_t order, uint32_t sub) {
+        return (order << ORDER_SHIFT) | (sub < MAX_SUB_DRAWS ? sub : MAX_SUB_DRAWS - 1);
+    }
+    
+    // With depth testing, opaque submits take the lower half of the keys in
+    // reverse order (front to back) and the rest follow in the upper half
+    static constexpr uint32_t TRANSLUCENT_KEYS = 1u << 31;
+    static constexpr uint32_t MAX_ORDERS = TRANSLUCENT_KEYS >> ORDER_SHIFT;
+    static uint32_t opaqueKey(uint32_t order, uint32_t sub) {
+        return drawKey(MAX_ORDERS - 1 - std::min(order, MAX_ORDERS - 1), sub);
+    }
+    
+    // Depth of a depth-tested submit in [0, 1], nearer for later draws.
+    // Levels 2^-20 apart survive 24-bit depth buffers and float rounding;
+    // a recorder's runs past the 16th share the last level of its order
+    static constexpr uint32_t DEPTH_SUB_LEVELS = 16;
+    static constexpr float DEPTH_STEP = 1.0f / (1 << 20);
+    static float drawDepth(uint32_t order, uint32_t sub) {
+        const uint32_t level = order * DEPTH_SUB_LEVELS + std::min(sub, DEPTH_SUB_LEVELS - 1);
+        return std::max(1.0f - (float)(level + 1) * DEPTH_STEP, 0.0f);
+    }
+    
+    // Static tile grid vertices (column, row, corner), cached per size
+    struct TileGrid {
+        uint16_t cols, rows;
+        bgfx::VertexBufferHandle vertices;
+    };
+    
+    // u_tileGrid contents, laid out as in vs_tile_grid.sc
+    static constexpr uint16_t TILE_GRID_UNIFORMS = 5;
+    
+    // A tile grid draw (queued in order when streaming)
+    struct TileGridDraw {
+        bgfx::TextureHandle texture;
+        bgfx::VertexBufferHandle vertices;
+        uint32_t tileCount;
+        BlendMode blend;
+        float uniforms[TILE_GRID_UNIFORMS][4];
     };
     
     void flush();
-    void addQuad(bgfx::TextureHandle texture, const SpriteVertex verts[4], float depth);
+    void flushStream();
+    
+    // Queue indices in draw order (frame memory)
+    const uint32_t* sortQueue() const;
+    void reorderGroups(uint32_t* order, uint32_t count) const;
+    void reserveStream();
+    void submitRun(bgfx::Encoder* encoder, const DrawRun& run,
+                   const bgfx::TransientVertexBuffer* tvb, uint32_t sub = 0) const;
+    void submitTileGrid(bgfx::Encoder* encoder, const TileGridDraw& draw, uint32_t order) const;
+    
+    // Sets render state (and depth placement) for one draw and submits it
+    void submitDraw(bgfx::Encoder* encoder, bgfx::ProgramHandle program, BlendMode blend,
+                    uint32_t order, uint32_t sub) const;
+    bgfx::VertexBufferHandle tileGridVertices(uint16_t cols, uint16_t rows);
+    
+    // Slot of texture in run, binding it if the run has room; -1 when full
+    int bindSlot(DrawRun& run, bgfx::TextureHandle texture);
+    
+    bool usesSlots() const { return m_slotCount > 1; }
+    bgfx::ProgramHandle gradientProgram() const;
+    bool streams() const { return m_streaming || m_geometry == Geometry::Instanced; }
+    const bgfx::VertexLayout& vertexLayout() const {
+        if (m_vertexFormat == VertexFormat::Compact) {
+            return usesSlots() ? SpriteVertexSlotCompact::getLayout() : SpriteVertexCompact::getLayout();
+        }
+        return usesSlots() ? SpriteVertexSlot::getLayout() : SpriteVertex::getLayout();
+    }
+    
+    // Calls fn with a null pointer of the GPU vertex type in use, so vertex
+    // writers are instantiated per layout and the layout is picked once per
+    // call rather than per vertex
+    template<typename Fn>
+    void withGpuVertex(Fn&& fn) const {
+        if (m_vertexFormat == VertexFormat::Compact) {
+            if (usesSlots()) fn(static_cast<SpriteVertexSlotCompact*>(nullptr));
+            else fn(static_cast<SpriteVertexCompact*>(nullptr));
+        } else {
+            if (usesSlots()) fn(static_cast<SpriteVertexSlot*>(nullptr));
+            else fn(static_cast<SpriteVertex*>(nullptr));
+        }
+    }
+    
+    // Returns storage for the next quad's 4 vertices or instance record
+    // (queue or stream), or nullptr if no space could be reserved.
+    // Streamed quads get their slot.
+    void* allocQuad(bgfx::TextureHandle texture, float& slot);
+    void emitSprite(bgfx::TextureHandle texture,
+                    float x, float y, float width, float height,
+                    float rotation, float originX, float originY,
+                    float u0, float v0, float u1, float v1,
+                    uint32_t color);
+    
+    // Apply the setAlpha() multiplier to a packed ABGR color
+    uint32_t fadeColor(uint32_t color) const { return fadeColor(color, m_alpha, drawBlend()); }
+    static uint32_t fadeColor(uint32_t color, uint8_t alpha, BlendMode blend) {
+        // Premultiplied color (Premultiplied, Multiply) fades in every channel
+        const bool premultiplied = blend == BlendMode::Premultiplied || blend == BlendMode::Multiply;
+        const uint32_t channels = premultiplied ? 4 : 1;
+        for (uint32_t i = 4 - channels; i < 4; ++i) {
+            const uint32_t shift = i * 8;
+            const uint32_t c = (((color >> shift) & 0xFF) * alpha + 127) / 255;
+            color = (color & ~(0xFFu << shift)) | (c << shift);
+        }
+        return color;
+    }
+    
+    // Blend mode of the next draw: opaque draws blend while faded
+    BlendMode drawBlend() const {
+        return (m_blendMode == BlendMode::Opaque && m_alpha != 255) ? BlendMode::Alpha : m_blendMode;
+    }
+    
+    template<typename Vertex>
+    static void writeQuad(Vertex* v, const float corners[4][2], float z,
+                          float u0, float v0, float u1, float v1,
+                          uint32_t color, float slot) {
+        v[0] = Vertex::make(corners[0][0], corners[0][1], z, u0, v0, color, slot); // TL
+        v[1] = Vertex::make(corners[1][0], corners[1][1], z, u1, v0, color, slot); // TR
+        v[2] = Vertex::make(corners[2][0], corners[2][1], z, u0, v1, color, slot); // BL
+        v[3] = Vertex::make(corners[3][0], corners[3][1], z, u1, v1, color, slot); // BR
+    }
+    
+    // Re-encode a queued quad in another vertex layout
+    template<typename Vertex>
+    static void convertQuad(Vertex* dst, const SpriteVertex src[4], float slot) {
+        for (int i = 0; i < 4; ++i) {
+            dst[i] = Vertex::make(src[i].x, src[i].y, src[i].z, src[i].u, src[i].v, src[i].color, slot);
+        }
+    }
+    
+    // writeQuad() in the batch's GPU layout
+    void writeGpuQuad(void* dst, const float corners[4][2], float z,
+                      float u0, float v0, float u1, float v1,
+                      uint32_t color, float slot) const {
+        withGpuVertex([&](auto* type) {
+            writeQuad(static_cast<decltype(type)>(dst), corners, z, u0, v0, u1, v1, color, slot);
+        });
+    }
+    
+    // True if the sprite can't touch cull (conservative for rotated sprites)
+    static bool isCulled(const Rect& cull, float x, float y, float width, float height,
+                         float rotation, float originX, float originY);
+    
+    static void regionUVs(const TextureHandle& texture, const Rect& srcRect,
+                          float& u0, float& v0, float& u1, float& v1);
+    static void rotatedCorners(float x, float y, float width, float height,
+                               float rotation, float originX, float originY,
+                               float out[4][2]);
     
     // GPU resources
     bgfx::ProgramHandle m_program = BGFX_INVALID_HANDLE;
+    bgfx::ProgramHandle m_slotProgram = BGFX_INVALID_HANDLE;
     bgfx::UniformHandle m_texUniform = BGFX_INVALID_HANDLE;
+    bgfx::UniformHandle m_slotUniforms[MAX_TEXTURE_SLOTS] = {};
+    bgfx::IndexBufferHandle m_indexBuffer = BGFX_INVALID_HANDLE; // 6 indices per quad
+    bgfx::VertexBufferHandle m_unitQuad = BGFX_INVALID_HANDLE;   // Instanced only
+    bgfx::ProgramHandle m_gradientProgram = BGFX_INVALID_HANDLE;
+    bgfx::TextureHandle m_whiteTexture = BGFX_INVALID_HANDLE;    // Smooth gradient fallback
+    bgfx::ProgramHandle m_tileProgram = BGFX_INVALID_HANDLE;
+    bgfx::UniformHandle m_tileUniform = BGFX_INVALID_HANDLE;     // u_tileGrid[TILE_GRID_UNIFORMS]
+    
+    // Shader files of each program (see reloadShaders)
+    struct ShaderSource {
+        std::string vs, fs;
+    };
+    ShaderSource m_programSource;
+    ShaderSource m_slotSource;
+    ShaderSource m_gradientSource;
+    ShaderSource m_tileSource;
+    std::vector<TileGrid> m_tileGrids;
+    Geometry m_geometry = Geometry::Vertices;
+    VertexFormat m_vertexFormat = VertexFormat::Float;
     
     // Batch state
     bool m_begun = false;
     bgfx::ViewId m_viewId = 0;
     uint16_t m_screenW = 0;
     uint16_t m_screenH = 0;
+    uint8_t m_slotCount = 1; // Textures bound per draw
+    uint8_t m_alpha = 255;   // Global alpha multiplier
+    Rect m_cullRect;         // Sprites entirely outside are dropped
+    uint8_t m_layer = 0;     // Layer of queued sprites (see setLayer)
+    BlendMode m_blendMode = BlendMode::Alpha;
+    bool m_depthTest = false; // Target has a depth buffer (see begin)
+    uint32_t m_nextOrder = 0; // Painter's order position of the next run
+    bool m_closeRun = false;  // Next quad starts a run (positions were reserved)
     
     // Sprite queue
     std::vector<SpriteItem> m_sprites;
     uint32_t m_maxSprites = DEFAULT_MAX_SPRITES;
     float m_currentDepth = 0.0f;
     
+    // Streaming state (see setStreaming)
+    bool m_streaming = false;
+    bgfx::TransientVertexBuffer m_streamTvb{};
+    bgfx::InstanceDataBuffer m_instanceBuffer{};
+    uint8_t* m_streamVerts = nullptr;
+    uint32_t m_streamCapacity = 0; // Quads
+    uint32_t m_streamCount = 0;    // Quads written
+    std::vector<DrawRun> m_runs;
+    std::vector<SpriteVertex> m_gradientVerts; // Streamed gradient quads (4 per quad)
+    std::vector<TileGridDraw> m_tileGridDraws; // Streamed tile grids, indexed by their runs
+    
     // Stats
     Stats m_stats;
 };
+
+/**
+ * Per-thread recording context for a SpriteBatch.
+ * 
+ * A recorder writes its sprites into its own slice of transient vertex
+ * memory and submits them through its own bgfx encoder, so several worker
+ * threads can record at once. Each recorder draws at a painter's order
+ * position reserved on the batch, so the merged result is the same as
+ * drawing everything on one thread in position order.
+ * 
+ * Usage (the batch is begun on the main thread):
+ *   const uint32_t order = batch.reserveRecorders(count);
+ *   jobs.parallelFor(count, 1, [&](size_t begin, size_t end) {
+ *       for (size_t i = begin; i < end; ++i) {
+ *           recorders[i].begin(batch, order + (uint32_t)i, maxSprites);
+ *           recorders[i].drawRegion(texture, x, y, w, h, srcRect);
+ *           recorders[i].end();
+ *       }
+ *   });
+ *   for (auto& recorder : recorders) batch.merge(recorder);
+ * 
+ * Nothing may be drawn to the batch itself while recorders are recording.
+ * Sprites are unrotated; a recorder holds at most the batch's maxSprites.
+ */
+class SpriteBatch::Recorder {
+public:
+    /**
+     * Start recording (on the recording thread).
+     * 
+     * @param batch Begun batch whose programs, slots, alpha and blend mode are used
+     * @param order Position from batch.reserveRecorders()
+     * @param maxSprites Sprites this recorder may draw (vertex space is reserved up front)
+     * @return false if the batch can't take recorders or no space was
+     *         available (draws are then ignored until end())
+     */
+    bool begin(const SpriteBatch& batch, uint32_t order, uint32_t maxSprites);
+    
+    void draw(const TextureHandle& texture, float x, float y,
+              float width, float height, Color color = Color::white());
+    void drawRegion(const TextureHandle& texture, float x, float y,
+                    float dstWidth, float dstHeight, const Rect& srcRect,
+                    Color color = Color::white());
+    
+    /**
+     * Submit the recorded draws through this thread's encoder.
+     * If no encoder is free they are kept for SpriteBatch::merge().
+     */
+    void end();
+    
+    bool isRecording() const { return m_recording; }
+    
+    // Draws and sprites since begin() (added to the batch by merge())
+    const Stats& getStats() const { return m_stats; }
+    
+private:
+    friend class SpriteBatch;
+    
+    void emitQuad(bgfx::TextureHandle texture, float x, float y, float width, float height,
+                  float u0, float v0, float u1, float v1, uint32_t color);
+    
+    const SpriteBatch* m_batch = nullptr;
+    bool m_recording = false;
+    uint32_t m_order = 0;
+    uint8_t m_alpha = 255;
+    BlendMode m_blend = BlendMode::Alpha;
+    Rect m_cullRect;
+    
+    bgfx::TransientVertexBuffer m_tvb{};
+    uint32_t m_stride = 0;   // Bytes per vertex
+    uint32_t m_capacity = 0; // Quads
+    uint32_t m_count = 0;    // Quads written
+    uint32_t m_dropped = 0;  // Quads past capacity
+    std::vector<DrawRun> m_runs; // Reused across frames
+    
+    Stats m_stats;
+};
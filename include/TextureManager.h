@@ -10,32 +10,63 @@
  *   - Caches textures by path (no duplicate loads)
  *   - Handles texture destruction on shutdown
  *   - Provides texture metadata (dimensions)
+ *   - Optional atlasing: small images are shelf-packed into shared pages
+ *   - Asynchronous loading: PNGs decode on worker threads and upload
+ *     under a per-frame budget
+ *   - Cooked cache: pre-decoded BGRA pixels memory-mapped from one file,
+ *     skipping PNG decoding and procedural generation at startup
  * 
  * Usage:
  *   TextureManager textures;
+ *   textures.enableAtlas();  // optional, before loading
  *   TextureHandle handle = textures.load("assets/player.png");
  *   // Use handle.texture with SpriteBatch
+ *
+ *   TextureHandle bg = textures.loadAsync("assets/bg.png");  // transparent until uploaded
+ *   textures.processUploads();  // once per frame on the main thread
+ *
+ *   textures.openCookedCache("assets/textures.cooked");  // optional, written by pixel_sim_cook
  *   // Textures auto-destroyed when TextureManager is destroyed
  */
 
 #include <bgfx/bgfx.h>
+#include "MappedFile.h"
 #include <string>
 #include <unordered_map>
 #include <cstdint>
 #include <vector>
 #include <functional>
+#include <memory>
+#include <type_traits>
+
+class ThreadPool;
 
 struct TextureHandle {
     bgfx::TextureHandle texture = BGFX_INVALID_HANDLE;
     uint16_t width  = 0;
     uint16_t height = 0;
     
+    // Normalized region of `texture` holding this image.
+    // The whole texture unless the image was packed into an atlas page.
+    float u0 = 0.0f, v0 = 0.0f;
+    float u1 = 1.0f, v1 = 1.0f;
+    
     bool isValid() const { return bgfx::isValid(texture); }
+    bool isAtlased() const { return u0 != 0.0f || v0 != 0.0f || u1 != 1.0f || v1 != 1.0f; }
 };
 
 class TextureManager {
 public:
-    TextureManager() = default;
+    // Called on the main thread once an async load is on the GPU (invalid handle on failure)
+    using LoadCallback = std::function<void(const TextureHandle&)>;
+    
+    static constexpr uint32_t DEFAULT_UPLOAD_BUDGET = 2u * 1024u * 1024u; // Bytes per processUploads()
+    static constexpr size_t WORKER_THREADS = 0; // Decode/generation pool size (0 = hardware threads - 1)
+    
+    // Fills one frame of a sheet: pixels[y * stride + x] = 0xAARRGGBB
+    using FrameGenerator = std::function<void(int frame, uint32_t* pixels, size_t stride)>;
+    
+    TextureManager();
     ~TextureManager();
     
     // Non-copyable (owns GPU resources)
@@ -46,6 +77,31 @@ public:
     TextureManager(TextureManager&& other) noexcept;
     TextureManager& operator=(TextureManager&& other) noexcept;
     
+    /**
+     * Pack textures created from now on into shared atlas pages.
+     * 
+     * @param pageSize Width and height of each atlas page in pixels
+     * @param maxEntrySize Images wider or taller than this keep their own texture
+     * 
+     * Notes:
+     *   - Handles of atlased images carry their sub-rect (u0/v0/u1/v1);
+     *     SpriteBatch remaps UVs automatically
+     *   - Each image gets a 1px extruded border so point sampling at the
+     *     edges never picks up a neighbour
+     *   - Space of unloaded atlas images is not reclaimed until clear()
+     */
+    void enableAtlas(uint16_t pageSize = 2048, uint16_t maxEntrySize = 512);
+    
+    /**
+     * Stop atlasing new textures (existing pages stay alive).
+     */
+    void disableAtlas() { m_atlasEnabled = false; }
+    
+    /**
+     * Number of atlas pages currently allocated.
+     */
+    size_t atlasPageCount() const { return m_pages.size(); }
+    
     /**
      * Load a texture from a PNG file.
      * 
@@ -59,6 +115,38 @@ public:
      */
     TextureHandle load(const std::string& path);
     
+    /**
+     * Load a texture from a PNG file on a background thread.
+     * 
+     * @param path Path to the PNG file
+     * @param onLoaded Optional callback, run from processUploads() once the pixels are uploaded
+     * @return Final TextureHandle (size and atlas region already set), or invalid handle on failure
+     * 
+     * Notes:
+     *   - Only the PNG header is read before returning; decoding runs on a worker
+     *   - The texture is fully transparent until its upload, so it can be drawn right away
+     *   - Cached like load(); a path that is still loading returns the same pending handle
+     */
+    TextureHandle loadAsync(const std::string& path, LoadCallback onLoaded = {});
+    
+    /**
+     * Upload finished async loads and run their callbacks (call once per frame on the main thread).
+     * 
+     * @param maxBytes Upload budget for this call; at least one image is always uploaded
+     */
+    void processUploads(uint32_t maxBytes = DEFAULT_UPLOAD_BUDGET);
+    
+    /**
+     * Block until every pending async load has been uploaded.
+     */
+    void waitForLoads();
+    
+    /**
+     * Number of async loads not uploaded yet.
+     */
+    size_t pendingLoads() const { return m_pending.size(); }
+    bool isLoading(const std::string& path) const { return m_pending.count(path) != 0; }
+    
     /**
      * Create a solid color 1x1 texture (useful for untextured colored quads).
      * 
@@ -106,6 +194,8 @@ public:
      * @param name Unique name
      * @param frameWidth, frameHeight Frame dimensions
      * @param frameCount Number of frames
+     * @param version Generator version, part of the cooked cache key:
+     *                bump it whenever the generator's output changes
      * @param generator Function called for each pixel: (frameIndex, x, y) -> RGBA color
      * @return TextureHandle
      */
@@ -114,9 +204,114 @@ public:
         uint16_t frameWidth,
         uint16_t frameHeight,
         int frameCount,
+        uint32_t version,
         std::function<uint32_t(int frame, int x, int y)> generator
         );
     
+    /**
+     * Same as above, with the generator inlined into the pixel loop
+     * (picked automatically for lambdas).
+     *
+     * Frames may be generated in parallel, so the generator must not
+     * modify shared state.
+     */
+    template <typename Generator>
+        requires std::is_invocable_r_v<uint32_t, Generator&, int, int, int>
+    TextureHandle createTestSpriteSheet(
+        const std::string& name,
+        uint16_t frameWidth,
+        uint16_t frameHeight,
+        int frameCount,
+        uint32_t version,
+        Generator&& generator
+        ) {
+        return createSpriteSheetFrames(name, frameWidth, frameHeight, frameCount, version,
+            [&generator, frameWidth, frameHeight](int frame, uint32_t* pixels, size_t stride) {
+                for (int y = 0; y < frameHeight; ++y) {
+                    uint32_t* row = pixels + (size_t)y * stride;
+                    for (int x = 0; x < frameWidth; ++x) {
+                        row[x] = generator(frame, x, y);
+                    }
+                }
+            });
+    }
+    
+    /**
+     * Create a sprite sheet one whole frame at a time.
+     * Lets generators hoist per-row or per-column math out of the pixel loop.
+     *
+     * @param version Generator version (see createTestSpriteSheet)
+     * @param generator Called once per frame (possibly on several threads at once)
+     *                  with that frame's top-left pixel and the sheet's row stride
+     * @return TextureHandle
+     *
+     * Notes:
+     *   - Cached by name in memory and in the cooked cache (keyed by size,
+     *     frame count and version)
+     *   - Debug builds always generate and report a cooked copy that differs,
+     *     i.e. a generator edited without a version bump
+     */
+    TextureHandle createSpriteSheetFrames(
+        const std::string& name,
+        uint16_t frameWidth,
+        uint16_t frameHeight,
+        int frameCount,
+        uint32_t version,
+        const FrameGenerator& generator
+        );
+    
+    /**
+     * Serve textures from a cooked cache file (see pixel_sim_cook).
+     * 
+     * @param path Cache file written by writeCookedCache()
+     * @return true if the file was mapped and its header is valid
+     * 
+     * Notes:
+     *   - load(), loadAsync() and createTestSpriteSheet() check the cache first;
+     *     a PNG is only decoded when its file contents changed since cooking
+     *   - Generated sheets are keyed by name, size and generator version
+     *   - Standalone textures reference the mapping without a copy, so keep it
+     *     open while bgfx may still read it (until clear() or destruction)
+     */
+    bool openCookedCache(const std::string& path);
+    void closeCookedCache();
+    bool hasCookedCache() const { return m_cookedFile.isOpen(); }
+    
+    /**
+     * Record the pixels of every loaded PNG and generated sheet for writeCookedCache().
+     */
+    void setCookRecording(bool enabled);
+    
+    /**
+     * Write everything recorded since setCookRecording(true) to a cache file.
+     * 
+     * @return true on success
+     */
+    bool writeCookedCache(const std::string& path) const;
+    
+    /**
+     * Keep textures created from now on updatable in place (see reload()).
+     * Development only: bgfx can't update textures created with their pixels,
+     * so standalone textures then take one extra upload each.
+     */
+    void enableHotReload() { m_hotReload = true; }
+    bool isHotReloadEnabled() const { return m_hotReload; }
+    
+    /**
+     * Decode a loaded PNG again and upload it over its existing texture or
+     * atlas slot, so every TextureHandle handed out stays valid.
+     * 
+     * @param path Path the texture was loaded with
+     * @param sourcePath File to decode instead (e.g. the original of a copied asset)
+     * @return true if it was re-uploaded; false if it isn't a loaded image,
+     *         is still loading, fails to decode, or changed size (restart for that)
+     * 
+     * Notes:
+     *   - Standalone (unatlased) textures need enableHotReload() before their creation
+     *   - Always decodes the file: the cooked cache is bypassed, not updated
+     */
+    bool reload(const std::string& path, const std::string& sourcePath = {});
+    
     /**
      * Get a previously loaded texture by path.
      * 
@@ -136,5 +331,101 @@ public:
     void clear();
     
 private:
+    // Shelf packer state for one atlas page
+    struct AtlasShelf {
+        uint16_t y;
+        uint16_t height;
+        uint16_t cursorX;
+    };
+    
+    struct AtlasPage {
+        bgfx::TextureHandle texture = BGFX_INVALID_HANDLE;
+        std::vector<AtlasShelf> shelves;
+        uint16_t usedHeight = 0;
+    };
+    
+    // Where an atlased image lives in its page (padded origin)
+    struct AtlasSlot {
+        uint16_t x = 0;
+        uint16_t y = 0;
+        bool used = false;
+    };
+    
+    // Async load waiting for its decoded pixels
+    struct PendingLoad {
+        TextureHandle handle;
+        AtlasSlot slot;
+        std::vector<LoadCallback> callbacks;
+    };
+    
+    // Worker output, handed to the main thread
+    struct DecodedImage {
+        std::string path;
+        bgfx::TextureHandle texture = BGFX_INVALID_HANDLE;
+        uint8_t* pixels = nullptr; // BGRA, owned (stbi_image_free)
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+    };
+    
+    struct AsyncState;
+    
+    // Cooked cache entry (pixels point into the mapping)
+    struct CookedRecord {
+        uint64_t contentHash = 0;
+        const uint8_t* pixels = nullptr;
+        uint16_t width = 0;
+        uint16_t height = 0;
+    };
+    
+    // Recorded for writeCookedCache()
+    struct CookedImage {
+        std::string name;
+        uint64_t contentHash = 0;
+        uint16_t width = 0;
+        uint16_t height = 0;
+        std::vector<uint8_t> bgra;
+    };
+    
+    // Create (or atlas) a texture from BGRA pixels and cache it under name.
+    // With null pixels the texture is transparent and can be updated later.
+    TextureHandle createTexture(const std::string& name, uint16_t width, uint16_t height,
+                                const uint8_t* bgra, AtlasSlot* outSlot = nullptr,
+                                bool referencePixels = false);
+    // Create from the cooked cache; invalid if missing or the hash differs (null = don't check)
+    TextureHandle createFromCooked(const std::string& name, const uint64_t* contentHash);
+    void recordCooked(const std::string& name, uint64_t contentHash, uint16_t width, uint16_t height,
+                      const uint8_t* bgra);
+    // Report a cooked copy with this key whose pixels differ (a generator changed, version didn't)
+    void verifyCooked(const std::string& name, uint64_t contentHash, uint16_t width, uint16_t height,
+                      const uint8_t* bgra) const;
+    void uploadToAtlas(bgfx::TextureHandle page, const AtlasSlot& slot,
+                       uint16_t width, uint16_t height, const uint8_t* bgra);
+    bool packIntoAtlas(uint16_t w, uint16_t h, bgfx::TextureHandle& outPage,
+                       uint16_t& outX, uint16_t& outY);
+    bool allocateInPage(AtlasPage& page, uint16_t w, uint16_t h, uint16_t& outX, uint16_t& outY);
+    bool isAtlasPage(bgfx::TextureHandle texture) const;
+    ThreadPool& workers();
+    
     std::unordered_map<std::string, TextureHandle> m_cache;
+    bool m_hotReload = false; // Standalone textures stay mutable
+    
+    // Atlas
+    bool m_atlasEnabled = false;
+    uint16_t m_atlasPageSize = 2048;
+    uint16_t m_atlasMaxEntry = 512;
+    std::vector<AtlasPage> m_pages;
+    
+    // Async loading and sheet generation (pool created on first use)
+    std::unique_ptr<ThreadPool> m_loader;
+    std::shared_ptr<AsyncState> m_async;
+    std::unordered_map<std::string, PendingLoad> m_pending;
+    
+    // Cooked cache
+    MappedFile m_cookedFile;
+    std::unordered_map<std::string, CookedRecord> m_cookedEntries;
+    bool m_cookRecording = false;
+    std::vector<CookedImage> m_cookList;
+    
+    std::vector<uint8_t> m_convertScratch; // createFromRGBA() staging
 };
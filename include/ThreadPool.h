@@ -0,0 +1,65 @@
+#pragma once
+
+/*
+ * ThreadPool.h
+ *
+ * Small fixed-size worker pool for blocking background work
+ * (file IO, image decoding).
+ *
+ * Usage:
+ *   ThreadPool pool(2);
+ *   pool.submit([] { decodeSomething(); });
+ *   pool.waitIdle();   // optional: block until the queue drains
+ *   pool.parallelFor(frames, [&](size_t i) { fillFrame(i); });
+ *   // Workers are joined when the pool is destroyed (queued jobs still run)
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    /**
+     * @param threadCount Number of workers (0 = hardware threads - 1, at least 1)
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Queue a job. Jobs run in FIFO order across the workers.
+     */
+    void submit(std::function<void()> job);
+
+    /**
+     * Block until every queued and running job has finished.
+     */
+    void waitIdle();
+
+    /**
+     * Run body(0..count-1) across the workers and the calling thread,
+     * returning once every index is done. Other queued jobs are unaffected,
+     * so this makes progress even while the workers are busy.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    size_t threadCount() const { return m_workers.size(); }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_jobReady;
+    std::condition_variable m_idle;
+    size_t m_running = 0;
+    bool m_stopping = false;
+};
@@ -0,0 +1,22 @@
+$input v_texcoord0
+
+#include <bgfx_shader.sh>
+
+SAMPLER2D(s_tex, 0);
+
+// u_blitParams: canvas width, height, window pixels per canvas pixel
+uniform vec4 u_blitParams;
+
+void main()
+{
+    // Sharp bilinear (needs linear filtering): the centre of each texel
+    // samples that texel alone, only the last half window pixel before an
+    // edge blends into the neighbour, so any scale keeps square pixels
+    vec2 size = u_blitParams.xy;
+    float scale = max(u_blitParams.z, 1.0);
+    vec2 texel = v_texcoord0 * size;
+    vec2 fromCenter = fract(texel) - 0.5;
+    vec2 inner = vec2_splat(0.5 - 0.5 / scale);
+    vec2 offset = (fromCenter - clamp(fromCenter, -inner, inner)) * scale + 0.5;
+    gl_FragColor = texture2D(s_tex, (floor(texel) + offset) / size);
+}
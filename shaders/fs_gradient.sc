@@ -0,0 +1,40 @@
+$input v_texcoord0, v_color0
+
+#include <bgfx_shader.sh>
+
+// v_texcoord0.x: band count (< 2 = smooth), v_texcoord0.y: 0..1 down the gradient
+
+// 4x4 ordered (Bayer) threshold in [0, 1)
+float bayer2(vec2 a)
+{
+    a = floor(a);
+    return fract(dot(a, vec2(0.5, a.y * 0.75)));
+}
+
+float bayer4(vec2 a)
+{
+    return bayer2(0.5 * a) * 0.25 + bayer2(a);
+}
+
+void main()
+{
+    vec4 color = v_color0;
+    float bands = v_texcoord0.x;
+    
+    if (bands >= 2.0)
+    {
+        // Color is linear in t, so the screen-space ratio of their
+        // derivatives recovers the per-unit-t color step
+        float t = v_texcoord0.y;
+        float dt = dFdy(t);
+        if (abs(dt) > 1e-6)
+        {
+            vec4 slope = dFdy(v_color0) / dt;
+            float steps = bands - 1.0;
+            float tq = clamp(floor(t * steps + bayer4(gl_FragCoord.xy)), 0.0, steps) / steps;
+            color = v_color0 + (tq - t) * slope;
+        }
+    }
+    
+    gl_FragColor = color;
+}
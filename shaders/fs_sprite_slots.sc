@@ -0,0 +1,29 @@
+$input v_texcoord0, v_color0, v_texslot
+
+#include <bgfx_shader.sh>
+
+SAMPLER2D(s_texSlot0, 0);
+SAMPLER2D(s_texSlot1, 1);
+SAMPLER2D(s_texSlot2, 2);
+SAMPLER2D(s_texSlot3, 3);
+SAMPLER2D(s_texSlot4, 4);
+SAMPLER2D(s_texSlot5, 5);
+SAMPLER2D(s_texSlot6, 6);
+SAMPLER2D(s_texSlot7, 7);
+
+void main()
+{
+    // Slot is constant per quad; compare against midpoints to absorb
+    // interpolation error. Explicit LOD keeps sampling valid in branches.
+    float slot = v_texslot;
+    vec4 texColor;
+    if      (slot < 0.5) texColor = texture2DLod(s_texSlot0, v_texcoord0, 0.0);
+    else if (slot < 1.5) texColor = texture2DLod(s_texSlot1, v_texcoord0, 0.0);
+    else if (slot < 2.5) texColor = texture2DLod(s_texSlot2, v_texcoord0, 0.0);
+    else if (slot < 3.5) texColor = texture2DLod(s_texSlot3, v_texcoord0, 0.0);
+    else if (slot < 4.5) texColor = texture2DLod(s_texSlot4, v_texcoord0, 0.0);
+    else if (slot < 5.5) texColor = texture2DLod(s_texSlot5, v_texcoord0, 0.0);
+    else if (slot < 6.5) texColor = texture2DLod(s_texSlot6, v_texcoord0, 0.0);
+    else                 texColor = texture2DLod(s_texSlot7, v_texcoord0, 0.0);
+    gl_FragColor = texColor * v_color0;
+}
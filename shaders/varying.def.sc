@@ -1,6 +1,12 @@
 vec2 v_texcoord0 : TEXCOORD0;
 vec4 v_color0    : COLOR0;
+float v_texslot  : TEXCOORD1;
 
 vec3 a_position  : POSITION;
 vec2 a_texcoord0 : TEXCOORD0;
 vec4 a_color0    : COLOR0;
+float a_texcoord1 : TEXCOORD1;
+
+vec4 i_data0 : TEXCOORD7;
+vec4 i_data1 : TEXCOORD6;
+vec4 i_data2 : TEXCOORD5;
@@ -5,7 +5,7 @@ $output v_texcoord0, v_color0
 
 void main()
 {
-    gl_Position = mul(u_viewProj, vec4(a_position.xyz, 1.0));
+    gl_Position = mul(u_modelViewProj, vec4(a_position.xyz, 1.0));
     v_texcoord0 = a_texcoord0;
     v_color0 = a_color0;
 }
@@ -0,0 +1,15 @@
+$input a_position, a_texcoord0, a_color0
+$output v_texcoord0, v_color0
+
+#include <bgfx_shader.sh>
+
+// SpriteVertexCompact: a_position.xy is normalized int16 in 1/8 pixel steps,
+// a_texcoord0 a 16-bit fraction offset by -32768 (SpriteBatch::packUV)
+
+void main()
+{
+    vec2 pos = a_position.xy * (32767.0 / 8.0);
+    gl_Position = mul(u_modelViewProj, vec4(pos, 0.0, 1.0));
+    v_texcoord0 = a_texcoord0 * (32767.0 / 65535.0) + (32768.0 / 65535.0);
+    v_color0 = a_color0;
+}
@@ -0,0 +1,33 @@
+$input a_position, i_data0, i_data1, i_data2
+$output v_texcoord0, v_color0, v_texslot
+
+#include <bgfx_shader.sh>
+
+// i_data0: x, y, width, height
+// i_data1: u0, v0, u1, v1
+// i_data2: rotation, origin (12+12 bits), rgb (24 bits), alpha | slot << 8
+
+void main()
+{
+    vec2 corner = a_position.xy;
+    vec2 size   = i_data0.zw;
+    
+    // Unpack origin (normalized) and rotate around it
+    vec2 origin = vec2(mod(i_data2.y, 4096.0), floor(i_data2.y / 4096.0)) / 4095.0;
+    vec2 pivot  = origin * size;
+    vec2 local  = corner * size - pivot;
+    
+    float c = cos(i_data2.x);
+    float s = sin(i_data2.x);
+    vec2 pos = i_data0.xy + pivot + vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+    
+    gl_Position = mul(u_modelViewProj, vec4(pos, 0.0, 1.0));
+    v_texcoord0 = mix(i_data1.xy, i_data1.zw, corner);
+    
+    float rgb = i_data2.z;
+    v_color0 = vec4(mod(rgb, 256.0),
+                    mod(floor(rgb / 256.0), 256.0),
+                    floor(rgb / 65536.0),
+                    mod(i_data2.w, 256.0)) / 255.0;
+    v_texslot = floor(i_data2.w / 256.0);
+}
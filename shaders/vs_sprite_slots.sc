@@ -0,0 +1,12 @@
+$input a_position, a_texcoord0, a_color0, a_texcoord1
+$output v_texcoord0, v_color0, v_texslot
+
+#include <bgfx_shader.sh>
+
+void main()
+{
+    gl_Position = mul(u_modelViewProj, vec4(a_position.xyz, 1.0));
+    v_texcoord0 = a_texcoord0;
+    v_color0 = a_color0;
+    v_texslot = a_texcoord1;
+}
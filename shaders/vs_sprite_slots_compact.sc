@@ -0,0 +1,16 @@
+$input a_position, a_texcoord0, a_color0, a_texcoord1
+$output v_texcoord0, v_color0, v_texslot
+
+#include <bgfx_shader.sh>
+
+// SpriteVertexSlotCompact: as vs_sprite_compact, plus the slot index as a
+// normalized byte
+
+void main()
+{
+    vec2 pos = a_position.xy * (32767.0 / 8.0);
+    gl_Position = mul(u_modelViewProj, vec4(pos, 0.0, 1.0));
+    v_texcoord0 = a_texcoord0 * (32767.0 / 65535.0) + (32768.0 / 65535.0);
+    v_color0 = a_color0;
+    v_texslot = floor(a_texcoord1 * 255.0 + 0.5);
+}
@@ -0,0 +1,32 @@
+$input a_position, a_texcoord0
+$output v_texcoord0, v_color0
+
+#include <bgfx_shader.sh>
+
+// u_tileGrid[0]: grid x, y, tile width, height
+// u_tileGrid[1]: frame u0, v0, width, height (normalized)
+// u_tileGrid[2]: limit x, y, wave amplitude, wave frequency
+// u_tileGrid[3]: wave phase
+// u_tileGrid[4]: tint
+uniform vec4 u_tileGrid[5];
+
+void main()
+{
+    vec4 place  = u_tileGrid[0];
+    vec4 frame  = u_tileGrid[1];
+    vec4 limits = u_tileGrid[2];
+    
+    // a_position: tile column and row, a_texcoord0: corner (0 or 1)
+    vec2 origin = place.xy + a_position.xy * place.zw;
+    
+    // Tiles starting past the region collapse to a point
+    float keep = (1.0 - step(limits.x, origin.x)) * (1.0 - step(limits.y, origin.y));
+    vec2 corner = a_texcoord0 * keep;
+    
+    // Whole rows shift along a sine wave
+    origin.x += sin((origin.y * limits.w + u_tileGrid[3].x) * 6.28318) * limits.z;
+    
+    gl_Position = mul(u_modelViewProj, vec4(origin + corner * place.zw, 0.0, 1.0));
+    v_texcoord0 = frame.xy + corner * frame.zw;
+    v_color0 = u_tileGrid[4];
+}
@@ -0,0 +1,168 @@
+/*
+ * FileWatcher.cpp
+ *
+ * inotify watcher thread, with a modification-time scan elsewhere.
+ */
+
+#include "FileWatcher.h"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Longest the watcher thread goes without checking for stop()
+static constexpr int STOP_CHECK_MS = 100;
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::watch(const std::string& directory) {
+    if (isRunning()) {
+        std::fprintf(stderr, "FileWatcher: watch() called while running\n");
+        return false;
+    }
+
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec)) {
+        std::fprintf(stderr, "FileWatcher: Not a directory: %s\n", directory.c_str());
+        return false;
+    }
+
+    m_directories.push_back(directory);
+    for (fs::recursive_directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+        if (it->is_directory(ec)) {
+            m_directories.push_back(it->path().generic_string());
+        }
+    }
+    return true;
+}
+
+bool FileWatcher::start() {
+    if (isRunning()) return true;
+    if (m_directories.empty()) {
+        std::fprintf(stderr, "FileWatcher: Nothing to watch\n");
+        return false;
+    }
+
+#if defined(__linux__)
+    // Watches are added here so a failure is reported to the caller
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify < 0) {
+        std::fprintf(stderr, "FileWatcher: inotify_init1 failed: %s\n", std::strerror(errno));
+        return false;
+    }
+
+    for (const std::string& directory : m_directories) {
+        const int wd = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0) {
+            std::fprintf(stderr, "FileWatcher: Can't watch %s: %s\n", directory.c_str(), std::strerror(errno));
+            continue;
+        }
+        m_watches[wd] = directory;
+    }
+    if (m_watches.empty()) {
+        ::close(m_inotify);
+        m_inotify = -1;
+        return false;
+    }
+#endif
+
+    m_stopping = false;
+    m_thread = std::thread([this] { run(); });
+    return true;
+}
+
+#if defined(__linux__)
+
+void FileWatcher::run() {
+    alignas(inotify_event) char buffer[4096];
+
+    while (!m_stopping.load(std::memory_order_relaxed)) {
+        pollfd pfd = { m_inotify, POLLIN, 0 };
+        if (::poll(&pfd, 1, STOP_CHECK_MS) <= 0) continue;
+
+        ssize_t length;
+        while ((length = ::read(m_inotify, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t offset = 0; offset < length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += (ssize_t)(sizeof(inotify_event) + event->len);
+
+                auto dir = m_watches.find(event->wd);
+                if (dir == m_watches.end() || event->len == 0 || (event->mask & IN_ISDIR)) continue;
+                report(dir->second + "/" + event->name);
+            }
+        }
+    }
+
+    ::close(m_inotify);
+    m_inotify = -1;
+    m_watches.clear();
+}
+
+#else
+
+void FileWatcher::run() {
+    // Modification-time scan; the first pass only records the baseline
+    std::unordered_map<std::string, fs::file_time_type> times;
+    bool baseline = true;
+
+    while (!m_stopping.load(std::memory_order_relaxed)) {
+        for (const std::string& directory : m_directories) {
+            std::error_code ec;
+            for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+                if (!it->is_regular_file(ec)) continue;
+
+                const fs::file_time_type time = it->last_write_time(ec);
+                if (ec) continue;
+
+                std::string path = it->path().generic_string();
+                auto [entry, added] = times.try_emplace(path, time);
+                if (!added && entry->second != time) {
+                    entry->second = time;
+                    report(std::move(path));
+                } else if (added && !baseline) {
+                    report(std::move(path));
+                }
+            }
+        }
+        baseline = false;
+
+        // Sleep in short steps so stop() doesn't wait a whole interval
+        for (uint32_t slept = 0; slept < POLL_INTERVAL_MS && !m_stopping.load(std::memory_order_relaxed);
+             slept += STOP_CHECK_MS) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(STOP_CHECK_MS));
+        }
+    }
+}
+
+#endif
+
+void FileWatcher::stop() {
+    if (!m_thread.joinable()) return;
+
+    m_stopping = true;
+    m_thread.join();
+}
+
+void FileWatcher::report(std::string path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_changes.insert(std::move(path));
+}
+
+std::vector<std::string> FileWatcher::takeChanges() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> changes(m_changes.begin(), m_changes.end());
+    m_changes.clear();
+    return changes;
+}
@@ -0,0 +1,109 @@
+/*
+ * FrameArena.cpp
+ *
+ * Double-buffered bump allocation with heap fallback.
+ */
+
+#include "FrameArena.h"
+
+#include <cstdio>
+#include <new>
+
+FrameArena& FrameArena::get() {
+    static FrameArena arena;
+    return arena;
+}
+
+FrameArena::FrameArena(size_t capacity) {
+    for (Buffer& buffer : m_buffers) {
+        buffer.data = std::make_unique_for_overwrite<std::byte[]>(capacity);
+        buffer.capacity = capacity;
+    }
+}
+
+FrameArena::~FrameArena() {
+    for (Buffer& buffer : m_buffers) {
+        reset(buffer);
+    }
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    if (size == 0) size = 1;
+    m_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    Buffer& buffer = m_buffers[m_current];
+    const uintptr_t base = reinterpret_cast<uintptr_t>(buffer.data.get());
+
+    // Bump the offset; losing the race just retries from the new one
+    size_t offset = buffer.used.load(std::memory_order_relaxed);
+    for (;;) {
+        const size_t aligned = (size_t)(((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base);
+        const size_t end = aligned + size;
+        if (end > buffer.capacity) break;
+
+        if (buffer.used.compare_exchange_weak(offset, end, std::memory_order_relaxed)) {
+            return buffer.data.get() + aligned;
+        }
+    }
+
+    return allocateHeap(buffer, size, alignment);
+}
+
+void* FrameArena::allocateHeap(Buffer& buffer, size_t size, size_t alignment) {
+    m_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* data = ::operator new(size, std::align_val_t(alignment));
+
+    std::lock_guard<std::mutex> lock(m_heapMutex);
+    buffer.heapBlocks.push_back({ data, alignment });
+    buffer.heapBytes += size;
+    return data;
+}
+
+void FrameArena::reset(Buffer& buffer) {
+    for (const HeapBlock& block : buffer.heapBlocks) {
+        ::operator delete(block.data, std::align_val_t(block.alignment));
+    }
+    buffer.heapBlocks.clear();
+    buffer.heapBytes = 0;
+    buffer.used.store(0, std::memory_order_relaxed);
+}
+
+void FrameArena::nextFrame() {
+    m_current ^= 1;
+    Buffer& buffer = m_buffers[m_current];
+
+    // Overflowed last time it was current: make the whole frame fit next time
+    if (!buffer.heapBlocks.empty()) {
+        size_t needed = buffer.capacity + buffer.heapBytes;
+        for (const HeapBlock& block : buffer.heapBlocks) {
+            needed += block.alignment; // Alignment padding in the buffer
+        }
+
+        size_t capacity = buffer.capacity ? buffer.capacity : DEFAULT_CAPACITY;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+
+        reset(buffer);
+        buffer.data = std::make_unique_for_overwrite<std::byte[]>(capacity);
+        buffer.capacity = capacity;
+        std::printf("FrameArena: Grew to %zu KB per frame\n", capacity / 1024);
+    } else {
+        reset(buffer);
+    }
+
+    m_allocations.store(0, std::memory_order_relaxed);
+    m_heapAllocations.store(0, std::memory_order_relaxed);
+}
+
+FrameArena::Stats FrameArena::getStats() const {
+    const Buffer& buffer = m_buffers[m_current];
+
+    Stats stats;
+    stats.allocations = m_allocations.load(std::memory_order_relaxed);
+    stats.heapAllocations = m_heapAllocations.load(std::memory_order_relaxed);
+    stats.bytesUsed = buffer.used.load(std::memory_order_relaxed) + buffer.heapBytes;
+    stats.capacity = buffer.capacity;
+    return stats;
+}
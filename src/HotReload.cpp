@@ -0,0 +1,136 @@
+/*
+ * HotReload.cpp
+ *
+ * Routes watched file changes to textures, programs and shader rebuilds.
+ */
+
+#include "HotReload.h"
+
+#include "FileWatcher.h"
+#include "SpriteBatch.h"
+#include "TextureManager.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+// True if path is directly or indirectly inside directory and has the extension
+static bool matches(const std::string& path, const std::string& directory, const char* extension) {
+    if (directory.empty() || path.size() <= directory.size() + 1) return false;
+    if (path.compare(0, directory.size(), directory) != 0 || path[directory.size()] != '/') return false;
+
+    const size_t dot = path.rfind('.');
+    return dot != std::string::npos && path.compare(dot, std::string::npos, extension) == 0;
+}
+
+HotReload::HotReload() = default;
+
+HotReload::~HotReload() {
+    shutdown();
+}
+
+bool HotReload::init(const Config& config, TextureManager& textures, SpriteBatch& sprites) {
+    if (m_watcher) {
+        std::fprintf(stderr, "HotReload: Already initialized\n");
+        return false;
+    }
+
+    m_config = config;
+    m_textures = &textures;
+    m_sprites = &sprites;
+    if (!textures.isHotReloadEnabled()) {
+        std::fprintf(stderr, "HotReload: TextureManager::enableHotReload() wasn't called, "
+                             "only atlased textures will reload\n");
+    }
+
+    m_watcher = std::make_unique<FileWatcher>();
+    bool watching = false;
+    for (const std::string* directory : { &config.textureDir, &config.shaderDir, &config.shaderSourceDir }) {
+        if (!directory->empty() && m_watcher->watch(*directory)) {
+            std::printf("HotReload: Watching %s\n", directory->c_str());
+            watching = true;
+        }
+    }
+    if (!watching || !m_watcher->start()) {
+        m_watcher.reset();
+        return false;
+    }
+
+    if (!config.shaderSourceDir.empty() && !config.rebuildCommand.empty()) {
+        m_stopping = false;
+        m_builder = std::thread([this] { rebuildLoop(); });
+    }
+    return true;
+}
+
+void HotReload::shutdown() {
+    if (m_builder.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_buildMutex);
+            m_stopping = true;
+        }
+        m_buildRequested.notify_all();
+        m_builder.join();
+    }
+    m_watcher.reset();
+    m_shadersDirty = false;
+}
+
+bool HotReload::update() {
+    if (!m_watcher) return false;
+
+    bool changed = false;
+    for (const std::string& path : m_watcher->takeChanges()) {
+        if (matches(path, m_config.textureDir, ".png")) {
+            // "<textureDir>/ship.png" was loaded as "<textureKeyDir>/ship.png"
+            const std::string key = m_config.textureKeyDir + path.substr(m_config.textureDir.size());
+            changed |= m_textures->reload(key, path);
+        } else if (matches(path, m_config.shaderDir, ".bin")) {
+            m_shadersDirty = true;
+            m_shaderWriteTime = Clock::now();
+        } else if (matches(path, m_config.shaderSourceDir, ".sc")) {
+            requestRebuild();
+        }
+    }
+
+    // A rebuild rewrites binaries one by one: swap once they have all landed
+    if (m_shadersDirty && !m_building.load(std::memory_order_acquire) &&
+        Clock::now() - m_shaderWriteTime >= std::chrono::milliseconds(SHADER_SETTLE_MS)) {
+        m_shadersDirty = false;
+        m_sprites->reloadShaders();
+        changed = true;
+    }
+    return changed;
+}
+
+void HotReload::requestRebuild() {
+    if (!m_builder.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_buildMutex);
+        m_rebuildPending = true;
+        m_building.store(true, std::memory_order_release); // Hold swaps until it finishes
+    }
+    m_buildRequested.notify_one();
+}
+
+void HotReload::rebuildLoop() {
+    std::unique_lock<std::mutex> lock(m_buildMutex);
+    for (;;) {
+        m_buildRequested.wait(lock, [this] { return m_rebuildPending || m_stopping; });
+        if (m_stopping) return;
+        m_rebuildPending = false;
+
+        // The compiler's own output reports errors; the old binaries stay in place
+        lock.unlock();
+        std::printf("HotReload: Rebuilding shaders\n");
+        const int status = std::system(m_config.rebuildCommand.c_str());
+        if (status != 0) {
+            std::fprintf(stderr, "HotReload: Shader rebuild failed (status %d)\n", status);
+        }
+        lock.lock();
+
+        if (!m_rebuildPending) {
+            m_building.store(false, std::memory_order_release);
+        }
+    }
+}
@@ -0,0 +1,299 @@
+/*
+ * JobSystem.cpp
+ *
+ * Work-stealing scheduler and task graph execution.
+ */
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// Which system and queue the current thread works for (workers only)
+static thread_local const JobSystem* t_system = nullptr;
+static thread_local size_t t_queue = 0;
+
+// -------------------------
+// TaskGraph
+// -------------------------
+
+TaskGraph::TaskId TaskGraph::add(std::function<void()> task) {
+    Task& t = m_tasks.emplace_back();
+    t.run = std::move(task);
+    m_acyclic = -1;
+    return (TaskId)(m_tasks.size() - 1);
+}
+
+void TaskGraph::precede(TaskId before, TaskId after) {
+    if (before >= m_tasks.size() || after >= m_tasks.size() || before == after) {
+        std::fprintf(stderr, "TaskGraph: Invalid dependency %u -> %u\n", before, after);
+        return;
+    }
+    m_tasks[before].successors.push_back(after);
+    m_tasks[after].dependencies++;
+    m_acyclic = -1;
+}
+
+void TaskGraph::clear() {
+    m_tasks.clear();
+    m_acyclic = -1;
+}
+
+bool TaskGraph::isAcyclic() {
+    if (m_acyclic >= 0) return m_acyclic != 0;
+
+    // Kahn's algorithm: a cycle leaves tasks that never become ready
+    const size_t count = m_tasks.size();
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> incoming(count);
+    order.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        incoming[i] = m_tasks[i].dependencies;
+        if (incoming[i] == 0) order.push_back((uint32_t)i);
+    }
+    for (size_t i = 0; i < order.size(); ++i) {
+        for (TaskId next : m_tasks[order[i]].successors) {
+            if (--incoming[next] == 0) order.push_back(next);
+        }
+    }
+
+    m_acyclic = (order.size() == count) ? 1 : 0;
+    return m_acyclic != 0;
+}
+
+// -------------------------
+// JobSystem
+// -------------------------
+
+// Per-run() state, alive on the caller's stack until every task finished
+struct JobSystem::GraphRun {
+    JobSystem* system;
+    TaskGraph* graph;
+    std::atomic<uint32_t> remaining{0};
+};
+
+// Per-parallelFor() state
+struct JobSystem::ForRun {
+    ForBody body;
+    void* context;
+    size_t count;
+    size_t grain;
+    std::atomic<uint32_t> remaining{0};
+};
+
+JobSystem::JobSystem(size_t workerCount) {
+    if (workerCount == 0) {
+        const unsigned hw = std::thread::hardware_concurrency();
+        workerCount = (hw > 1) ? hw - 1 : 0;
+    }
+
+    for (size_t i = 0; i < workerCount + 1; ++i) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+
+    m_workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+bool JobSystem::run(TaskGraph& graph) {
+    const size_t count = graph.m_tasks.size();
+    if (count == 0) return true;
+
+    // A cycle would never finish
+    if (!graph.isAcyclic()) {
+        std::fprintf(stderr, "JobSystem: Task graph has a cycle, not running it\n");
+        return false;
+    }
+
+    if (graph.m_pendingSize < count) {
+        graph.m_pending = std::make_unique<std::atomic<uint32_t>[]>(count);
+        graph.m_pendingSize = count;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        graph.m_pending[i].store(graph.m_tasks[i].dependencies, std::memory_order_relaxed);
+    }
+
+    GraphRun state;
+    state.system = this;
+    state.graph = &graph;
+    state.remaining.store((uint32_t)count, std::memory_order_relaxed);
+
+    // Roots are ready now; the rest are queued by their last dependency
+    for (size_t i = 0; i < count; ++i) {
+        if (graph.m_tasks[i].dependencies == 0) {
+            push({ &JobSystem::runTask, &state, (uint32_t)i });
+        }
+    }
+
+    helpUntilDone(state.remaining);
+    return true;
+}
+
+void JobSystem::runTask(void* context, uint32_t index) {
+    GraphRun* state = static_cast<GraphRun*>(context);
+    const TaskGraph::Task& task = state->graph->m_tasks[index];
+
+    if (task.run) task.run();
+
+    for (TaskGraph::TaskId next : task.successors) {
+        if (state->graph->m_pending[next].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            state->system->push({ &JobSystem::runTask, state, next });
+        }
+    }
+
+    // Last touch of the state: the caller may return as soon as this hits 0
+    state->remaining.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, ForBody body, void* context) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || m_workers.empty()) {
+        body(context, 0, count);
+        return;
+    }
+
+    ForRun state;
+    state.body = body;
+    state.context = context;
+    state.count = count;
+    state.grain = grain;
+    state.remaining.store((uint32_t)chunks, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < chunks; ++i) {
+        push({ &JobSystem::runChunk, &state, (uint32_t)i });
+    }
+
+    helpUntilDone(state.remaining);
+}
+
+void JobSystem::runChunk(void* context, uint32_t index) {
+    ForRun* state = static_cast<ForRun*>(context);
+    const size_t begin = (size_t)index * state->grain;
+    const size_t end = std::min(begin + state->grain, state->count);
+
+    state->body(state->context, begin, end);
+
+    state->remaining.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::Queue::pushBack(const Job& job) {
+    if (count == jobs.size()) {
+        // Full: unwrap into a buffer twice the size
+        std::vector<Job> grown(jobs.size() * 2);
+        for (size_t i = 0; i < count; ++i) {
+            grown[i] = jobs[(head + i) % jobs.size()];
+        }
+        jobs.swap(grown);
+        head = 0;
+    }
+    jobs[(head + count) % jobs.size()] = job;
+    count++;
+}
+
+JobSystem::Job JobSystem::Queue::popBack() {
+    count--;
+    return jobs[(head + count) % jobs.size()];
+}
+
+JobSystem::Job JobSystem::Queue::popFront() {
+    const Job job = jobs[head];
+    head = (head + 1) % jobs.size();
+    count--;
+    return job;
+}
+
+size_t JobSystem::currentQueue() const {
+    // Threads outside the pool share the last queue
+    return (t_system == this) ? t_queue : m_workers.size();
+}
+
+void JobSystem::push(const Job& job) {
+    Queue& queue = *m_queues[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.pushBack(job);
+    }
+    m_queued.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders this with a worker about to sleep
+    { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+    m_wake.notify_one();
+}
+
+bool JobSystem::pop(Job& job) {
+    const size_t own = currentQueue();
+    const size_t queueCount = m_queues.size();
+
+    // Own queue newest-first (its data is likely still in cache)...
+    {
+        Queue& queue = *m_queues[own];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.count > 0) {
+            job = queue.popBack();
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // ...then steal the oldest job from the others
+    for (size_t i = 1; i < queueCount; ++i) {
+        Queue& queue = *m_queues[(own + i) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.count > 0) {
+            job = queue.popFront();
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::helpUntilDone(const std::atomic<uint32_t>& remaining) {
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        Job job;
+        if (pop(job)) {
+            job.execute(job.context, job.index);
+        } else {
+            // The last jobs are running elsewhere
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::workerLoop(size_t index) {
+    t_system = this;
+    t_queue = index;
+
+    for (;;) {
+        Job job;
+        if (pop(job)) {
+            job.execute(job.context, job.index);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this] {
+            return m_stopping || m_queued.load(std::memory_order_acquire) > 0;
+        });
+
+        // Jobs only exist while someone waits on them, so none are left here
+        if (m_stopping && m_queued.load(std::memory_order_acquire) == 0) return;
+    }
+}
@@ -0,0 +1,156 @@
+/*
+ * LayerCache.cpp
+ *
+ * Cached layer render targets.
+ */
+
+#include "LayerCache.h"
+
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+LayerCache::~LayerCache() {
+    shutdown();
+}
+
+bool LayerCache::init(uint16_t width, uint16_t height, bgfx::ViewId firstView, uint16_t layers) {
+    shutdown();
+
+    m_width = width;
+    m_height = height;
+    m_firstView = firstView;
+
+    // Render targets sample with the same point/clamp filtering as sprites
+    const uint64_t flags =
+        BGFX_TEXTURE_RT |
+        BGFX_SAMPLER_MIN_POINT |
+        BGFX_SAMPLER_MAG_POINT |
+        BGFX_SAMPLER_MIP_POINT |
+        BGFX_SAMPLER_U_CLAMP |
+        BGFX_SAMPLER_V_CLAMP;
+
+    // Render target rows start at the bottom on OpenGL; flip V when sampling
+    const bool flipV = bgfx::getCaps()->originBottomLeft;
+
+    m_layers.resize(layers);
+    for (Layer& layer : m_layers) {
+        bgfx::TextureHandle texture = bgfx::createTexture2D(width, height, false, 1,
+                                                            bgfx::TextureFormat::BGRA8, flags);
+        layer.framebuffer = bgfx::createFrameBuffer(1, &texture, true);
+        if (!bgfx::isValid(layer.framebuffer)) {
+            std::fprintf(stderr, "LayerCache: Failed to create layer framebuffer\n");
+            if (bgfx::isValid(texture)) bgfx::destroy(texture);
+            shutdown();
+            return false;
+        }
+
+        layer.texture.texture = texture;
+        layer.texture.width = width;
+        layer.texture.height = height;
+        if (flipV) {
+            layer.texture.v0 = 1.0f;
+            layer.texture.v1 = 0.0f;
+        }
+    }
+
+    std::printf("LayerCache: Initialized (%u layers of %ux%u)\n",
+                (unsigned)layers, (unsigned)width, (unsigned)height);
+    return true;
+}
+
+void LayerCache::shutdown() {
+    // The framebuffers own their textures
+    for (Layer& layer : m_layers) {
+        if (bgfx::isValid(layer.framebuffer)) {
+            bgfx::destroy(layer.framebuffer);
+        }
+    }
+    m_layers.clear();
+}
+
+int LayerCache::acquire(DrawFunc draw, float refreshSeconds) {
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        Layer& layer = m_layers[i];
+        if (layer.inUse) continue;
+
+        layer.draw = std::move(draw);
+        layer.refreshSeconds = (refreshSeconds > 0.0f) ? refreshSeconds : 0.0f;
+        layer.refreshTimer = 0.0f;
+        layer.inUse = true;
+        layer.dirty = true;
+        return (int)i;
+    }
+    return -1;
+}
+
+void LayerCache::release(int layer) {
+    if (!isValid(layer)) return;
+
+    Layer& l = m_layers[(size_t)layer];
+    l.draw = nullptr; // Drops whatever the callback captured
+    l.inUse = false;
+    l.dirty = false;
+}
+
+void LayerCache::invalidate(int layer) {
+    if (isValid(layer)) {
+        m_layers[(size_t)layer].dirty = true;
+    }
+}
+
+void LayerCache::invalidateAll() {
+    for (Layer& layer : m_layers) {
+        if (layer.inUse) layer.dirty = true;
+    }
+}
+
+void LayerCache::render(SpriteBatch& batch, float dt) {
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        Layer& layer = m_layers[i];
+        if (!layer.inUse) continue;
+
+        // Low-frequency layers redraw on their own timer
+        if (layer.refreshSeconds > 0.0f) {
+            layer.refreshTimer += dt;
+            if (layer.refreshTimer >= layer.refreshSeconds) {
+                layer.refreshTimer = std::fmod(layer.refreshTimer, layer.refreshSeconds);
+                layer.dirty = true;
+            }
+        }
+        if (!layer.dirty) continue;
+
+        // Clear to transparent so the layer composites over what's beneath it
+        const bgfx::ViewId view = (bgfx::ViewId)(m_firstView + i);
+        bgfx::setViewFrameBuffer(view, layer.framebuffer);
+        bgfx::setViewRect(view, 0, 0, m_width, m_height);
+        bgfx::setViewClear(view, BGFX_CLEAR_COLOR, 0x00000000, 1.0f, 0);
+        bgfx::touch(view);
+
+        batch.begin(view, m_width, m_height);
+        if (layer.draw) layer.draw(batch);
+        batch.end();
+
+        layer.dirty = false;
+        m_redraws++;
+    }
+}
+
+void LayerCache::draw(SpriteBatch& batch, int layer, Color tint) const {
+    if (!isValid(layer)) return;
+    batch.draw(m_layers[(size_t)layer].texture, 0.0f, 0.0f, tint);
+}
+
+void LayerCache::draw(SpriteBatch& batch, int layer, const Rect& region, Color tint) const {
+    if (!isValid(layer)) return;
+    batch.drawRegion(m_layers[(size_t)layer].texture, region.x, region.y, region, tint);
+}
+
+bool LayerCache::isValid(int layer) const {
+    return layer >= 0 && (size_t)layer < m_layers.size() && m_layers[(size_t)layer].inUse;
+}
+
+TextureHandle LayerCache::texture(int layer) const {
+    if (!isValid(layer)) return TextureHandle{};
+    return m_layers[(size_t)layer].texture;
+}
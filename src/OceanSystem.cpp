@@ -5,28 +5,27 @@
  */
 
 #include "OceanSystem.h"
+#include "Profiler.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
 
 void OceanSystem::init(TextureManager& textures) {
     m_textures = &textures;
-    m_swells.clear();
+    m_swells.clearEmitters();
+    m_swells.init(MAX_SWELLS);
+    m_swells.setSortByDepth(true);
     m_swellTypes.clear();
     m_totalSpawnWeight = 0;
     
-    // Create base water gradient texture
-    m_baseTex = textures.createSolidColor("ocean_base", 
-        m_baseColorTop.r, m_baseColorTop.g, m_baseColorTop.b);
-    
     // Add default swell types - these use procedural textures as fallback
     // User can call clearSwellTypes() and addSwellType() to customize
     
-    // Try to load custom sprites, fall back to procedural
-    TextureHandle smallTex = textures.load("assets/swell_small.png");
-    TextureHandle mediumTex = textures.load("assets/swell_med.png");
-    TextureHandle largeTex = textures.load("assets/swell_large.png");
-    TextureHandle crestTex = textures.load("assets/wave_crest.png");
+    // Try to load custom sprites (decoded in the background), fall back to procedural
+    TextureHandle smallTex = textures.loadAsync("assets/swell_small.png");
+    TextureHandle mediumTex = textures.loadAsync("assets/swell_med.png");
+    TextureHandle largeTex = textures.loadAsync("assets/swell_large.png");
+    TextureHandle crestTex = textures.loadAsync("assets/wave_crest.png");
     
     // Small swells
     if (smallTex.isValid()) {
@@ -101,25 +100,32 @@ void OceanSystem::init(TextureManager& textures) {
         std::printf("OceanSystem: No swell sprites found, using procedural\n");
         
         // Procedural small wave
-        textures.createTestSpriteSheet("proc_swell_small", 64, 24, 4,
-            [](int frame, int x, int y) -> uint32_t {
-                float cx = 32, cy = 16;
+        // Whole frames at a time: the wave height only depends on x
+        textures.createSpriteSheetFrames("proc_swell_small", 64, 24, 4, 1,
+            [](int frame, uint32_t* pixels, size_t stride) {
+                float cy = 16;
                 float phase = frame * 0.25f * 3.14159f * 2;
                 
-                // Wave shape
-                float waveY = cy + std::sin((x / 64.0f + phase) * 3.14159f) * 8.0f;
-                float dist = std::abs(y - waveY);
-                
-                if (dist < 6) {
-                    float alpha = (1.0f - dist / 6.0f);
-                    uint8_t a = (uint8_t)(alpha * 180);
-                    // Blue-white gradient
-                    uint8_t r = (uint8_t)(100 + alpha * 100);
-                    uint8_t g = (uint8_t)(140 + alpha * 80);
-                    uint8_t b = (uint8_t)(180 + alpha * 60);
-                    return (a << 24) | (r << 16) | (g << 8) | b;
+                for (int x = 0; x < 64; ++x) {
+                    // Wave shape
+                    float waveY = cy + std::sin((x / 64.0f + phase) * 3.14159f) * 8.0f;
+                    
+                    for (int y = 0; y < 24; ++y) {
+                        float dist = std::abs(y - waveY);
+                        uint32_t color = 0x00000000;
+                        
+                        if (dist < 6) {
+                            float alpha = (1.0f - dist / 6.0f);
+                            uint8_t a = (uint8_t)(alpha * 180);
+                            // Blue-white gradient
+                            uint8_t r = (uint8_t)(100 + alpha * 100);
+                            uint8_t g = (uint8_t)(140 + alpha * 80);
+                            uint8_t b = (uint8_t)(180 + alpha * 60);
+                            color = (a << 24) | (r << 16) | (g << 8) | b;
+                        }
+                        pixels[y * stride + x] = color;
+                    }
                 }
-                return 0x00000000;
             }
         );
         
@@ -135,23 +141,29 @@ void OceanSystem::init(TextureManager& textures) {
         addSwellType(procSmall);
         
         // Procedural medium wave
-        textures.createTestSpriteSheet("proc_swell_medium", 128, 40, 4,
-            [](int frame, int x, int y) -> uint32_t {
-                float cx = 64, cy = 24;
+        textures.createSpriteSheetFrames("proc_swell_medium", 128, 40, 4, 1,
+            [](int frame, uint32_t* pixels, size_t stride) {
+                float cy = 24;
                 float phase = frame * 0.25f * 3.14159f * 2;
                 
-                float waveY = cy + std::sin((x / 128.0f + phase) * 3.14159f) * 14.0f;
-                float dist = std::abs(y - waveY);
-                
-                if (dist < 10) {
-                    float alpha = (1.0f - dist / 10.0f);
-                    uint8_t a = (uint8_t)(alpha * 200);
-                    uint8_t r = (uint8_t)(80 + alpha * 80);
-                    uint8_t g = (uint8_t)(120 + alpha * 80);
-                    uint8_t b = (uint8_t)(170 + alpha * 60);
-                    return (a << 24) | (r << 16) | (g << 8) | b;
+                for (int x = 0; x < 128; ++x) {
+                    float waveY = cy + std::sin((x / 128.0f + phase) * 3.14159f) * 14.0f;
+                    
+                    for (int y = 0; y < 40; ++y) {
+                        float dist = std::abs(y - waveY);
+                        uint32_t color = 0x00000000;
+                        
+                        if (dist < 10) {
+                            float alpha = (1.0f - dist / 10.0f);
+                            uint8_t a = (uint8_t)(alpha * 200);
+                            uint8_t r = (uint8_t)(80 + alpha * 80);
+                            uint8_t g = (uint8_t)(120 + alpha * 80);
+                            uint8_t b = (uint8_t)(170 + alpha * 60);
+                            color = (a << 24) | (r << 16) | (g << 8) | b;
+                        }
+                        pixels[y * stride + x] = color;
+                    }
                 }
-                return 0x00000000;
             }
         );
         
@@ -167,18 +179,26 @@ void OceanSystem::init(TextureManager& textures) {
         addSwellType(procMedium);
         
         // Procedural foam crest
-        textures.createTestSpriteSheet("proc_crest", 48, 16, 3,
-            [](int frame, int x, int y) -> uint32_t {
+        textures.createSpriteSheetFrames("proc_crest", 48, 16, 3, 1,
+            [](int frame, uint32_t* pixels, size_t stride) {
                 float phase = frame * 0.33f;
-                float foamLine = 8 + std::sin((x * 0.2f + phase * 6.28f)) * 3;
-                float dist = std::abs(y - foamLine);
                 
-                if (dist < 5) {
-                    float alpha = (1.0f - dist / 5.0f) * (0.7f + std::sin(x * 0.5f) * 0.3f);
-                    uint8_t a = (uint8_t)(alpha * 220);
-                    return (a << 24) | 0xF0F8FF;  // White foam
+                for (int x = 0; x < 48; ++x) {
+                    float foamLine = 8 + std::sin((x * 0.2f + phase * 6.28f)) * 3;
+                    float density = 0.7f + std::sin(x * 0.5f) * 0.3f;
+                    
+                    for (int y = 0; y < 16; ++y) {
+                        float dist = std::abs(y - foamLine);
+                        uint32_t color = 0x00000000;
+                        
+                        if (dist < 5) {
+                            float alpha = (1.0f - dist / 5.0f) * density;
+                            uint8_t a = (uint8_t)(alpha * 220);
+                            color = (a << 24) | 0xF0F8FF;  // White foam
+                        }
+                        pixels[y * stride + x] = color;
+                    }
                 }
-                return 0x00000000;
             }
         );
         
@@ -202,32 +222,31 @@ void OceanSystem::setRegion(float x, float y, float width, float height) {
     m_regionY = y;
     m_regionW = width;
     m_regionH = height;
+    
+    // Swells die once they leave the region
+    for (size_t i = 0; i < m_swells.emitterCount(); ++i) {
+        m_swells.emitter((uint16_t)i).bounds = Rect(x, y, width, height);
+    }
 }
 
 void OceanSystem::setBaseColor(Color topColor, Color bottomColor) {
     m_baseColorTop = topColor;
     m_baseColorBottom = bottomColor;
-    
-    if (m_textures) {
-        m_baseTex = m_textures->createSolidColor("ocean_base_updated",
-            topColor.r, topColor.g, topColor.b);
-    }
 }
 
 void OceanSystem::addSwellType(const SwellType& type) {
-    LoadedSwellType loaded;
-    loaded.config = type;
+    ParticleEmitter emitter;
     
     // Load or get texture
     if (m_textures) {
-        loaded.texture = m_textures->get(type.texturePath);
-        if (!loaded.texture.isValid()) {
-            loaded.texture = m_textures->load(type.texturePath);
+        emitter.texture = m_textures->get(type.texturePath);
+        if (!emitter.texture.isValid()) {
+            emitter.texture = m_textures->load(type.texturePath);
         }
     }
     
     // Create animation
-    loaded.animation = Animation::fromGrid(
+    emitter.animation = Animation::fromGrid(
         0, 0,
         type.frameWidth, type.frameHeight,
         type.frameCount,
@@ -235,28 +254,31 @@ void OceanSystem::addSwellType(const SwellType& type) {
         true  // loop
     );
     
-    m_swellTypes.push_back(loaded);
+    // Swells live until they scroll out of the region; spawnSwell() picks the rest
+    emitter.width = type.frameWidth;
+    emitter.height = type.frameHeight;
+    emitter.boundsMode = ParticleBounds::Kill;
+    emitter.bounds = Rect(m_regionX, m_regionY, m_regionW, m_regionH);
+    
+    m_swells.addEmitter(emitter);
+    m_swellTypes.push_back(type);
     m_totalSpawnWeight += type.spawnWeight;
 }
 
+void OceanSystem::clearSwellTypes() {
+    m_swells.clearEmitters();
+    m_swellTypes.clear();
+    m_totalSpawnWeight = 0;
+}
+
 void OceanSystem::update(float dt) {
-    if (m_swellTypes.empty()) return;
+    PROFILE_SCOPE(OceanUpdate);
     
-    // Update existing swells
-    for (auto& swell : m_swells) {
-        swell.sprite.update(dt);
-        swell.x -= swell.speed * m_speedMultiplier * dt;
-    }
+    if (m_swellTypes.empty()) return;
+    m_lastDt = dt;
     
-    // Remove swells that have scrolled off screen
-    m_swells.erase(
-        std::remove_if(m_swells.begin(), m_swells.end(),
-            [this](const ActiveSwell& s) {
-                auto& type = m_swellTypes[s.typeIndex].config;
-                return s.x < m_regionX - type.frameWidth * s.scale;
-            }),
-        m_swells.end()
-    );
+    // Move and animate existing swells, removing those that left the region
+    m_swells.update(dt, m_speedMultiplier);
     
     // Spawn new swells
     m_spawnTimer += dt;
@@ -277,79 +299,64 @@ void OceanSystem::spawnSwell() {
     float cumulative = 0;
     
     for (size_t i = 0; i < m_swellTypes.size(); ++i) {
-        cumulative += m_swellTypes[i].config.spawnWeight;
+        cumulative += m_swellTypes[i].spawnWeight;
         if (roll <= cumulative) {
             typeIndex = (int)i;
             break;
         }
     }
     
-    auto& type = m_swellTypes[typeIndex];
-    auto& config = type.config;
-    
-    ActiveSwell swell;
-    swell.typeIndex = typeIndex;
-    swell.sprite = AnimatedSprite(type.texture, type.animation);
+    const SwellType& config = m_swellTypes[typeIndex];
     
     // Random starting frame for variety
-    swell.sprite.setFrame(randomInt(0, config.frameCount - 1));
+    const int frame = randomInt(0, config.frameCount - 1);
     
     // Position: spawn just off right edge
-    swell.x = 0 - config.frameWidth;
+    const float x = 0 - config.frameWidth;
     
     // Depth determines Y position
-    swell.depth = randomFloat(config.depthMin, config.depthMax);
-    swell.y = m_regionY + swell.depth * (m_regionH - config.frameHeight);
+    const float depth = randomFloat(config.depthMin, config.depthMax);
+    const float y = m_regionY + depth * (m_regionH - config.frameHeight);
     
     // Random speed and scale within range
-    swell.speed = randomFloat(config.minSpeed, config.maxSpeed);
-    swell.scale = randomFloat(config.minScale, config.maxScale);
+    const float speed = randomFloat(config.minSpeed, config.maxSpeed);
+    const float scale = randomFloat(config.minScale, config.maxScale);
     
     // Optional tint variation
+    Color tint = Color::white();
     if (config.varyTint && config.tintVariation > 0) {
         int variation = config.tintVariation;
-        swell.tint = Color(
+        tint = Color(
             (uint8_t)(255 - randomInt(0, variation)),
             (uint8_t)(255 - randomInt(0, variation)),
             (uint8_t)(255 - randomInt(0, variation / 2)),  // Less blue variation
             255
         );
-    } else {
-        swell.tint = Color::white();
     }
     
-    m_swells.push_back(swell);
+    // The pool keeps swells in depth order for drawing
+    ParticleSpawn swell;
+    swell.x = x;
+    swell.y = y;
+    swell.vx = -speed;
+    swell.scale = scale;
+    swell.depth = depth;
+    swell.animTime = frame * config.frameDuration;
+    swell.color = tint;
+    m_swells.spawn((uint16_t)typeIndex, swell);
 }
 
-void OceanSystem::render(SpriteBatch& batch) {
-    // Draw base water gradient
-    // Simple: draw strips from top to bottom with interpolated color
-    int strips = 50;
-    float stripH = m_regionH / strips;
+void OceanSystem::render(SpriteBatch& batch, float alpha, JobSystem* jobs) {
+    // Draw base water gradient (opaque: swells cover most of it)
+    const SpriteBatch::BlendMode batchBlend = batch.getBlendMode();
+    batch.setBlendMode(SpriteBatch::BlendMode::Opaque);
+    batch.drawGradientRect(m_regionX, m_regionY, m_regionW, m_regionH,
+                           m_baseColorTop, m_baseColorBottom, m_baseBands);
+    batch.setBlendMode(batchBlend);
     
-    for (int i = 0; i < strips; ++i) {
-        float t = (float)i / (strips - 1);
-        Color c(
-            (uint8_t)(m_baseColorTop.r + t * (m_baseColorBottom.r - m_baseColorTop.r)),
-            (uint8_t)(m_baseColorTop.g + t * (m_baseColorBottom.g - m_baseColorTop.g)),
-            (uint8_t)(m_baseColorTop.b + t * (m_baseColorBottom.b - m_baseColorTop.b))
-        );
-        batch.draw(m_baseTex, m_regionX, m_regionY + i * stripH, m_regionW, stripH + 1, c);
-    }
-    
-    // Sort swells by depth (back to front)
-    std::sort(m_swells.begin(), m_swells.end(),
-        [](const ActiveSwell& a, const ActiveSwell& b) {
-            return a.depth < b.depth;
-        });
-    
-    // Draw swells
-    for (auto& swell : m_swells) {
-        auto& config = m_swellTypes[swell.typeIndex].config;
-        float w = config.frameWidth * swell.scale;
-        float h = config.frameHeight * swell.scale;
-        swell.sprite.draw(batch, swell.x, swell.y, w, h, swell.tint);
-    }
+    // Swells move linearly, so stepping back along their velocity
+    // interpolates between the previous and current update
+    m_swells.render(batch, (1.0f - alpha) * m_lastDt, jobs);
 }
 
 float OceanSystem::randomFloat(float min, float max) {
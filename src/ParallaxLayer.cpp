@@ -6,6 +6,7 @@
 
 #include "ParallaxLayer.h"
 #include "SpriteBatch.h"
+#include "JobSystem.h"
 #include <cmath>
 
 void ParallaxLayer::setTexture(const TextureHandle& texture, float tileWidth, float tileHeight) {
@@ -76,9 +77,71 @@ void ParallaxLayer::update(float dt) {
   }
 }
 
+void ParallaxLayer::tileOrigin(float x, float y, float& startX, float& startY) const {
+  // Calculate starting position with scroll offset
+  startX = x - std::fmod(m_scrollX, m_tileWidth);
+  startY = y - std::fmod(m_scrollY, m_tileHeight) + m_bobOffset;
+
+  // Need to start one tile earlier to handle scroll
+  if (m_scrollX > 0) startX -= m_tileWidth;
+  if (m_scrollY > 0) startY -=  m_tileHeight;
+}
+
+uint32_t ParallaxLayer::maxTiles(float width, float height) const {
+  if (m_tileWidth <= 0 || m_tileHeight <= 0) return 0;
+
+  // Same bound as the tile grid: covers any scroll/bob offset
+  const float cols = std::ceil(width / m_tileWidth) + 3.0f;
+  const float rows = std::ceil((height + std::fabs(m_bobAmplitude)) / m_tileHeight) + 2.0f;
+  return (uint32_t)(cols * rows);
+}
+
 void ParallaxLayer::render(SpriteBatch& batch, float x, float y, float width, float height) {
   if (!m_texture.isValid() || m_tileWidth <= 0 || m_tileHeight <= 0) return;
 
+  // Cached grid: the batch keeps one static buffer per grid size and the
+  // vertex shader applies scroll, bob and wave, so this is one draw
+  if (batch.hasTileGrids()) {
+    float startX, startY;
+    tileOrigin(x, y, startX, startY);
+
+    // Enough tiles for any scroll/bob offset; the shader skips the extras
+    // exactly where the tile loop would stop
+    const float bobReach = std::fabs(m_bobAmplitude);
+    const float cols = std::ceil(width / m_tileWidth) + 3.0f;
+    const float rows = std::ceil((height + bobReach) / m_tileHeight) + 2.0f;
+
+    SpriteBatch::TileGridParams grid;
+    grid.x = startX;
+    grid.y = startY;
+    grid.tileWidth = m_tileWidth;
+    grid.tileHeight = m_tileHeight;
+    grid.limitX = x + width + m_tileWidth;
+    grid.limitY = y + height;
+    if (m_waveAmplitude > 0) {
+      grid.waveAmplitude = m_waveAmplitude;
+      grid.waveFrequency = m_waveFrequency / 100.0f;
+      grid.wavePhase = m_waveTime;
+    }
+
+    // Oversized grids are declined by the batch and take the per-tile path
+    const Rect srcRect(m_currentFrame * m_tileWidth, 0, m_tileWidth, m_tileHeight);
+    if (cols <= 65535.0f && rows <= 65535.0f &&
+        batch.drawTileGrid(m_texture, (uint16_t)cols, (uint16_t)rows, grid, srcRect, m_tint)) {
+      return;
+    }
+  }
+
+  renderTiles(batch, x, y, width, height);
+}
+
+void ParallaxLayer::render(SpriteBatch::Recorder& recorder, float x, float y, float width, float height) {
+  if (!m_texture.isValid() || m_tileWidth <= 0 || m_tileHeight <= 0) return;
+  renderTiles(recorder, x, y, width, height);
+}
+
+template<typename Target>
+void ParallaxLayer::renderTiles(Target& target, float x, float y, float width, float height) const {
   // Calculate the source rect for current animation frame
   Rect srcRect(
       m_currentFrame * m_tileWidth,
@@ -87,13 +150,8 @@ void ParallaxLayer::render(SpriteBatch& batch, float x, float y, float width, fl
       m_tileHeight
       );
 
-  // Calculate starting position with scroll offset
-  float startX = x - std::fmod(m_scrollX, m_tileWidth);
-  float startY = y - std::fmod(m_scrollY, m_tileHeight) + m_bobOffset;
-
-  // Need to start one tile earlier to handle scroll
-  if (m_scrollX > 0) startX -= m_tileWidth;
-  if (m_scrollY > 0) startY -=  m_tileHeight;
+  float startX, startY;
+  tileOrigin(x, y, startX, startY);
 
   // Tile across the region
   for (float ty = startY; ty < y + height; ty += m_tileHeight) {
@@ -107,7 +165,7 @@ void ParallaxLayer::render(SpriteBatch& batch, float x, float y, float width, fl
         drawX += waveOffset;
       }
 
-      batch.drawRegion(m_texture, drawX, drawY, m_tileWidth, m_tileHeight, srcRect, m_tint);
+      target.drawRegion(m_texture, drawX, drawY, m_tileWidth, m_tileHeight, srcRect, m_tint);
     }
   }
 }
@@ -120,16 +178,51 @@ void ParallaxBackground::addLayer(ParallaxLayer layer) {
   m_layers.push_back(std::move(layer));
 }
 
-void ParallaxBackground::update(float dt) {
-  for (auto& layer : m_layers) {
-    layer.update(dt);
+void ParallaxBackground::update(float dt, JobSystem* jobs) {
+  // Layers are independent; a few per job keeps the overhead down
+  static constexpr size_t LAYERS_PER_JOB = 4;
+
+  if (!jobs || m_layers.size() <= LAYERS_PER_JOB) {
+    for (auto& layer : m_layers) {
+      layer.update(dt);
+    }
+    return;
   }
+
+  jobs->parallelFor(m_layers.size(), LAYERS_PER_JOB, [this, dt](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      m_layers[i].update(dt);
+    }
+  });
 }
 
-void ParallaxBackground::render(SpriteBatch& batch, float x, float y, float width, float height) {
-  // Render back to front
-  for (auto& layer : m_layers) {
-    layer.render(batch, x, y, width, height);
+void ParallaxBackground::render(SpriteBatch& batch, float x, float y, float width, float height,
+                                JobSystem* jobs) {
+  const bool record = jobs && jobs->workerCount() > 0 && m_layers.size() > 1 &&
+                      batch.supportsRecorders() && !batch.hasTileGrids();
+  if (!record) {
+    // Render back to front
+    for (auto& layer : m_layers) {
+      layer.render(batch, x, y, width, height);
+    }
+    return;
+  }
+
+  // Each layer records on its own; the reserved positions keep them back to front
+  m_recorders.resize(m_layers.size());
+  const uint32_t order = batch.reserveRecorders((uint32_t)m_layers.size());
+  jobs->parallelFor(m_layers.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      SpriteBatch::Recorder& recorder = m_recorders[i];
+      if (recorder.begin(batch, order + (uint32_t)i, m_layers[i].maxTiles(width, height))) {
+        m_layers[i].render(recorder, x, y, width, height);
+      }
+      recorder.end();
+    }
+  });
+
+  for (auto& recorder : m_recorders) {
+    batch.merge(recorder);
   }
 }
 
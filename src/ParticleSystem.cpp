@@ -0,0 +1,367 @@
+/*
+ * ParticleSystem.cpp
+ *
+ * Pooled particle integration, culling and drawing.
+ */
+
+#include "ParticleSystem.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PARTICLE_SIMD_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PARTICLE_SIMD_NEON 1
+#endif
+
+void ParticleSystem::init(size_t capacity) {
+    m_capacity = capacity;
+    m_count = 0;
+    m_dropped = 0;
+    m_nextSerial = 0;
+
+    m_x.resize(capacity); m_y.resize(capacity);
+    m_vx.resize(capacity); m_vy.resize(capacity);
+    m_ax.resize(capacity); m_ay.resize(capacity);
+    m_age.resize(capacity);
+    m_lifetime.resize(capacity);
+    m_animOffset.resize(capacity);
+    m_scale.resize(capacity);
+    m_depth.resize(capacity);
+    m_color.resize(capacity);
+    m_emitter.resize(capacity);
+    m_serial.resize(capacity);
+    m_order.resize(capacity);
+    m_orderPos.resize(capacity);
+}
+
+uint16_t ParticleSystem::addEmitter(const ParticleEmitter& emitter) {
+    m_emitters.push_back(emitter);
+    m_emitTimers.push_back(0.0f);
+    return (uint16_t)(m_emitters.size() - 1);
+}
+
+void ParticleSystem::clearEmitters() {
+    clear();
+    m_emitters.clear();
+    m_emitTimers.clear();
+}
+
+void ParticleSystem::clear() {
+    m_count = 0;
+    std::fill(m_emitTimers.begin(), m_emitTimers.end(), 0.0f);
+}
+
+size_t ParticleSystem::emit(uint16_t emitter, size_t count) {
+    if (emitter >= m_emitters.size()) return 0;
+    const ParticleEmitter& e = m_emitters[emitter];
+
+    size_t spawned = 0;
+    for (size_t i = 0; i < count; ++i) {
+        ParticleSpawn p;
+        p.x = e.spawnX + randomFloat(0.0f, e.spawnW);
+        p.y = e.spawnY + randomFloat(0.0f, e.spawnH);
+        p.vx = randomFloat(e.velocityXMin, e.velocityXMax);
+        p.vy = randomFloat(e.velocityYMin, e.velocityYMax);
+        p.lifetime = randomFloat(e.lifetimeMin, e.lifetimeMax);
+        p.scale = randomFloat(e.scaleMin, e.scaleMax);
+        p.depth = randomFloat(e.depthMin, e.depthMax);
+        p.color = e.color;
+        if (e.randomStartFrame && !e.animation.empty()) {
+            const int frame = (int)randomFloat(0.0f, (float)e.animation.frameCount() - 0.001f);
+            p.animTime = frame * e.animation.frameDuration;
+        }
+
+        if (!spawn(emitter, p)) break;
+        spawned++;
+    }
+    return spawned;
+}
+
+bool ParticleSystem::spawn(uint16_t emitter, const ParticleSpawn& particle) {
+    if (emitter >= m_emitters.size()) return false;
+    if (m_count >= m_capacity) {
+        m_dropped++;
+        return false;
+    }
+
+    const ParticleEmitter& e = m_emitters[emitter];
+
+    const size_t i = m_count++;
+    m_x[i] = particle.x;
+    m_y[i] = particle.y;
+    m_vx[i] = particle.vx;
+    m_vy[i] = particle.vy;
+    m_ax[i] = e.gravityX;
+    m_ay[i] = e.gravityY;
+    m_age[i] = 0.0f;
+    m_lifetime[i] = particle.lifetime;
+    m_animOffset[i] = particle.animTime;
+    m_scale[i] = particle.scale;
+    m_depth[i] = particle.depth;
+    m_color[i] = particle.color;
+    m_emitter[i] = emitter;
+    m_serial[i] = m_nextSerial++;
+
+    if (m_sortByDepth) insertOrder(i);
+    return true;
+}
+
+void ParticleSystem::update(float dt, float motionScale) {
+    m_motionScale = motionScale;
+    integrate(dt, motionScale);
+    cull();
+
+    // Continuous emission, after culling so fresh particles have a free slot
+    for (size_t i = 0; i < m_emitters.size(); ++i) {
+        const float rate = m_emitters[i].rate;
+        if (rate <= 0.0f) continue;
+
+        const float interval = 1.0f / rate;
+        m_emitTimers[i] += dt;
+        while (m_emitTimers[i] >= interval) {
+            m_emitTimers[i] -= interval;
+            emit((uint16_t)i);
+        }
+    }
+}
+
+void ParticleSystem::integrate(float dt, float motionScale) {
+    const size_t n = m_count;
+    float* __restrict x = m_x.data();
+    float* __restrict y = m_y.data();
+    float* __restrict vx = m_vx.data();
+    float* __restrict vy = m_vy.data();
+    const float* __restrict ax = m_ax.data();
+    const float* __restrict ay = m_ay.data();
+    float* __restrict age = m_age.data();
+    const float move = motionScale * dt;
+
+    // p += v * move; v += a * dt; age += dt (animation frames follow age)
+    size_t i = 0;
+#if defined(PARTICLE_SIMD_SSE2)
+    const __m128 vMove = _mm_set1_ps(move);
+    const __m128 vDt = _mm_set1_ps(dt);
+    for (; i + 4 <= n; i += 4) {
+        const __m128 velX = _mm_loadu_ps(vx + i);
+        const __m128 velY = _mm_loadu_ps(vy + i);
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(velX, vMove)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(velY, vMove)));
+        _mm_storeu_ps(vx + i, _mm_add_ps(velX, _mm_mul_ps(_mm_loadu_ps(ax + i), vDt)));
+        _mm_storeu_ps(vy + i, _mm_add_ps(velY, _mm_mul_ps(_mm_loadu_ps(ay + i), vDt)));
+        _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), vDt));
+    }
+#elif defined(PARTICLE_SIMD_NEON)
+    const float32x4_t vMove = vdupq_n_f32(move);
+    const float32x4_t vDt = vdupq_n_f32(dt);
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t velX = vld1q_f32(vx + i);
+        const float32x4_t velY = vld1q_f32(vy + i);
+        vst1q_f32(x + i, vmlaq_f32(vld1q_f32(x + i), velX, vMove));
+        vst1q_f32(y + i, vmlaq_f32(vld1q_f32(y + i), velY, vMove));
+        vst1q_f32(vx + i, vmlaq_f32(velX, vld1q_f32(ax + i), vDt));
+        vst1q_f32(vy + i, vmlaq_f32(velY, vld1q_f32(ay + i), vDt));
+        vst1q_f32(age + i, vaddq_f32(vld1q_f32(age + i), vDt));
+    }
+#endif
+    for (; i < n; ++i) {
+        x[i] += vx[i] * move;
+        y[i] += vy[i] * move;
+        vx[i] += ax[i] * dt;
+        vy[i] += ay[i] * dt;
+        age[i] += dt;
+    }
+}
+
+void ParticleSystem::cull() {
+    size_t i = 0;
+    while (i < m_count) {
+        bool dead = m_lifetime[i] > 0.0f && m_age[i] >= m_lifetime[i];
+
+        const ParticleEmitter& e = m_emitters[m_emitter[i]];
+        if (!dead && e.boundsMode == ParticleBounds::Kill) {
+            // Fully outside, at the largest size the particle reaches
+            const float size = m_scale[i] * std::max(e.sizeStart, e.sizeEnd);
+            const float w = e.width * size, h = e.height * size;
+            const float left = m_x[i] - w * e.originX;
+            const float top = m_y[i] - h * e.originY;
+            const Rect& b = e.bounds;
+            dead = (b.w > 0.0f && (left + w < b.x || left > b.x + b.w)) ||
+                   (b.h > 0.0f && (top + h < b.y || top > b.y + b.h));
+        } else if (e.boundsMode == ParticleBounds::Wrap) {
+            const Rect& b = e.bounds;
+            if (b.w > 0.0f) {
+                if (m_x[i] < b.x) m_x[i] += b.w;
+                else if (m_x[i] > b.x + b.w) m_x[i] -= b.w;
+            }
+            if (b.h > 0.0f) {
+                if (m_y[i] < b.y) m_y[i] += b.h;
+                else if (m_y[i] > b.y + b.h) m_y[i] -= b.h;
+            }
+        }
+
+        // The last particle moves into the hole and is checked next
+        if (dead) {
+            kill(i);
+        } else {
+            ++i;
+        }
+    }
+
+    if (m_sortByDepth && m_orderHoles) compactOrder();
+}
+
+void ParticleSystem::kill(size_t i) {
+    const size_t last = --m_count;
+    if (i != last) {
+        m_x[i] = m_x[last];
+        m_y[i] = m_y[last];
+        m_vx[i] = m_vx[last];
+        m_vy[i] = m_vy[last];
+        m_ax[i] = m_ax[last];
+        m_ay[i] = m_ay[last];
+        m_age[i] = m_age[last];
+        m_lifetime[i] = m_lifetime[last];
+        m_animOffset[i] = m_animOffset[last];
+        m_scale[i] = m_scale[last];
+        m_depth[i] = m_depth[last];
+        m_color[i] = m_color[last];
+        m_emitter[i] = m_emitter[last];
+        m_serial[i] = m_serial[last];
+    }
+
+    // The dead entry becomes a hole (closed by compactOrder()); the moved
+    // particle's entry follows it to its new slot
+    if (m_sortByDepth) {
+        m_order[m_orderPos[i]] = ORDER_HOLE;
+        if (i != last) {
+            m_orderPos[i] = m_orderPos[last];
+            m_order[m_orderPos[i]] = (uint32_t)i;
+        }
+        m_orderHoles = true;
+    }
+}
+
+void ParticleSystem::setSortByDepth(bool enabled) {
+    m_sortByDepth = enabled;
+    if (!enabled) return;
+
+    // One full sort for the particles already alive; spawns and kills
+    // keep the order from then on
+    for (size_t i = 0; i < m_count; ++i) {
+        m_order[i] = (uint32_t)i;
+    }
+    std::sort(m_order.begin(), m_order.begin() + (std::ptrdiff_t)m_count,
+              [this](uint32_t a, uint32_t b) { return drawsBefore(a, b); });
+    for (size_t k = 0; k < m_count; ++k) {
+        m_orderPos[m_order[k]] = (uint32_t)k;
+    }
+    m_orderHoles = false;
+}
+
+void ParticleSystem::insertOrder(size_t i) {
+    // Live entries are [0, m_count - 1); the new particle has the highest
+    // serial, so it lands after every particle of equal depth
+    uint32_t* order = m_order.data();
+    const size_t live = m_count - 1;
+    uint32_t* at = std::upper_bound(order, order + live, (uint32_t)i,
+                                    [this](uint32_t a, uint32_t b) { return drawsBefore(a, b); });
+    const size_t pos = (size_t)(at - order);
+
+    std::memmove(at + 1, at, (live - pos) * sizeof(uint32_t));
+    *at = (uint32_t)i;
+    for (size_t k = pos; k <= live; ++k) {
+        m_orderPos[order[k]] = (uint32_t)k;
+    }
+}
+
+void ParticleSystem::compactOrder() {
+    // Stable: survivors keep their relative (depth, spawn) order
+    size_t live = 0;
+    for (size_t k = 0; live < m_count; ++k) {
+        const uint32_t i = m_order[k];
+        if (i == ORDER_HOLE) continue;
+        m_order[live] = i;
+        m_orderPos[i] = (uint32_t)live;
+        live++;
+    }
+    m_orderHoles = false;
+}
+
+void ParticleSystem::render(SpriteBatch& batch, float lagSeconds, JobSystem* jobs) {
+    if (m_count == 0) return;
+
+    // Recorders take the batch's blend mode when they begin
+    const SpriteBatch::BlendMode batchBlend = batch.getBlendMode();
+    batch.setBlendMode(m_blendMode);
+
+    const float lag = lagSeconds * m_motionScale;
+    if (!jobs || jobs->workerCount() == 0 || m_count <= PARTICLES_PER_RECORDER ||
+        !batch.supportsRecorders()) {
+        drawRange(batch, 0, m_count, lag);
+        batch.setBlendMode(batchBlend);
+        return;
+    }
+
+    // Consecutive chunks take consecutive positions, so draw order holds
+    const size_t chunks = (m_count + PARTICLES_PER_RECORDER - 1) / PARTICLES_PER_RECORDER;
+    m_recorders.resize(chunks);
+    const uint32_t order = batch.reserveRecorders((uint32_t)chunks);
+    jobs->parallelFor(chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            SpriteBatch::Recorder& recorder = m_recorders[c];
+            if (recorder.begin(batch, order + (uint32_t)c, PARTICLES_PER_RECORDER)) {
+                const size_t first = c * PARTICLES_PER_RECORDER;
+                drawRange(recorder, first, std::min(first + PARTICLES_PER_RECORDER, m_count), lag);
+            }
+            recorder.end();
+        }
+    });
+
+    for (SpriteBatch::Recorder& recorder : m_recorders) {
+        batch.merge(recorder);
+    }
+    batch.setBlendMode(batchBlend);
+}
+
+template<typename Target>
+void ParticleSystem::drawRange(Target& target, size_t begin, size_t end, float lag) const {
+    for (size_t k = begin; k < end; ++k) {
+        const size_t i = m_sortByDepth ? m_order[k] : k;
+        const ParticleEmitter& e = m_emitters[m_emitter[i]];
+        if (!e.texture.isValid()) continue;
+
+        // Normalized age drives the size and alpha curves
+        const float t = (m_lifetime[i] > 0.0f) ? std::min(m_age[i] / m_lifetime[i], 1.0f) : 0.0f;
+        const float size = (e.sizeStart + (e.sizeEnd - e.sizeStart) * t) * m_scale[i];
+        const float w = e.width * size;
+        const float h = e.height * size;
+        const float x = m_x[i] - m_vx[i] * lag - w * e.originX;
+        const float y = m_y[i] - m_vy[i] * lag - h * e.originY;
+
+        Color color = m_color[i];
+        const float alpha = e.alphaStart + (e.alphaEnd - e.alphaStart) * t;
+        if (alpha != 1.0f) {
+            color.a = (uint8_t)(color.a * std::clamp(alpha, 0.0f, 1.0f));
+        }
+
+        if (e.animation.empty()) {
+            target.draw(e.texture, x, y, w, h, color);
+        } else {
+            // The emitter's clip is shared; the particle's age is its clock
+            const int frame = e.animation.frameAt(m_age[i] + m_animOffset[i]);
+            target.drawRegion(e.texture, x, y, w, h, e.animation.frames[frame], color);
+        }
+    }
+}
+
+float ParticleSystem::randomFloat(float min, float max) {
+    m_randomSeed = m_randomSeed * 1103515245 + 12345;
+    const float t = (float)(m_randomSeed % 10000) / 10000.0f;
+    return min + t * (max - min);
+}
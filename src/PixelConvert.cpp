@@ -0,0 +1,320 @@
+/*
+ * PixelConvert.cpp
+ *
+ * SIMD pixel conversion kernels with runtime dispatch.
+ */
+
+#include "PixelConvert.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXEL_CONVERT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define PIXEL_TARGET(isa)
+#else
+#define PIXEL_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__ARM_NEON)
+#define PIXEL_CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace PixelConvert {
+
+// -------------------------
+// Scalar
+// -------------------------
+
+void swapRedBlueScalar(uint8_t* pixels, size_t pixelCount) {
+    swapRedBlueScalar(pixels, pixels, pixelCount);
+}
+
+void swapRedBlueScalar(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+    // Reads each pixel fully before writing, so src == dst is fine
+    for (size_t i = 0; i < pixelCount; ++i) {
+        const uint8_t* s = src + i * 4;
+        uint8_t* d = dst + i * 4;
+        const uint8_t c0 = s[0], c1 = s[1], c2 = s[2], c3 = s[3];
+        d[0] = c2;
+        d[1] = c1;
+        d[2] = c0;
+        d[3] = c3;
+    }
+}
+
+// Exact round(x / 255) for x <= 255 * 255
+static inline uint8_t div255(uint32_t x) {
+    x += 128;
+    return (uint8_t)((x + (x >> 8)) >> 8);
+}
+
+void premultiplyAlphaScalar(uint8_t* pixels, size_t pixelCount) {
+    for (size_t i = 0; i < pixelCount; ++i) {
+        uint8_t* p = pixels + i * 4;
+        const uint32_t a = p[3];
+        p[0] = div255(p[0] * a);
+        p[1] = div255(p[1] * a);
+        p[2] = div255(p[2] * a);
+    }
+}
+
+void expandRGBToRGBAScalar(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount, uint8_t alpha) {
+    for (size_t i = 0; i < pixelCount; ++i) {
+        rgba[i * 4 + 0] = rgb[i * 3 + 0];
+        rgba[i * 4 + 1] = rgb[i * 3 + 1];
+        rgba[i * 4 + 2] = rgb[i * 3 + 2];
+        rgba[i * 4 + 3] = alpha;
+    }
+}
+
+// -------------------------
+// x86 (SSSE3 / AVX2)
+// -------------------------
+#if PIXEL_CONVERT_X86
+
+PIXEL_TARGET("ssse3")
+static void swapRedBlueSSSE3(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    size_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4) {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_shuffle_epi8(px, shuffle));
+    }
+    swapRedBlueScalar(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+PIXEL_TARGET("avx2")
+static void swapRedBlueAVX2(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+    // vpshufb works per 128-bit lane, so the pattern repeats
+    const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                             2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    size_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8) {
+        const __m256i px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(px, shuffle));
+    }
+    swapRedBlueSSSE3(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+PIXEL_TARGET("ssse3")
+static void premultiplyAlphaSSSE3(uint8_t* pixels, size_t pixelCount) {
+    const __m128i alphaShuffle = _mm_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15);
+    const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000u);
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i* p = reinterpret_cast<__m128i*>(pixels + i * 4);
+        const __m128i px = _mm_loadu_si128(p);
+        const __m128i a = _mm_shuffle_epi8(px, alphaShuffle);
+
+        // 16-bit products, then the same rounding as div255()
+        __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(px, zero), _mm_unpacklo_epi8(a, zero));
+        __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(px, zero), _mm_unpackhi_epi8(a, zero));
+        lo = _mm_add_epi16(lo, bias);
+        hi = _mm_add_epi16(hi, bias);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+        const __m128i rgb = _mm_andnot_si128(alphaMask, _mm_packus_epi16(lo, hi));
+        _mm_storeu_si128(p, _mm_or_si128(rgb, _mm_and_si128(px, alphaMask)));
+    }
+    premultiplyAlphaScalar(pixels + i * 4, pixelCount - i);
+}
+
+PIXEL_TARGET("avx2")
+static void premultiplyAlphaAVX2(uint8_t* pixels, size_t pixelCount) {
+    const __m256i alphaShuffle = _mm256_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15,
+                                                  3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15);
+    const __m256i alphaMask = _mm256_set1_epi32((int)0xFF000000u);
+    const __m256i bias = _mm256_set1_epi16(128);
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8) {
+        __m256i* p = reinterpret_cast<__m256i*>(pixels + i * 4);
+        const __m256i px = _mm256_loadu_si256(p);
+        const __m256i a = _mm256_shuffle_epi8(px, alphaShuffle);
+
+        // Unpack and pack both work per lane, so pixel order is preserved
+        __m256i lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(px, zero), _mm256_unpacklo_epi8(a, zero));
+        __m256i hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(px, zero), _mm256_unpackhi_epi8(a, zero));
+        lo = _mm256_add_epi16(lo, bias);
+        hi = _mm256_add_epi16(hi, bias);
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8);
+
+        const __m256i rgb = _mm256_andnot_si256(alphaMask, _mm256_packus_epi16(lo, hi));
+        _mm256_storeu_si256(p, _mm256_or_si256(rgb, _mm256_and_si256(px, alphaMask)));
+    }
+    premultiplyAlphaSSSE3(pixels + i * 4, pixelCount - i);
+}
+
+PIXEL_TARGET("ssse3")
+static void expandRGBToRGBASSSE3(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount, uint8_t alpha) {
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alphaBits = _mm_set1_epi32((int)((uint32_t)alpha << 24));
+
+    // Each 16-byte load covers 4 pixels (12 bytes); stop early enough not to over-read
+    size_t i = 0;
+    for (; i + 6 <= pixelCount; i += 4) {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + i * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(rgba + i * 4),
+                         _mm_or_si128(_mm_shuffle_epi8(px, shuffle), alphaBits));
+    }
+    expandRGBToRGBAScalar(rgb + i * 3, rgba + i * 4, pixelCount - i, alpha);
+}
+
+#endif
+
+// -------------------------
+// ARM (NEON)
+// -------------------------
+#if PIXEL_CONVERT_NEON
+
+static void swapRedBlueNEON(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+    size_t i = 0;
+    for (; i + 16 <= pixelCount; i += 16) {
+        uint8x16x4_t px = vld4q_u8(src + i * 4);
+        const uint8x16_t r = px.val[0];
+        px.val[0] = px.val[2];
+        px.val[2] = r;
+        vst4q_u8(dst + i * 4, px);
+    }
+    swapRedBlueScalar(src + i * 4, dst + i * 4, pixelCount - i);
+}
+
+// round(c * a / 255) for 16 channels, same rounding as div255()
+static inline uint8x16_t mulDiv255(uint8x16_t c, uint8x16_t a) {
+    const uint16x8_t lo = vmull_u8(vget_low_u8(c), vget_low_u8(a));
+    const uint16x8_t hi = vmull_u8(vget_high_u8(c), vget_high_u8(a));
+    return vcombine_u8(vrshrn_n_u16(vrsraq_n_u16(lo, lo, 8), 8),
+                       vrshrn_n_u16(vrsraq_n_u16(hi, hi, 8), 8));
+}
+
+static void premultiplyAlphaNEON(uint8_t* pixels, size_t pixelCount) {
+    size_t i = 0;
+    for (; i + 16 <= pixelCount; i += 16) {
+        uint8x16x4_t px = vld4q_u8(pixels + i * 4);
+        px.val[0] = mulDiv255(px.val[0], px.val[3]);
+        px.val[1] = mulDiv255(px.val[1], px.val[3]);
+        px.val[2] = mulDiv255(px.val[2], px.val[3]);
+        vst4q_u8(pixels + i * 4, px);
+    }
+    premultiplyAlphaScalar(pixels + i * 4, pixelCount - i);
+}
+
+static void expandRGBToRGBANEON(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount, uint8_t alpha) {
+    const uint8x16_t a = vdupq_n_u8(alpha);
+
+    size_t i = 0;
+    for (; i + 16 <= pixelCount; i += 16) {
+        const uint8x16x3_t in = vld3q_u8(rgb + i * 3);
+        uint8x16x4_t out;
+        out.val[0] = in.val[0];
+        out.val[1] = in.val[1];
+        out.val[2] = in.val[2];
+        out.val[3] = a;
+        vst4q_u8(rgba + i * 4, out);
+    }
+    expandRGBToRGBAScalar(rgb + i * 3, rgba + i * 4, pixelCount - i, alpha);
+}
+
+#endif
+
+// -------------------------
+// Dispatch
+// -------------------------
+
+enum class Path { Scalar, SSSE3, AVX2, NEON };
+
+static Path detectPath() {
+#if PIXEL_CONVERT_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool ssse3 = (info[2] & (1 << 9)) != 0;
+    const bool osAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osAvx) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    const bool ssse3 = __builtin_cpu_supports("ssse3");
+    const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) return Path::AVX2;
+    if (ssse3) return Path::SSSE3;
+    return Path::Scalar;
+#elif PIXEL_CONVERT_NEON
+    return Path::NEON;
+#else
+    return Path::Scalar;
+#endif
+}
+
+static Path path() {
+    static const Path selected = detectPath();
+    return selected;
+}
+
+const char* activePath() {
+    switch (path()) {
+        case Path::AVX2:  return "avx2";
+        case Path::SSSE3: return "ssse3";
+        case Path::NEON:  return "neon";
+        default:          return "scalar";
+    }
+}
+
+void swapRedBlue(uint8_t* pixels, size_t pixelCount) {
+    // Every kernel loads a block before storing it, so in place is safe
+    swapRedBlue(pixels, pixels, pixelCount);
+}
+
+void swapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixelCount) {
+    switch (path()) {
+#if PIXEL_CONVERT_X86
+        case Path::AVX2:  swapRedBlueAVX2(src, dst, pixelCount); return;
+        case Path::SSSE3: swapRedBlueSSSE3(src, dst, pixelCount); return;
+#elif PIXEL_CONVERT_NEON
+        case Path::NEON:  swapRedBlueNEON(src, dst, pixelCount); return;
+#endif
+        default: swapRedBlueScalar(src, dst, pixelCount); return;
+    }
+}
+
+void premultiplyAlpha(uint8_t* pixels, size_t pixelCount) {
+    switch (path()) {
+#if PIXEL_CONVERT_X86
+        case Path::AVX2:  premultiplyAlphaAVX2(pixels, pixelCount); return;
+        case Path::SSSE3: premultiplyAlphaSSSE3(pixels, pixelCount); return;
+#elif PIXEL_CONVERT_NEON
+        case Path::NEON:  premultiplyAlphaNEON(pixels, pixelCount); return;
+#endif
+        default: premultiplyAlphaScalar(pixels, pixelCount); return;
+    }
+}
+
+void expandRGBToRGBA(const uint8_t* rgb, uint8_t* rgba, size_t pixelCount, uint8_t alpha) {
+    switch (path()) {
+#if PIXEL_CONVERT_X86
+        // The 3->4 byte expand gains nothing from 256-bit lanes
+        case Path::AVX2:
+        case Path::SSSE3: expandRGBToRGBASSSE3(rgb, rgba, pixelCount, alpha); return;
+#elif PIXEL_CONVERT_NEON
+        case Path::NEON:  expandRGBToRGBANEON(rgb, rgba, pixelCount, alpha); return;
+#endif
+        default: expandRGBToRGBAScalar(rgb, rgba, pixelCount, alpha); return;
+    }
+}
+
+} // namespace PixelConvert
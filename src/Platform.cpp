@@ -0,0 +1,275 @@
+/*
+ * Platform.cpp
+ *
+ * SDL window, native handles for bgfx and renderer selection.
+ */
+
+#include "Platform.h"
+
+#include <SDL.h>
+#include <SDL_syswm.h>
+#if defined(__APPLE__)
+#include <SDL_metal.h>
+#endif
+
+#include <bgfx/platform.h>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+// -------------------------
+// Renderer selection
+// -------------------------
+
+struct RendererName {
+    const char* name;
+    bgfx::RendererType::Enum type;
+};
+
+static constexpr RendererName RENDERER_NAMES[] = {
+    { "auto",   bgfx::RendererType::Count },
+    { "vulkan", bgfx::RendererType::Vulkan },
+    { "d3d12",  bgfx::RendererType::Direct3D12 },
+    { "d3d11",  bgfx::RendererType::Direct3D11 },
+    { "metal",  bgfx::RendererType::Metal },
+    { "noop",   bgfx::RendererType::Noop },
+};
+
+// Most preferred first
+#if defined(__APPLE__)
+static constexpr bgfx::RendererType::Enum PREFERRED_RENDERERS[] = {
+    bgfx::RendererType::Metal,
+};
+#elif defined(_WIN32)
+static constexpr bgfx::RendererType::Enum PREFERRED_RENDERERS[] = {
+    bgfx::RendererType::Direct3D12,
+    bgfx::RendererType::Direct3D11,
+    bgfx::RendererType::Vulkan,
+};
+#else
+static constexpr bgfx::RendererType::Enum PREFERRED_RENDERERS[] = {
+    bgfx::RendererType::Vulkan,
+};
+#endif
+
+// Shader profile directory the build compiles for the platform's own backend
+#if defined(__APPLE__)
+static constexpr const char* NATIVE_SHADER_DIR = "shaders/bin/metal";
+#elif defined(_WIN32)
+static constexpr const char* NATIVE_SHADER_DIR = "shaders/bin/dx11";
+#else
+static constexpr const char* NATIVE_SHADER_DIR = "shaders/bin/spirv";
+#endif
+
+bool Platform::parseRenderer(const char* name, bgfx::RendererType::Enum& out) {
+    for (const RendererName& entry : RENDERER_NAMES) {
+        if (std::strcmp(name, entry.name) == 0) {
+            out = entry.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+bgfx::RendererType::Enum Platform::resolveRenderer(bgfx::RendererType::Enum requested) {
+    bgfx::RendererType::Enum supported[bgfx::RendererType::Count];
+    const uint8_t count = bgfx::getSupportedRenderers(bgfx::RendererType::Count, supported);
+
+    auto isSupported = [&](bgfx::RendererType::Enum type) {
+        for (uint8_t i = 0; i < count; ++i) {
+            if (supported[i] == type) return true;
+        }
+        return false;
+    };
+
+    // bgfx may support a backend the build compiled no shaders for
+    // (e.g. Vulkan through MoltenVK)
+    auto hasShaders = [](bgfx::RendererType::Enum type) {
+        std::error_code ec;
+        return std::filesystem::is_directory(shaderDirectory(type), ec);
+    };
+
+    if (requested != bgfx::RendererType::Count) {
+        if (!isSupported(requested)) {
+            std::fprintf(stderr, "Platform: %s is not supported here, using the default renderer\n",
+                         bgfx::getRendererName(requested));
+        } else if (!hasShaders(requested)) {
+            std::fprintf(stderr, "Platform: No %s shaders in %s, using the default renderer\n",
+                         bgfx::getRendererName(requested), shaderDirectory(requested));
+        } else {
+            return requested;
+        }
+    }
+
+    for (bgfx::RendererType::Enum type : PREFERRED_RENDERERS) {
+        if (isSupported(type) && hasShaders(type)) return type;
+    }
+    return bgfx::RendererType::Count;
+}
+
+const char* Platform::shaderDirectory(bgfx::RendererType::Enum renderer) {
+    switch (renderer) {
+        case bgfx::RendererType::Metal:      return "shaders/bin/metal";
+        case bgfx::RendererType::Direct3D11:
+        case bgfx::RendererType::Direct3D12: return "shaders/bin/dx11";
+        case bgfx::RendererType::Vulkan:     return "shaders/bin/spirv";
+        default:                             return NATIVE_SHADER_DIR;
+    }
+}
+
+std::string Platform::shaderPath(bgfx::RendererType::Enum renderer, const char* name) {
+    std::string path = shaderDirectory(renderer);
+    path += '/';
+    path += name;
+    path += ".bin";
+    return path;
+}
+
+// -------------------------
+// Window and bgfx
+// -------------------------
+
+Platform::~Platform() {
+    shutdown();
+}
+
+bool Platform::init(const Config& config) {
+    if (m_window) {
+        std::fprintf(stderr, "Platform: Already initialized\n");
+        return false;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) != 0) {
+        std::fprintf(stderr, "Platform: SDL_Init failed: %s\n", SDL_GetError());
+        return false;
+    }
+    m_sdl = true;
+
+    m_window = SDL_CreateWindow(
+        config.title,
+        SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+        config.width, config.height,
+        SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI
+    );
+    if (!m_window) {
+        std::fprintf(stderr, "Platform: SDL_CreateWindow failed: %s\n", SDL_GetError());
+        shutdown();
+        return false;
+    }
+
+    bgfx::PlatformData pd{};
+    if (!setPlatformData(pd)) {
+        shutdown();
+        return false;
+    }
+
+    // Render on this thread: bgfx::frame() submits and renders in one call
+    bgfx::renderFrame();
+    readDrawableSize();
+
+    bgfx::Init init;
+    init.type = resolveRenderer(config.renderer);
+    init.vendorId = BGFX_PCI_ID_NONE;
+    init.resolution.width  = (uint32_t)m_backWidth;
+    init.resolution.height = (uint32_t)m_backHeight;
+    init.resolution.reset  = config.reset;
+    init.platformData = pd;
+
+    if (!bgfx::init(init)) {
+        std::fprintf(stderr, "Platform: bgfx::init failed\n");
+        shutdown();
+        return false;
+    }
+    m_bgfx = true;
+    m_reset = config.reset;
+    m_renderer = bgfx::getRendererType();
+
+    std::printf("Platform: %s renderer, %dx%d backbuffer\n",
+                bgfx::getRendererName(m_renderer), m_backWidth, m_backHeight);
+    return true;
+}
+
+bool Platform::setPlatformData(bgfx::PlatformData& pd) {
+#if defined(__APPLE__)
+    // bgfx's Metal (and MoltenVK) backend draws into the view's CAMetalLayer
+    m_metalView = SDL_Metal_CreateView(m_window);
+    if (!m_metalView) {
+        std::fprintf(stderr, "Platform: SDL_Metal_CreateView failed: %s\n", SDL_GetError());
+        return false;
+    }
+    pd.nwh = SDL_Metal_GetLayer(m_metalView);
+    if (!pd.nwh) {
+        std::fprintf(stderr, "Platform: SDL_Metal_GetLayer failed: %s\n", SDL_GetError());
+        return false;
+    }
+    return true;
+#else
+    SDL_SysWMinfo wmi;
+    SDL_VERSION(&wmi.version);
+    if (!SDL_GetWindowWMInfo(m_window, &wmi)) {
+        std::fprintf(stderr, "Platform: SDL_GetWindowWMInfo failed: %s\n", SDL_GetError());
+        return false;
+    }
+
+    switch (wmi.subsystem) {
+#if defined(SDL_VIDEO_DRIVER_WINDOWS)
+        case SDL_SYSWM_WINDOWS:
+            pd.nwh = wmi.info.win.window;
+            return true;
+#endif
+#if defined(SDL_VIDEO_DRIVER_X11)
+        case SDL_SYSWM_X11:
+            pd.ndt = wmi.info.x11.display;
+            pd.nwh = (void*)(uintptr_t)wmi.info.x11.window;
+            return true;
+#endif
+#if defined(SDL_VIDEO_DRIVER_WAYLAND)
+        case SDL_SYSWM_WAYLAND:
+            pd.ndt = wmi.info.wl.display;
+            pd.nwh = wmi.info.wl.surface;
+            pd.type = bgfx::NativeWindowHandleType::Wayland;
+            return true;
+#endif
+        default:
+            std::fprintf(stderr, "Platform: Unsupported window system (SDL subsystem %d)\n",
+                         (int)wmi.subsystem);
+            return false;
+    }
+#endif
+}
+
+void Platform::readDrawableSize() {
+#if defined(__APPLE__)
+    SDL_Metal_GetDrawableSize(m_window, &m_backWidth, &m_backHeight);
+#else
+    SDL_GL_GetDrawableSize(m_window, &m_backWidth, &m_backHeight);
+#endif
+    if (m_backWidth <= 0 || m_backHeight <= 0) {
+        SDL_GetWindowSize(m_window, &m_backWidth, &m_backHeight);
+    }
+}
+
+void Platform::resize() {
+    if (!m_bgfx) return;
+
+    readDrawableSize();
+    bgfx::reset((uint32_t)m_backWidth, (uint32_t)m_backHeight, m_reset);
+}
+
+void Platform::shutdown() {
+    if (m_bgfx) bgfx::shutdown();
+#if defined(__APPLE__)
+    if (m_metalView) SDL_Metal_DestroyView(m_metalView);
+#endif
+    if (m_window) SDL_DestroyWindow(m_window);
+    if (m_sdl) SDL_Quit();
+
+    m_bgfx = false;
+    m_metalView = nullptr;
+    m_window = nullptr;
+    m_sdl = false;
+    m_renderer = bgfx::RendererType::Noop;
+    m_backWidth = 0;
+    m_backHeight = 0;
+}
@@ -7,6 +7,7 @@
 #include "PortScene.h"
 #include "SpriteBatch.h"
 #include "Scene.h"
+#include "LayerCache.h"
 #include <SDL.h>
 #include <cmath>
 #include <cstdio>
@@ -14,15 +15,33 @@
 // Forward declare SailingScene for switching
 #include "SailingScene.h"
 
-// Screen dimensions
-static constexpr float GAME_W = 640.0f;
-static constexpr float GAME_H = 360.0f;
+// Cross-fade when leaving for the open sea
+static constexpr float SCENE_FADE_SECONDS = 0.5f;
 
 PortScene::PortScene(TextureManager& textures)
     : m_textures(textures)
 {
+    // Textures are created by loadStep(), one per step
+}
+
+float PortScene::loadStep() {
+    switch (m_loadStage) {
+        case 0: createSky(); break;
+        case 1: createWater(); break;
+        case 2: createDock(); break;
+        case 3: createBuilding(); break;
+        case 4: createCrane(); break;
+        case 5: createShip(); break;
+        default: break;
+    }
+    
+    if (m_loadStage < LOAD_STAGES) m_loadStage++;
+    return (float)m_loadStage / (float)LOAD_STAGES;
+}
+
+void PortScene::createSky() {
     // Sky - warmer sunset-ish color for port
-    m_skyTex = m_textures.createTestSpriteSheet("port_sky", 1, 180, 1,
+    m_skyTex = m_textures.createTestSpriteSheet("port_sky", 1, 180, 1, 1,
         [](int frame, int x, int y) -> uint32_t {
             float t = y / 180.0f;
             uint8_t r = (uint8_t)(180 + t * 50);   // Warm orange tint
@@ -31,9 +50,11 @@ PortScene::PortScene(TextureManager& textures)
             return 0xFF000000 | (r << 16) | (g << 8) | b;
         }
     );
-    
+}
+
+void PortScene::createWater() {
     // Calm water for harbor
-    m_waterTex = m_textures.createTestSpriteSheet("port_water", 64, 32, 4,
+    m_waterTex = m_textures.createTestSpriteSheet("port_water", 64, 32, 4, 1,
         [](int frame, int x, int y) -> uint32_t {
             // Calmer water than sailing scene
             float wave = std::sin((x + frame * 4) * 0.15f) * 2.0f;
@@ -47,8 +68,15 @@ PortScene::PortScene(TextureManager& textures)
         }
     );
     
+    // Every tile shows the same frame, three frames a second
+    const AnimationClipId clip = AnimationLibrary::get().add(
+        "port_water", m_waterTex, Animation::fromGrid(0, 0, 64, 32, 4, 1.0f / 3.0f));
+    m_water = { clip, 1.0f, 0.0f };
+}
+
+void PortScene::createDock() {
     // Wooden dock
-    m_dockTex = m_textures.createTestSpriteSheet("port_dock", 32, 32, 1,
+    m_dockTex = m_textures.createTestSpriteSheet("port_dock", 32, 32, 1, 1,
         [](int frame, int x, int y) -> uint32_t {
             // Wood plank pattern
             bool plankGap = (y % 8 == 0) || (x % 32 < 2);
@@ -66,9 +94,11 @@ PortScene::PortScene(TextureManager& textures)
             return 0xFF000000 | (r << 16) | (g << 8) | b;
         }
     );
-    
+}
+
+void PortScene::createBuilding() {
     // Building (warehouse style)
-    m_buildingTex = m_textures.createTestSpriteSheet("port_building", 80, 100, 1,
+    m_buildingTex = m_textures.createTestSpriteSheet("port_building", 80, 100, 1, 1,
         [](int frame, int x, int y) -> uint32_t {
             // Roof (top 20 pixels)
             if (y < 20) {
@@ -107,9 +137,11 @@ PortScene::PortScene(TextureManager& textures)
             return 0xFFB22222; // Brick red
         }
     );
-    
+}
+
+void PortScene::createCrane() {
     // Crane
-    m_craneTex = m_textures.createTestSpriteSheet("port_crane", 40, 80, 1,
+    m_craneTex = m_textures.createTestSpriteSheet("port_crane", 40, 80, 1, 1,
         [](int frame, int x, int y) -> uint32_t {
             // Vertical beam
             bool inBeam = (x > 16) && (x < 24) && (y > 10);
@@ -133,14 +165,16 @@ PortScene::PortScene(TextureManager& textures)
             return 0x00000000;
         }
     );
-    
+}
+
+void PortScene::createShip() {
     // Reuse ship from sailing scene if it exists, otherwise create new
     TextureHandle existingShip = m_textures.get("sailing_ship");
     if (existingShip.isValid()) {
         m_shipSheet = existingShip;
     } else {
         // Create ship sprite (same as sailing scene)
-        m_shipSheet = m_textures.createTestSpriteSheet("port_ship", 48, 40, 4,
+        m_shipSheet = m_textures.createTestSpriteSheet("port_ship", 48, 40, 4, 1,
             [](int frame, int x, int y) -> uint32_t {
                 const int w = 48, h = 40;
                 const int cx = w / 2;
@@ -185,58 +219,97 @@ PortScene::PortScene(TextureManager& textures)
 void PortScene::onEnter() {
     std::printf("PortScene: Entered (press SPACE to set sail)\n");
     m_time = 0.0f;
+    
+    // Nothing above the water moves, so draw it once
+    m_layerCache = m_manager ? m_manager->layerCache() : nullptr;
+    if (m_layerCache) {
+        m_backdropLayer = m_layerCache->acquire([this](SpriteBatch& batch) { drawBackdrop(batch); });
+    }
+    
+    // Start loading the sailing scene now so leaving port doesn't hitch
+    if (m_manager && !m_manager->hasPrefetch()) {
+        m_manager->prefetch<SailingScene>(m_textures);
+    }
 }
 
 void PortScene::onExit() {
     std::printf("PortScene: Exited\n");
+    
+    if (m_layerCache) {
+        m_layerCache->release(m_backdropLayer);
+    }
+    m_backdropLayer = -1;
 }
 
 void PortScene::update(float dt) {
     m_time += dt;
+    m_lastDt = dt;
     m_ship.update(dt);
 }
 
-void PortScene::render(SpriteBatch& batch) {
+void PortScene::drawBackdrop(SpriteBatch& batch) {
+    const float canvasW = canvasWidth();
+    const float canvasH = canvasHeight();
+    
     // Draw sky
-    batch.draw(m_skyTex, 0, 0, GAME_W, GAME_H * 0.5f);
+    batch.draw(m_skyTex, 0, 0, canvasW, canvasH * 0.5f);
     
     // Draw buildings in background
-    batch.draw(m_buildingTex, 50, GAME_H * 0.35f - 100, 100, 130);
-    batch.draw(m_buildingTex, 180, GAME_H * 0.35f - 80, 80, 110);
-    batch.draw(m_buildingTex, 450, GAME_H * 0.35f - 90, 90, 120);
+    batch.draw(m_buildingTex, 50, canvasH * 0.35f - 100, 100, 130);
+    batch.draw(m_buildingTex, 180, canvasH * 0.35f - 80, 80, 110);
+    batch.draw(m_buildingTex, 450, canvasH * 0.35f - 90, 90, 120);
     
     // Draw crane
-    batch.draw(m_craneTex, 350, GAME_H * 0.35f - 80, 60, 120);
+    batch.draw(m_craneTex, 350, canvasH * 0.35f - 80, 60, 120);
+}
+
+void PortScene::render(SpriteBatch& batch, float alpha) {
+    // Time-driven motion interpolates by drawing slightly in the past
+    const float lag = (1.0f - alpha) * m_lastDt;
+    const float time = m_time - lag;
+    const float canvasW = canvasWidth();
+    const float canvasH = canvasHeight();
+    
+    if (m_layerCache && m_layerCache->isValid(m_backdropLayer)) {
+        // The backdrop only covers the top half (the water hides the rest)
+        m_layerCache->draw(batch, m_backdropLayer, Rect(0, 0, canvasW, canvasH * 0.5f));
+    } else {
+        drawBackdrop(batch);
+    }
     
     // Draw water
-    int waterFrame = ((int)(m_time * 3)) % 4;
-    Rect waterSrc(waterFrame * 64, 0, 64, 32);
-    for (float wx = 0; wx < GAME_W; wx += 64) {
-        batch.drawRegion(m_waterTex, wx, GAME_H * 0.5f, 64, GAME_H * 0.5f, waterSrc);
+    for (float wx = 0; wx < canvasW; wx += 64) {
+        m_water.draw(batch, wx, canvasH * 0.5f, 64, canvasH * 0.5f, Color::white(), lag);
     }
     
     // Draw dock
     for (float dx = 0; dx < 200; dx += 32) {
-        batch.draw(m_dockTex, dx, GAME_H * 0.45f, 32, 40);
+        batch.draw(m_dockTex, dx, canvasH * 0.45f, 32, 40);
     }
     
     // Draw ship (docked, gentle bob)
-    float bobY = std::sin(m_time * 1.5f) * 2.0f;
-    m_ship.draw(batch, 120, GAME_H * 0.42f + bobY, 72, 60);
+    float bobY = std::sin(time * 1.5f) * 2.0f;
+    m_ship.draw(batch, 120, canvasH * 0.42f + bobY, 72, 60);
+}
+
+void PortScene::setSail() {
+    if (!m_manager || m_manager->isTransitioning()) return;
+    
+    // Usually already loaded in the background since onEnter()
+    if (!m_manager->hasPrefetch()) {
+        m_manager->prefetch<SailingScene>(m_textures);
+    }
+    m_manager->switchToPrefetched(SCENE_FADE_SECONDS);
 }
 
 bool PortScene::handleEvent(const SDL_Event& event) {
     if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE) {
-        if (m_manager) {
-            m_manager->queueSwitch(std::make_unique<SailingScene>(m_textures));
-        }
+        setSail();
         return true;
     }
     
     if (event.type == SDL_MOUSEBUTTONDOWN) {
-        if (m_manager) {
-            m_manager->queueSwitch(std::make_unique<SailingScene>(m_textures));
-        }
+        setSail();
         return true;
     }
     
@@ -0,0 +1,319 @@
+/*
+ * Profiler.cpp
+ *
+ * Frame profiler, HUD and capture output.
+ */
+
+#include "Profiler.h"
+
+#include <bgfx/bgfx.h>
+
+#include <algorithm>
+#include <cstring>
+
+// -------------------------
+// HUD font (3x5 pixels, '#' = set)
+// -------------------------
+static constexpr int GLYPH_W = 3;
+static constexpr int GLYPH_H = 5;
+static constexpr int GLYPH_ADVANCE = GLYPH_W + 1;
+
+static const char FONT_CHARS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:-%/";
+static const char* const FONT_GLYPHS[] = {
+    "####.##.##.####", // 0
+    ".#.##..#..#.###", // 1
+    "###..#####..###", // 2
+    "###..#.##..####", // 3
+    "#.##.####..#..#", // 4
+    "####..###..####", // 5
+    "####..####.####", // 6
+    "###..#..#.#..#.", // 7
+    "####.#####.####", // 8
+    "####.####..####", // 9
+    ".#.#.#####.##.#", // A
+    "##.#.###.#.###.", // B
+    ".###..#..#...##", // C
+    "##.#.##.##.###.", // D
+    "####..##.#..###", // E
+    "####..##.#..#..", // F
+    ".###..#.##.#.##", // G
+    "#.##.#####.##.#", // H
+    "###.#..#..#.###", // I
+    "..#..#..##.#.#.", // J
+    "#.##.###.#.##.#", // K
+    "#..#..#..#..###", // L
+    "#.########.##.#", // M
+    "##.#.##.##.##.#", // N
+    ".#.#.##.##.#.#.", // O
+    "##.#.###.#..#..", // P
+    ".#.#.##.####.##", // Q
+    "##.#.###.#.##.#", // R
+    ".###...#...###.", // S
+    "###.#..#..#..#.", // T
+    "#.##.##.##.####", // U
+    "#.##.##.##.#.#.", // V
+    "#.##.########.#", // W
+    "#.##.#.#.#.##.#", // X
+    "#.##.#.#..#..#.", // Y
+    "###..#.#.#..###", // Z
+    ".............#.", // .
+    "....#.....#....", // :
+    "......###......", // -
+    "#.#..#.#.#..#.#", // %
+    "..#..#.#.#..#..", // /
+};
+static constexpr int FONT_COUNT = (int)sizeof(FONT_CHARS) - 1;
+
+static int glyphIndex(char c) {
+    if (c >= 'a' && c <= 'z') c = (char)(c - 'a' + 'A');
+    const char* p = std::strchr(FONT_CHARS, c);
+    return (p && c != '\0') ? (int)(p - FONT_CHARS) : -1;
+}
+
+// -------------------------
+// Profiler
+// -------------------------
+
+Profiler& Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::~Profiler() {
+    stopCapture();
+}
+
+const char* Profiler::sectionName(ProfileSection section) {
+    switch (section) {
+        case ProfileSection::SceneUpdate: return "update";
+        case ProfileSection::SceneRender: return "render";
+        case ProfileSection::OceanUpdate: return "ocean";
+        case ProfileSection::SpriteFlush: return "flush";
+        case ProfileSection::BgfxFrame:   return "frame";
+        default:                          return "?";
+    }
+}
+
+void Profiler::initOverlay(TextureManager& textures) {
+    // Glyphs side by side, one column of padding each
+    const uint16_t w = (uint16_t)(FONT_COUNT * GLYPH_ADVANCE);
+    const uint16_t h = (uint16_t)GLYPH_H;
+    std::vector<uint8_t> pixels((size_t)w * h * 4, 0);
+
+    for (int g = 0; g < FONT_COUNT; ++g) {
+        const char* bits = FONT_GLYPHS[g];
+        const size_t len = std::strlen(bits);
+        for (int i = 0; i < GLYPH_W * GLYPH_H && (size_t)i < len; ++i) {
+            if (bits[i] != '#') continue;
+            const int px = g * GLYPH_ADVANCE + i % GLYPH_W;
+            const int py = i / GLYPH_W;
+            uint8_t* p = &pixels[((size_t)py * w + px) * 4];
+            p[0] = p[1] = p[2] = p[3] = 255;
+        }
+    }
+
+    m_font = textures.createFromRGBA("profiler_font", w, h, pixels.data());
+    m_panel = textures.createSolidColor("profiler_panel", 255, 255, 255);
+}
+
+void Profiler::beginFrame() {
+    const Clock::time_point now = Clock::now();
+    m_lastFrameStart = m_hasLastFrame ? m_frameStart : now;
+    m_frameStart = now;
+    m_hasLastFrame = true;
+
+    for (auto& ns : m_sectionNs) {
+        ns.store(0, std::memory_order_relaxed);
+    }
+    m_batchStats = SpriteBatch::Stats{};
+    m_arenaStats = FrameArena::Stats{};
+}
+
+void Profiler::recordBatch(const SpriteBatch::Stats& stats) {
+    m_batchStats.spriteCount += stats.spriteCount;
+    m_batchStats.drawCalls += stats.drawCalls;
+    m_batchStats.textureSwaps += stats.textureSwaps;
+    m_batchStats.culledSprites += stats.culledSprites;
+}
+
+void Profiler::recordArena(const FrameArena::Stats& stats) {
+    m_arenaStats = stats;
+}
+
+void Profiler::endFrame() {
+    using Ms = std::chrono::duration<float, std::milli>;
+
+    FrameSample sample;
+    sample.frameMs = Ms(m_frameStart - m_lastFrameStart).count();
+    sample.cpuMs = Ms(Clock::now() - m_frameStart).count();
+    for (size_t i = 0; i < SECTION_COUNT; ++i) {
+        sample.sectionMs[i] = (float)m_sectionNs[i].load(std::memory_order_relaxed) * 1e-6f;
+    }
+
+    // bgfx reports the most recently completed frame
+    if (const bgfx::Stats* stats = bgfx::getStats()) {
+        if (stats->gpuTimerFreq > 0) {
+            sample.gpuMs = (float)(stats->gpuTimeEnd - stats->gpuTimeBegin) * 1000.0f / (float)stats->gpuTimerFreq;
+        }
+        if (stats->cpuTimerFreq > 0) {
+            sample.submitMs = (float)(stats->cpuTimeEnd - stats->cpuTimeBegin) * 1000.0f / (float)stats->cpuTimerFreq;
+        }
+    }
+    sample.drawCalls = m_batchStats.drawCalls;
+    sample.sprites = m_batchStats.spriteCount;
+    sample.arenaBytes = (uint32_t)std::min<size_t>(m_arenaStats.bytesUsed, UINT32_MAX);
+    sample.arenaHeapAllocs = m_arenaStats.heapAllocations;
+
+    m_history[m_head] = sample;
+    m_head = (m_head + 1) % HISTORY;
+    m_count++;
+
+    if (m_capture) {
+        writeCaptureRow(sample);
+    }
+}
+
+const Profiler::FrameSample& Profiler::lastFrame() const {
+    return m_history[(m_head + HISTORY - 1) % HISTORY];
+}
+
+float Profiler::frameTimePercentile(float p) const {
+    const size_t n = std::min(m_count, HISTORY);
+    if (n == 0) return 0.0f;
+
+    m_scratch.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        m_scratch[i] = m_history[i].frameMs;
+    }
+
+    const size_t k = std::min(n - 1, (size_t)(std::clamp(p, 0.0f, 100.0f) / 100.0f * (float)(n - 1) + 0.5f));
+    std::nth_element(m_scratch.begin(), m_scratch.begin() + k, m_scratch.end());
+    return m_scratch[k];
+}
+
+// -------------------------
+// Overlay
+// -------------------------
+
+float Profiler::drawText(SpriteBatch& batch, float x, float y, const char* text, Color color) const {
+    for (const char* c = text; *c; ++c) {
+        const int g = glyphIndex(*c);
+        if (g >= 0) {
+            const Rect src((float)(g * GLYPH_ADVANCE), 0.0f, (float)GLYPH_W, (float)GLYPH_H);
+            batch.drawRegion(m_font, x, y, src, color);
+        }
+        x += GLYPH_ADVANCE;
+    }
+    return x;
+}
+
+void Profiler::drawOverlay(SpriteBatch& batch, float x, float y) const {
+    if (!m_overlayVisible || !m_font.isValid() || m_count == 0) return;
+
+    const FrameSample& last = lastFrame();
+    const float lineH = GLYPH_H + 2;
+    const float panelW = 132.0f;
+    const float graphH = 24.0f;
+    const int lines = 5 + (int)SECTION_COUNT;
+
+    batch.draw(m_panel, x - 2, y - 2, panelW + 4, lines * lineH + graphH + 6, Color(0, 0, 0, 170));
+
+    const Color label(160, 200, 255);
+    const Color value = Color::white();
+    char buf[64];
+    float ly = y;
+
+    auto row = [&](const char* name, const char* text) {
+        drawText(batch, x, ly, name, label);
+        drawText(batch, x + 52, ly, text, value);
+        ly += lineH;
+    };
+
+    std::snprintf(buf, sizeof(buf), "%.2f MS", last.frameMs);
+    row("FRAME", buf);
+    std::snprintf(buf, sizeof(buf), "%.2f / %.2f", frameTimePercentile(50.0f), frameTimePercentile(99.0f));
+    row("P50/P99", buf);
+    for (size_t i = 0; i < SECTION_COUNT; ++i) {
+        std::snprintf(buf, sizeof(buf), "%.3f", last.sectionMs[i]);
+        row(sectionName((ProfileSection)i), buf);
+    }
+    std::snprintf(buf, sizeof(buf), "%.2f / %.2f", last.gpuMs, last.submitMs);
+    row("GPU/SUBMIT", buf);
+    std::snprintf(buf, sizeof(buf), "%u / %u", last.drawCalls, last.sprites);
+    row("DRAW/SPR", buf);
+    std::snprintf(buf, sizeof(buf), "%uK / %u", (last.arenaBytes + 1023) / 1024, last.arenaHeapAllocs);
+    row("ARENA/HEAP", buf);
+
+    // Frame time graph, oldest on the left; full height = 33.3 ms
+    const size_t n = std::min(m_count, HISTORY);
+    const float barW = panelW / (float)HISTORY;
+    const float gy = ly + 2 + graphH;
+    for (size_t i = 0; i < n; ++i) {
+        const FrameSample& s = m_history[(m_head + HISTORY - n + i) % HISTORY];
+        const float h = std::min(s.frameMs / 33.3f, 1.0f) * graphH;
+        const Color c = s.frameMs > 17.0f ? Color(255, 90, 70) : Color(90, 220, 120);
+        batch.draw(m_panel, x + (HISTORY - n + i) * barW, gy - h, barW, h, c);
+    }
+}
+
+// -------------------------
+// Capture
+// -------------------------
+
+bool Profiler::startCapture(const std::string& path) {
+    stopCapture();
+
+    m_capture = std::fopen(path.c_str(), "w");
+    if (!m_capture) {
+        std::fprintf(stderr, "Profiler: Failed to open capture file: %s\n", path.c_str());
+        return false;
+    }
+
+    m_captureJson = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    m_captureFirstRow = true;
+
+    if (m_captureJson) {
+        std::fputs("[\n", m_capture);
+    } else {
+        std::fputs("frame,frame_ms,cpu_ms", m_capture);
+        for (size_t i = 0; i < SECTION_COUNT; ++i) {
+            std::fprintf(m_capture, ",%s_ms", sectionName((ProfileSection)i));
+        }
+        std::fputs(",gpu_ms,submit_ms,draw_calls,sprites,arena_bytes,arena_heap_allocs\n", m_capture);
+    }
+
+    std::printf("Profiler: Capturing to %s\n", path.c_str());
+    return true;
+}
+
+void Profiler::stopCapture() {
+    if (!m_capture) return;
+
+    if (m_captureJson) {
+        std::fputs("\n]\n", m_capture);
+    }
+    std::fclose(m_capture);
+    m_capture = nullptr;
+    std::printf("Profiler: Capture stopped\n");
+}
+
+void Profiler::writeCaptureRow(const FrameSample& s) {
+    if (m_captureJson) {
+        std::fprintf(m_capture, "%s  {\"frame\": %zu, \"frame_ms\": %.4f, \"cpu_ms\": %.4f",
+                     m_captureFirstRow ? "" : ",\n", m_count, s.frameMs, s.cpuMs);
+        for (size_t i = 0; i < SECTION_COUNT; ++i) {
+            std::fprintf(m_capture, ", \"%s_ms\": %.4f", sectionName((ProfileSection)i), s.sectionMs[i]);
+        }
+        std::fprintf(m_capture, ", \"gpu_ms\": %.4f, \"submit_ms\": %.4f, \"draw_calls\": %u, \"sprites\": %u"
+                     ", \"arena_bytes\": %u, \"arena_heap_allocs\": %u}",
+                     s.gpuMs, s.submitMs, s.drawCalls, s.sprites, s.arenaBytes, s.arenaHeapAllocs);
+    } else {
+        std::fprintf(m_capture, "%zu,%.4f,%.4f", m_count, s.frameMs, s.cpuMs);
+        for (size_t i = 0; i < SECTION_COUNT; ++i) {
+            std::fprintf(m_capture, ",%.4f", s.sectionMs[i]);
+        }
+        std::fprintf(m_capture, ",%.4f,%.4f,%u,%u,%u,%u\n", s.gpuMs, s.submitMs, s.drawCalls, s.sprites,
+                     s.arenaBytes, s.arenaHeapAllocs);
+    }
+    m_captureFirstRow = false;
+}
@@ -0,0 +1,243 @@
+/*
+ * RenderPipeline.cpp
+ *
+ * Canvas framebuffer, cached blit quad and the direct path.
+ */
+
+#include "RenderPipeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+// -------------------------
+// Shader loading
+// -------------------------
+
+static std::vector<uint8_t> readFileBytes(const char* path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) return {};
+    f.seekg(0, std::ios::end);
+    const std::streamsize size = f.tellg();
+    f.seekg(0, std::ios::beg);
+    std::vector<uint8_t> data((size_t)size);
+    if (!f.read(reinterpret_cast<char*>(data.data()), size)) return {};
+    return data;
+}
+
+static bgfx::ShaderHandle loadShader(const char* path) {
+    auto bytes = readFileBytes(path);
+    if (bytes.empty()) {
+        std::fprintf(stderr, "RenderPipeline: Failed to read shader: %s\n", path);
+        return BGFX_INVALID_HANDLE;
+    }
+    const bgfx::Memory* mem = bgfx::copy(bytes.data(), (uint32_t)bytes.size());
+    return bgfx::createShader(mem);
+}
+
+static bgfx::ProgramHandle loadProgram(const char* vsPath, const char* fsPath) {
+    bgfx::ShaderHandle vsh = loadShader(vsPath);
+    bgfx::ShaderHandle fsh = loadShader(fsPath);
+    if (!bgfx::isValid(vsh) || !bgfx::isValid(fsh)) {
+        if (bgfx::isValid(vsh)) bgfx::destroy(vsh);
+        if (bgfx::isValid(fsh)) bgfx::destroy(fsh);
+        return BGFX_INVALID_HANDLE;
+    }
+    return bgfx::createProgram(vsh, fsh, true);
+}
+
+// -------------------------
+// Blit quad vertex
+// -------------------------
+
+struct BlitVertex {
+    float x, y, z;
+    float u, v;
+
+    static const bgfx::VertexLayout& layout() {
+        static bgfx::VertexLayout l = [] {
+            bgfx::VertexLayout layout;
+            layout.begin()
+                .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
+                .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+            .end();
+            return layout;
+        }();
+        return l;
+    }
+};
+
+// Point sampling keeps integer-scaled texels crisp; sharp bilinear filters
+static constexpr uint32_t INTEGER_SAMPLER_FLAGS =
+    BGFX_SAMPLER_MIN_POINT | BGFX_SAMPLER_MAG_POINT |
+    BGFX_SAMPLER_MIP_POINT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP;
+static constexpr uint32_t SHARP_SAMPLER_FLAGS =
+    BGFX_SAMPLER_MIP_POINT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP;
+
+RenderPipeline::~RenderPipeline() {
+    shutdown();
+}
+
+bool RenderPipeline::init(const char* vsPath, const char* fsPath, const Config& config,
+                          bgfx::ViewId canvasView, bgfx::ViewId blitView,
+                          uint16_t backWidth, uint16_t backHeight) {
+    if (bgfx::isValid(m_program)) {
+        std::fprintf(stderr, "RenderPipeline: Already initialized\n");
+        return false;
+    }
+    if (config.canvasWidth == 0 || config.canvasHeight == 0) {
+        std::fprintf(stderr, "RenderPipeline: Invalid canvas size %ux%u\n",
+                     config.canvasWidth, config.canvasHeight);
+        return false;
+    }
+
+    m_program = loadProgram(vsPath, fsPath);
+    if (!bgfx::isValid(m_program)) {
+        std::fprintf(stderr, "RenderPipeline: Failed to load blit program\n");
+        return false;
+    }
+
+    m_config = config;
+    m_canvasView = canvasView;
+    m_blitView = blitView;
+
+    // Canvas, with depth for SpriteBatch's opaque path when the GPU has it
+    m_canvasColor = bgfx::createTexture2D(config.canvasWidth, config.canvasHeight, false, 1,
+                                          bgfx::TextureFormat::BGRA8, BGFX_TEXTURE_RT);
+    const uint64_t depthFlags = BGFX_TEXTURE_RT_WRITE_ONLY;
+    m_canvasDepth = config.depth &&
+        bgfx::isTextureValid(0, false, 1, bgfx::TextureFormat::D24S8, depthFlags);
+
+    bgfx::TextureHandle targets[2] = { m_canvasColor, BGFX_INVALID_HANDLE };
+    if (m_canvasDepth) {
+        targets[1] = bgfx::createTexture2D(config.canvasWidth, config.canvasHeight, false, 1,
+                                           bgfx::TextureFormat::D24S8, depthFlags);
+    }
+    m_canvas = bgfx::createFrameBuffer(m_canvasDepth ? 2 : 1, targets, true);
+
+    m_texUniform = bgfx::createUniform("s_tex", bgfx::UniformType::Sampler);
+    if (config.upscale == Upscale::SharpBilinear) {
+        m_paramsUniform = bgfx::createUniform("u_blitParams", bgfx::UniformType::Vec4);
+    }
+
+    bgfx::setViewClear(m_canvasView, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x000000ff, 1.0f, 0);
+    bgfx::setViewClear(m_blitView, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x000000ff, 1.0f, 0);
+
+    resize(backWidth, backHeight);
+    return true;
+}
+
+void RenderPipeline::shutdown() {
+    if (bgfx::isValid(m_quad)) bgfx::destroy(m_quad);
+    if (bgfx::isValid(m_paramsUniform)) bgfx::destroy(m_paramsUniform);
+    if (bgfx::isValid(m_texUniform)) bgfx::destroy(m_texUniform);
+    if (bgfx::isValid(m_canvas)) bgfx::destroy(m_canvas); // Owns its textures
+    if (bgfx::isValid(m_program)) bgfx::destroy(m_program);
+
+    m_quad = BGFX_INVALID_HANDLE;
+    m_paramsUniform = BGFX_INVALID_HANDLE;
+    m_texUniform = BGFX_INVALID_HANDLE;
+    m_canvas = BGFX_INVALID_HANDLE;
+    m_canvasColor = BGFX_INVALID_HANDLE;
+    m_canvasDepth = false;
+    m_program = BGFX_INVALID_HANDLE;
+    m_direct = false;
+}
+
+void RenderPipeline::resize(uint16_t backWidth, uint16_t backHeight) {
+    if (!bgfx::isValid(m_program)) return;
+
+    m_backWidth = std::max<uint16_t>(backWidth, 1);
+    m_backHeight = std::max<uint16_t>(backHeight, 1);
+
+    const int canvasW = m_config.canvasWidth;
+    const int canvasH = m_config.canvasHeight;
+    const int scaleX = m_backWidth / canvasW;
+    const int scaleY = m_backHeight / canvasH;
+
+    if (m_config.upscale == Upscale::Integer) {
+        // Too small a window crops at 1x rather than shrinking texels
+        m_scale = (float)std::max(std::min(scaleX, scaleY), 1);
+    } else {
+        m_scale = std::min((float)m_backWidth / (float)canvasW, (float)m_backHeight / (float)canvasH);
+    }
+    m_viewport.w = (int)std::lround(canvasW * m_scale);
+    m_viewport.h = (int)std::lround(canvasH * m_scale);
+    m_viewport.x = (m_backWidth - m_viewport.w) / 2;
+    m_viewport.y = (m_backHeight - m_viewport.h) / 2;
+
+    // An exact multiple fills the backbuffer, so nothing needs letterboxing
+    m_direct = m_config.directWhenExact && scaleX >= 1 && scaleX == scaleY &&
+               m_backWidth == scaleX * canvasW && m_backHeight == scaleY * canvasH;
+
+    configureViews();
+    if (m_direct) {
+        if (bgfx::isValid(m_quad)) bgfx::destroy(m_quad);
+        m_quad = BGFX_INVALID_HANDLE;
+    } else {
+        rebuildBlitQuad();
+    }
+}
+
+void RenderPipeline::configureViews() {
+    if (m_direct) {
+        // The canvas-sized projection stretches over the whole viewport
+        bgfx::setViewFrameBuffer(m_canvasView, BGFX_INVALID_HANDLE);
+        bgfx::setViewRect(m_canvasView, 0, 0, m_backWidth, m_backHeight);
+        return;
+    }
+
+    bgfx::setViewFrameBuffer(m_canvasView, m_canvas);
+    bgfx::setViewRect(m_canvasView, 0, 0, m_config.canvasWidth, m_config.canvasHeight);
+    bgfx::setViewFrameBuffer(m_blitView, BGFX_INVALID_HANDLE);
+    bgfx::setViewRect(m_blitView, 0, 0, m_backWidth, m_backHeight);
+}
+
+void RenderPipeline::rebuildBlitQuad() {
+    auto pxToClipX = [&](float px) { return (px / (float)m_backWidth) * 2.0f - 1.0f; };
+    auto pxToClipY = [&](float py) { return 1.0f - (py / (float)m_backHeight) * 2.0f; };
+
+    const float x0 = pxToClipX((float)m_viewport.x);
+    const float y0 = pxToClipY((float)m_viewport.y);
+    const float x1 = pxToClipX((float)(m_viewport.x + m_viewport.w));
+    const float y1 = pxToClipY((float)(m_viewport.y + m_viewport.h));
+
+    // Render targets are stored upside down where the origin is bottom-left
+    const bool flip = bgfx::getCaps()->originBottomLeft;
+    const float v0 = flip ? 1.0f : 0.0f;
+    const float v1 = flip ? 0.0f : 1.0f;
+
+    const BlitVertex quad[4] = {
+        { x0, y0, 0.0f, 0.0f, v0 },
+        { x1, y0, 0.0f, 1.0f, v0 },
+        { x0, y1, 0.0f, 0.0f, v1 },
+        { x1, y1, 0.0f, 1.0f, v1 },
+    };
+
+    if (bgfx::isValid(m_quad)) bgfx::destroy(m_quad);
+    m_quad = bgfx::createVertexBuffer(bgfx::copy(quad, sizeof(quad)), BlitVertex::layout());
+}
+
+void RenderPipeline::beginFrame() {
+    bgfx::touch(m_canvasView);
+}
+
+void RenderPipeline::present() {
+    if (m_direct || !bgfx::isValid(m_quad)) return;
+
+    const bool sharp = m_config.upscale == Upscale::SharpBilinear;
+    if (sharp) {
+        const float params[4] = {
+            (float)m_config.canvasWidth, (float)m_config.canvasHeight, m_scale, 0.0f
+        };
+        bgfx::setUniform(m_paramsUniform, params);
+    }
+
+    bgfx::setVertexBuffer(0, m_quad);
+    bgfx::setTexture(0, m_texUniform, m_canvasColor,
+                     sharp ? SHARP_SAMPLER_FLAGS : INTEGER_SAMPLER_FLAGS);
+    bgfx::setState(BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_PT_TRISTRIP);
+    bgfx::submit(m_blitView, m_program);
+}
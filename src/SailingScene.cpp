@@ -12,45 +12,59 @@
 #include <cmath>
 #include <cstdio>
 
-// Screen dimensions
-static constexpr float GAME_W = 640.0f;
-static constexpr float GAME_H = 360.0f;
-
-// Ocean region
+// Ocean region (down to the bottom of the canvas)
 static constexpr float HORIZON_Y = 160.0f;
-static constexpr float OCEAN_HEIGHT = GAME_H - HORIZON_Y;
+
+// Cross-fade when entering port
+static constexpr float SCENE_FADE_SECONDS = 0.5f;
 
 SailingScene::SailingScene(TextureManager& textures)
     : m_textures(textures)
 {
-    createTextures();
-    loadAssets();
+    // Assets are created by loadStep()
+}
+
+float SailingScene::loadStep() {
+    switch (m_loadStage) {
+        case LoadTextures: createTextures(); break;
+        case LoadShip:     loadAssets(); break;
+        case LoadOcean:    initOcean(); break;
+        case LoadUploads:
+            // Ready once background decodes are on the GPU
+            if (m_textures.pendingLoads() > 0) {
+                return (float)LoadUploads / (float)LoadDone;
+            }
+            break;
+        default: break;
+    }
     
-    // Initialize ocean system
-    m_ocean.init(textures);
-    m_ocean.setRegion(0, HORIZON_Y, GAME_W, OCEAN_HEIGHT);
+    if (m_loadStage < LoadDone) m_loadStage++;
+    return (float)m_loadStage / (float)LoadDone;
+}
+
+void SailingScene::finishLoading() {
+    while (m_loadStage < LoadUploads) {
+        loadStep();
+    }
+    m_textures.waitForLoads();
+    m_loadStage = LoadDone;
+}
+
+void SailingScene::initOcean() {
+    m_ocean.init(m_textures);
+    m_ocean.setRegion(0, HORIZON_Y, canvasWidth(), canvasHeight() - HORIZON_Y);
     m_ocean.setBaseColor(
         Color(40, 80, 140),    // Top: lighter blue at horizon
         Color(15, 35, 80)      // Bottom: darker blue
     );
+    m_ocean.setBaseBands(12);
     m_ocean.setSwellDensity(1.0f);   // Swells per second
     m_ocean.setScrollSpeed(1.0f);
 }
 
 void SailingScene::createTextures() {
-    // Sky gradient
-    m_skyTex = m_textures.createTestSpriteSheet("sailing_sky", 1, (int)HORIZON_Y, 1,
-        [](int frame, int x, int y) -> uint32_t {
-            float t = y / 160.0f;
-            uint8_t r = (uint8_t)(100 + t * 80);
-            uint8_t g = (uint8_t)(160 + t * 60);
-            uint8_t b = (uint8_t)(220 + t * 30);
-            return 0xFF000000 | (r << 16) | (g << 8) | b;
-        }
-    );
-    
     // Cloud
-    m_cloudTex = m_textures.createTestSpriteSheet("cloud", 48, 24, 1,
+    m_cloudTex = m_textures.createTestSpriteSheet("cloud", 48, 24, 1, 1,
         [](int frame, int x, int y) -> uint32_t {
             const int cx = 24, cy = 14;
             auto inCircle = [](int px, int py, int ccx, int ccy, int r) {
@@ -74,7 +88,7 @@ void SailingScene::createTextures() {
     );
     
     // Spray particle
-    m_sprayTex = m_textures.createTestSpriteSheet("spray", 8, 8, 1,
+    m_sprayTex = m_textures.createTestSpriteSheet("spray", 8, 8, 1, 1,
         [](int frame, int x, int y) -> uint32_t {
             int cx = 4, cy = 4;
             int dx = x - cx, dy = y - cy;
@@ -88,19 +102,59 @@ void SailingScene::createTextures() {
         }
     );
     
-    // Initialize clouds
-    m_clouds = {
+    // Clouds drift right and wrap around just off screen
+    ParticleEmitter cloud;
+    cloud.texture = m_cloudTex;
+    cloud.width = 48;
+    cloud.height = 24;
+    cloud.originX = 0.5f;
+    cloud.boundsMode = ParticleBounds::Wrap;
+    cloud.bounds = Rect(-60, 0, canvasWidth() + 120, 0);
+    
+    m_clouds.clearEmitters();
+    m_clouds.init(8);
+    const uint16_t cloudEmitter = m_clouds.addEmitter(cloud);
+    
+    // x, y, speed, scale
+    static const float clouds[][4] = {
         { 100, 20, 12.0f, 1.0f },
         { 280, 45, 8.0f, 0.8f },
         { 450, 25, 15.0f, 1.1f },
         { 180, 70, 6.0f, 0.6f },
         { 550, 40, 10.0f, 0.9f },
     };
+    for (const auto& c : clouds) {
+        ParticleSpawn p;
+        p.x = c[0];
+        p.y = c[1];
+        p.vx = c[2];
+        p.scale = c[3];
+        m_clouds.spawn(cloudEmitter, p);
+    }
+    
+    // Spray: short-lived droplets thrown up and back, fading as they grow
+    ParticleEmitter spray;
+    spray.texture = m_sprayTex;
+    spray.width = 5;
+    spray.height = 5;
+    spray.color = Color(255, 255, 255, 180);
+    spray.sizeEnd = 1.8f;
+    spray.alphaEnd = 0.0f;
+    spray.rate = 12.0f;
+    spray.lifetimeMin = 0.6f; spray.lifetimeMax = 1.0f;
+    spray.velocityXMin = -30.0f; spray.velocityXMax = -10.0f;
+    spray.velocityYMin = -40.0f; spray.velocityYMax = -20.0f;
+    spray.gravityY = 60.0f;
+    
+    m_spray.clearEmitters();
+    m_spray.init(64);
+    m_spray.setBlendMode(SpriteBatch::BlendMode::Additive);
+    m_sprayEmitter = m_spray.addEmitter(spray);
 }
 
 void SailingScene::loadAssets() {
-    // Try to load custom ship sprite
-    m_shipSheet = m_textures.load("assets/cog_water.png");
+    // Try to load custom ship sprite (decodes in the background)
+    m_shipSheet = m_textures.loadAsync("assets/cog_water.png");
     
     if (m_shipSheet.isValid()) {
         std::printf("SailingScene: Loaded cog_water.png (%dx%d)\n", 
@@ -109,7 +163,7 @@ void SailingScene::loadAssets() {
         m_shipAnim = Animation::fromGrid(0, 0, 128, 128, 10, 0.2f, true);
     } else {
         std::printf("SailingScene: Using procedural ship\n");
-        m_shipSheet = m_textures.createTestSpriteSheet("proc_ship", 48, 40, 4,
+        m_shipSheet = m_textures.createTestSpriteSheet("proc_ship", 48, 40, 4, 1,
             [](int frame, int x, int y) -> uint32_t {
                 const int w = 48, h = 40, cx = w / 2;
                 float rock = std::sin(frame * 1.57f) * 0.08f;
@@ -145,10 +199,25 @@ void SailingScene::loadAssets() {
 void SailingScene::onEnter() {
     std::printf("SailingScene: Entered (press SPACE to dock at port)\n");
     m_time = 0.0f;
-    m_shipX = GAME_W * 0.3f;
+    m_shipX = canvasWidth() * 0.3f;
     m_shipBaseY = HORIZON_Y - 30.0f;
     m_spray.clear();
-    m_sprayTimer = 0.0f;
+    
+    // Spray rises from the bow at the waterline
+    if (m_spray.emitterCount() > 0) {
+        const float shipW = (m_shipSheet.width > 100) ? 160.0f : 72.0f;
+        const float shipH = (m_shipSheet.width > 100) ? 160.0f : 60.0f;
+        ParticleEmitter& spray = m_spray.emitter(m_sprayEmitter);
+        spray.spawnX = m_shipX + shipW * 0.7f;
+        spray.spawnY = m_shipBaseY + shipH * 0.75f;
+        spray.spawnW = shipW * 0.2f;
+        spray.spawnH = 4.0f;
+    }
+    
+    // Start loading the port now so docking doesn't hitch
+    if (m_manager && !m_manager->hasPrefetch()) {
+        m_manager->prefetch<PortScene>(m_textures);
+    }
 }
 
 void SailingScene::onExit() {
@@ -157,57 +226,54 @@ void SailingScene::onExit() {
 
 void SailingScene::update(float dt) {
     m_time += dt;
+    m_lastDt = dt;
     
     // Update ship animation
     m_ship.update(dt);
     
     // Ship bobs in place (or moves slowly)
     // m_shipX += dt * 10.0f;
-    // if (m_shipX > GAME_W + 100) m_shipX = -100;
-    
-    // Update ocean
-    m_ocean.update(dt);
+    // if (m_shipX > canvasWidth() + 100) m_shipX = -100;
     
-    // Update clouds
-    for (auto& cloud : m_clouds) {
-        cloud.x += cloud.speed * dt;
-        if (cloud.x < -60) {
-            cloud.x = GAME_W + 60;
-        }
+    // Ocean, clouds and spray share no state, so they can run side by side
+    JobSystem* jobs = m_manager ? m_manager->jobs() : nullptr;
+    if (!jobs) {
+        m_ocean.update(dt);
+        m_clouds.update(dt);
+        m_spray.update(dt);
+        return;
     }
     
-    // Update spray
-    for (auto& p : m_spray) {
-        p.life -= dt;
-        p.x += p.vx * dt;
-        p.y += p.vy * dt;
-        p.vy += 60.0f * dt;
+    // Built once; the tasks read this step's dt from m_lastDt
+    if (m_updateGraph.empty()) {
+        m_updateGraph.add([this] { m_ocean.update(m_lastDt); });
+        m_updateGraph.add([this] { m_clouds.update(m_lastDt); });
+        m_updateGraph.add([this] { m_spray.update(m_lastDt); });
     }
-    
-    m_spray.erase(
-        std::remove_if(m_spray.begin(), m_spray.end(),
-            [](const SprayParticle& p) { return p.life <= 0; }),
-        m_spray.end()
-    );
+    jobs->run(m_updateGraph);
 }
 
-void SailingScene::render(SpriteBatch& batch) {
-    // Sky
-    batch.draw(m_skyTex, 0, 0, GAME_W, HORIZON_Y);
+void SailingScene::render(SpriteBatch& batch, float alpha) {
+    // Draw everything as it was (1 - alpha) of the last step ago; motion is
+    // linear within a step, so this interpolates between the two updates
+    const float lag = (1.0f - alpha) * m_lastDt;
+    const float time = m_time - lag;
+    
+    // Sky (opaque, so whatever covers it isn't blended on top)
+    batch.setBlendMode(SpriteBatch::BlendMode::Opaque);
+    batch.drawGradientRect(0, 0, canvasWidth(), HORIZON_Y,
+                           Color(100, 160, 220), Color(180, 220, 250));
+    batch.setBlendMode(SpriteBatch::BlendMode::Alpha);
     
     // Clouds
-    for (const auto& cloud : m_clouds) {
-        float w = 48 * cloud.scale;
-        float h = 24 * cloud.scale;
-        batch.draw(m_cloudTex, cloud.x - w/2, cloud.y, w, h);
-    }
+    m_clouds.render(batch, lag);
     
     // Ocean with dynamic swells
-    m_ocean.render(batch);
+    m_ocean.render(batch, alpha, m_manager ? m_manager->jobs() : nullptr);
     
     // Ship
-    float shipBob = std::sin(m_time * 2.0f) * 3.0f;
-    float shipRock = std::sin(m_time * 1.5f) * 0.01f;
+    float shipBob = std::sin(time * 2.0f) * 3.0f;
+    float shipRock = std::sin(time * 1.5f) * 0.01f;
     float shipDrawY = m_shipBaseY + shipBob;
     
     float shipW, shipH;
@@ -220,26 +286,27 @@ void SailingScene::render(SpriteBatch& batch) {
     m_ship.draw(batch, m_shipX, shipDrawY, shipW, shipH, shipRock, 0.5f, 0.8f);
     
     // Spray
-    for (const auto& p : m_spray) {
-        float alpha = p.life / p.maxLife;
-        uint8_t a = (uint8_t)(alpha * 180);
-        float size = 5.0f + (1.0f - alpha) * 4.0f;
-        batch.draw(m_sprayTex, p.x, p.y, size, size, Color(255, 255, 255, a));
+    m_spray.render(batch, lag);
+}
+
+void SailingScene::dock() {
+    if (!m_manager || m_manager->isTransitioning()) return;
+    
+    // Usually already loaded in the background since onEnter()
+    if (!m_manager->hasPrefetch()) {
+        m_manager->prefetch<PortScene>(m_textures);
     }
+    m_manager->switchToPrefetched(SCENE_FADE_SECONDS);
 }
 
 bool SailingScene::handleEvent(const SDL_Event& event) {
     if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE) {
-        if (m_manager) {
-            m_manager->queueSwitch(std::make_unique<PortScene>(m_textures));
-        }
+        dock();
         return true;
     }
     
     if (event.type == SDL_MOUSEBUTTONDOWN) {
-        if (m_manager) {
-            m_manager->queueSwitch(std::make_unique<PortScene>(m_textures));
-        }
+        dock();
         return true;
     }
     
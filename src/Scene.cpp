@@ -5,40 +5,96 @@
  */
 
 #include "Scene.h"
+#include "Animation.h"
+#include "LayerCache.h"
 #include "SpriteBatch.h"
+#include "Profiler.h"
 #include <SDL.h>
+#include <algorithm>
+#include <cstdio>
+
+float Scene::canvasWidth() const {
+  return (float)(m_manager ? m_manager->canvasWidth() : SceneManager::DEFAULT_CANVAS_WIDTH);
+}
+
+float Scene::canvasHeight() const {
+  return (float)(m_manager ? m_manager->canvasHeight() : SceneManager::DEFAULT_CANVAS_HEIGHT);
+}
 
 SceneManager::~SceneManager() {
+  finishFade();
   if (m_currentScene) {
     m_currentScene->onExit();
     m_currentScene.reset();
   }
   m_queuedScene.reset();
+  m_prefetched.reset();
 }
 
 void SceneManager::switchTo(std::unique_ptr<Scene> scene) {
+  // Load whatever is still missing (nothing if it was prefetched);
+  // loading may lay out to the canvas, so the manager is set first
+  if (scene) {
+    scene->setManager(this);
+    scene->finishLoading();
+  }
+
   // Exit current scene
+  finishFade();
   if (m_currentScene) {
     m_currentScene->onExit();
   }
 
   // Switch to new scene
-  m_currentScene = std::move(scene);
+  enterScene(std::move(scene));
+}
 
-  if (m_currentScene) {
-    m_currentScene->setManager(this);
-    m_currentScene->onEnter();
+void SceneManager::prefetch(std::unique_ptr<Scene> scene) {
+  m_prefetched = std::move(scene);
+  m_prefetchProgress = 0.0f;
+
+  if (m_prefetched) {
+    m_prefetched->setManager(this);
+  } else {
+    m_switchWhenReady = false;
   }
 }
 
+void SceneManager::switchToPrefetched(float fadeSeconds) {
+  if (!m_prefetched) {
+    std::fprintf(stderr, "SceneManager: switchToPrefetched() without a prefetched scene\n");
+    return;
+  }
+
+  m_switchWhenReady = true;
+  m_fadeRequested = std::max(fadeSeconds, 0.0f);
+}
+
 void SceneManager::queueSwitch(std::unique_ptr<Scene> scene) {
   m_queuedScene = std::move(scene);
   m_hasPendingSwitch = true;
 }
 
 void SceneManager::update(float dt) {
+  PROFILE_SCOPE(SceneUpdate);
+
+  // Shared clips animate from one clock (see AnimationLibrary)
+  AnimationLibrary::get().advance(dt);
+
   // Process any queued scene switch first
   processQueuedSwitch();
+  processPrefetch();
+
+  // The outgoing scene keeps animating while it fades out
+  if (m_outgoingScene) {
+    m_fadeTime += dt;
+    if (m_fadeTime >= m_fadeDuration) {
+      finishFade();
+    } else {
+      m_outgoingScene->update(dt);
+      if (m_layerCache) m_layerCache->invalidate(m_fadeLayer);
+    }
+  }
 
   if (m_currentScene) {
     m_currentScene->update(dt);
@@ -48,9 +104,26 @@ void SceneManager::update(float dt) {
   processQueuedSwitch();
 }
 
-void SceneManager::render(SpriteBatch& batch) {
+void SceneManager::render(SpriteBatch& batch, float alpha) {
+  PROFILE_SCOPE(SceneRender);
+
   if (m_currentScene) {
-    m_currentScene->render(batch);
+    m_currentScene->render(batch, alpha);
+  }
+
+  // Cross-fade: draw the outgoing scene on top with decreasing alpha.
+  // From its cached layer it fades as one image; drawn directly, its own
+  // overlapping sprites show through each other
+  if (m_outgoingScene) {
+    const float t = std::clamp(m_fadeTime / m_fadeDuration, 0.0f, 1.0f);
+    const uint8_t batchAlpha = batch.getAlpha();
+    batch.setAlpha((uint8_t)(batchAlpha * (1.0f - t)));
+    if (m_layerCache && m_layerCache->isValid(m_fadeLayer)) {
+      m_layerCache->draw(batch, m_fadeLayer);
+    } else {
+      m_outgoingScene->render(batch, alpha);
+    }
+    batch.setAlpha(batchAlpha);
   }
 }
 
@@ -67,3 +140,59 @@ void SceneManager::processQueuedSwitch() {
     switchTo(std::move(m_queuedScene));
   }
 }
+
+void SceneManager::processPrefetch() {
+  if (!m_prefetched) return;
+
+  // One slice of loading per frame
+  if (m_prefetchProgress < 1.0f) {
+    m_prefetchProgress = std::clamp(m_prefetched->loadStep(), 0.0f, 1.0f);
+  }
+
+  if (!m_switchWhenReady || m_prefetchProgress < 1.0f) return;
+
+  m_switchWhenReady = false;
+  m_prefetchProgress = 0.0f;
+  std::unique_ptr<Scene> next = std::move(m_prefetched);
+
+  finishFade();
+  if (m_currentScene && m_fadeRequested > 0.0f) {
+    // onExit() is deferred until the fade has finished
+    m_outgoingScene = std::move(m_currentScene);
+    m_fadeDuration = m_fadeRequested;
+    m_fadeTime = 0.0f;
+
+    // Redrawn every frame while it fades (at its latest update, the layer
+    // renders before the game view); -1 if the cache is full
+    if (m_layerCache) {
+      Scene* outgoing = m_outgoingScene.get();
+      m_fadeLayer = m_layerCache->acquire([outgoing](SpriteBatch& layerBatch) {
+        outgoing->render(layerBatch, 1.0f);
+      });
+    }
+  } else if (m_currentScene) {
+    m_currentScene->onExit();
+  }
+
+  enterScene(std::move(next));
+}
+
+void SceneManager::enterScene(std::unique_ptr<Scene> scene) {
+  m_currentScene = std::move(scene);
+
+  if (m_currentScene) {
+    m_currentScene->setManager(this);
+    m_currentScene->onEnter();
+  }
+}
+
+void SceneManager::finishFade() {
+  if (m_layerCache) {
+    m_layerCache->release(m_fadeLayer);
+    m_fadeLayer = -1;
+  }
+  if (m_outgoingScene) {
+    m_outgoingScene->onExit();
+    m_outgoingScene.reset();
+  }
+}
@@ -0,0 +1,130 @@
+/*
+ * SpatialGrid.cpp
+ *
+ * Hashed uniform grid queries.
+ */
+
+#include "SpatialGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : m_cellSize(cellSize > 0.0f ? cellSize : DEFAULT_CELL_SIZE),
+      m_invCellSize(1.0f / m_cellSize) {}
+
+SpatialGrid::CellRange SpatialGrid::cellRange(const Rect& bounds) const {
+    CellRange range;
+    range.x0 = (int32_t)std::floor(bounds.x * m_invCellSize);
+    range.y0 = (int32_t)std::floor(bounds.y * m_invCellSize);
+    range.x1 = (int32_t)std::floor((bounds.x + std::max(bounds.w, 0.0f)) * m_invCellSize);
+    range.y1 = (int32_t)std::floor((bounds.y + std::max(bounds.h, 0.0f)) * m_invCellSize);
+    return range;
+}
+
+void SpatialGrid::link(uint32_t id, const CellRange& cells) {
+    for (int32_t y = cells.y0; y <= cells.y1; ++y) {
+        for (int32_t x = cells.x0; x <= cells.x1; ++x) {
+            m_cells[cellKey(x, y)].push_back(id);
+        }
+    }
+}
+
+void SpatialGrid::unlink(uint32_t id, const CellRange& cells) {
+    for (int32_t y = cells.y0; y <= cells.y1; ++y) {
+        for (int32_t x = cells.x0; x <= cells.x1; ++x) {
+            auto it = m_cells.find(cellKey(x, y));
+            if (it == m_cells.end()) continue;
+
+            // Order inside a cell doesn't matter; query() sorts
+            std::vector<uint32_t>& ids = it->second;
+            auto pos = std::find(ids.begin(), ids.end(), id);
+            if (pos != ids.end()) {
+                *pos = ids.back();
+                ids.pop_back();
+            }
+            // Empty cells keep their storage for the next entity passing through
+        }
+    }
+}
+
+void SpatialGrid::insert(uint32_t id, const Rect& bounds) {
+    if (id >= m_entries.size()) {
+        m_entries.resize((size_t)id + 1);
+        m_visited.resize((size_t)id + 1, 0);
+    }
+
+    Entry& entry = m_entries[id];
+    const CellRange cells = cellRange(bounds);
+
+    if (entry.active) {
+        const CellRange& old = entry.cells;
+        const bool sameCells = old.x0 == cells.x0 && old.y0 == cells.y0 &&
+                               old.x1 == cells.x1 && old.y1 == cells.y1;
+        if (!sameCells) {
+            unlink(id, old);
+            link(id, cells);
+        }
+    } else {
+        link(id, cells);
+        entry.active = true;
+        m_size++;
+    }
+
+    entry.bounds = bounds;
+    entry.cells = cells;
+}
+
+void SpatialGrid::remove(uint32_t id) {
+    if (!contains(id)) return;
+
+    Entry& entry = m_entries[id];
+    unlink(id, entry.cells);
+    entry.active = false;
+    m_size--;
+}
+
+bool SpatialGrid::contains(uint32_t id) const {
+    return id < m_entries.size() && m_entries[id].active;
+}
+
+void SpatialGrid::query(const Rect& area, std::vector<uint32_t>& out) const {
+    const size_t first = out.size();
+
+    // A fresh stamp marks this query's visits; reset on wrap-around
+    if (++m_queryStamp == 0) {
+        std::fill(m_visited.begin(), m_visited.end(), 0);
+        m_queryStamp = 1;
+    }
+
+    const CellRange cells = cellRange(area);
+    for (int32_t y = cells.y0; y <= cells.y1; ++y) {
+        for (int32_t x = cells.x0; x <= cells.x1; ++x) {
+            auto it = m_cells.find(cellKey(x, y));
+            if (it == m_cells.end()) continue;
+
+            for (uint32_t id : it->second) {
+                if (m_visited[id] == m_queryStamp) continue;
+                m_visited[id] = m_queryStamp;
+
+                // Sharing a cell isn't overlapping
+                const Rect& b = m_entries[id].bounds;
+                if (b.x + b.w < area.x || b.x > area.x + area.w ||
+                    b.y + b.h < area.y || b.y > area.y + area.h) {
+                    continue;
+                }
+                out.push_back(id);
+            }
+        }
+    }
+
+    std::sort(out.begin() + (std::ptrdiff_t)first, out.end());
+}
+
+void SpatialGrid::clear() {
+    m_entries.clear();
+    m_cells.clear();
+    m_visited.clear();
+    m_size = 0;
+    m_queryStamp = 0;
+}
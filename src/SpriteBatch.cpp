@@ -5,13 +5,17 @@
  */
 
 #include "SpriteBatch.h"
+#include "FrameArena.h"
 #include "TextureManager.h"
+#include "Profiler.h"
 
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
+#include <numeric>
+#include <type_traits>
 #include <vector>
 #include <bx/math.h>
 
@@ -39,6 +43,39 @@ static bgfx::ShaderHandle loadShader(const char* path) {
     return bgfx::createShader(mem);
 }
 
+static bgfx::ProgramHandle loadProgram(const char* vsPath, const char* fsPath) {
+    bgfx::ShaderHandle vsh = loadShader(vsPath);
+    bgfx::ShaderHandle fsh = loadShader(fsPath);
+    
+    if (!bgfx::isValid(vsh) || !bgfx::isValid(fsh)) {
+        if (bgfx::isValid(vsh)) bgfx::destroy(vsh);
+        if (bgfx::isValid(fsh)) bgfx::destroy(fsh);
+        std::fprintf(stderr, "SpriteBatch: Failed to load shaders\n");
+        return BGFX_INVALID_HANDLE;
+    }
+    
+    bgfx::ProgramHandle program = bgfx::createProgram(vsh, fsh, true);
+    if (!bgfx::isValid(program)) {
+        std::fprintf(stderr, "SpriteBatch: Failed to create program\n");
+    }
+    return program;
+}
+
+// Replace a loaded program with a fresh copy; keeps the old one if loading fails
+static bool reloadProgram(bgfx::ProgramHandle& program, const std::string& vsPath, const std::string& fsPath) {
+    if (!bgfx::isValid(program)) return true;
+    
+    bgfx::ProgramHandle reloaded = loadProgram(vsPath.c_str(), fsPath.c_str());
+    if (!bgfx::isValid(reloaded)) {
+        std::fprintf(stderr, "SpriteBatch: Keeping the previous %s / %s\n", vsPath.c_str(), fsPath.c_str());
+        return false;
+    }
+    
+    bgfx::destroy(program);
+    program = reloaded;
+    return true;
+}
+
 // -------------------------
 // Vertex layout (static)
 // -------------------------
@@ -56,6 +93,112 @@ bgfx::VertexLayout& SpriteBatch::SpriteVertex::getLayout() {
     return layout;
 }
 
+bgfx::VertexLayout& SpriteBatch::SpriteVertexSlot::getLayout() {
+    static bgfx::VertexLayout layout;
+    static bool initialized = false;
+    if (!initialized) {
+        layout.begin()
+            .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true) // normalized
+            .add(bgfx::Attrib::TexCoord1, 1, bgfx::AttribType::Float)    // slot index
+        .end();
+        initialized = true;
+    }
+    return layout;
+}
+
+bgfx::VertexLayout& SpriteBatch::SpriteVertexCompact::getLayout() {
+    static bgfx::VertexLayout layout;
+    static bool initialized = false;
+    if (!initialized) {
+        layout.begin()
+            .add(bgfx::Attrib::Position, 2, bgfx::AttribType::Int16, true)   // normalized, * POSITION_RANGE
+            .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Int16, true)  // normalized, offset 16-bit UV
+            .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)     // normalized
+        .end();
+        initialized = true;
+    }
+    return layout;
+}
+
+bgfx::VertexLayout& SpriteBatch::SpriteVertexSlotCompact::getLayout() {
+    static bgfx::VertexLayout layout;
+    static bool initialized = false;
+    if (!initialized) {
+        layout.begin()
+            .add(bgfx::Attrib::Position, 2, bgfx::AttribType::Int16, true)   // normalized, * POSITION_RANGE
+            .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Int16, true)  // normalized, offset 16-bit UV
+            .add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)     // normalized
+            .add(bgfx::Attrib::TexCoord1, 4, bgfx::AttribType::Uint8, true)  // slot index / 255
+        .end();
+        initialized = true;
+    }
+    return layout;
+}
+
+// Tile grid vertex: column/row of the tile in a_position, corner (0 or 1) in a_texcoord0
+static bgfx::VertexLayout& tileGridLayout() {
+    static bgfx::VertexLayout layout;
+    static bool initialized = false;
+    if (!initialized) {
+        layout.begin()
+            .add(bgfx::Attrib::Position, 2, bgfx::AttribType::Float)
+            .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+        .end();
+        initialized = true;
+    }
+    return layout;
+}
+
+SpriteBatch::SpriteInstance SpriteBatch::SpriteInstance::make(
+    float x, float y, float width, float height,
+    float rotation, float originX, float originY,
+    float u0, float v0, float u1, float v1,
+    uint32_t color, float slot) {
+    // 12 bits per origin axis and 24 bits of RGB are exact in a float
+    const float ox = std::round(std::clamp(originX, 0.0f, 1.0f) * 4095.0f);
+    const float oy = std::round(std::clamp(originY, 0.0f, 1.0f) * 4095.0f);
+    
+    SpriteInstance inst;
+    inst.x = x;
+    inst.y = y;
+    inst.width = width;
+    inst.height = height;
+    inst.u0 = u0;
+    inst.v0 = v0;
+    inst.u1 = u1;
+    inst.v1 = v1;
+    inst.rotation = rotation;
+    inst.origin = ox + oy * 4096.0f;
+    inst.rgb = (float)(color & 0x00FFFFFFu); // ABGR: R in the low byte
+    inst.alphaSlot = (float)(color >> 24) + slot * 256.0f;
+    return inst;
+}
+
+// -------------------------
+// Quad index buffer
+// -------------------------
+// Every quad uses the same pattern (TL, TR, BL / TR, BR, BL) relative to its
+// first vertex, so one static buffer covers any run of up to maxSprites quads.
+// Runs are offset with the startVertex argument of setVertexBuffer().
+template<typename Index>
+static const bgfx::Memory* buildQuadIndices(uint32_t maxSprites) {
+    const bgfx::Memory* mem = bgfx::alloc(maxSprites * 6 * (uint32_t)sizeof(Index));
+    Index* indices = reinterpret_cast<Index*>(mem->data);
+    
+    for (uint32_t i = 0; i < maxSprites; ++i) {
+        const Index base = (Index)(i * 4);
+        indices[i * 6 + 0] = base + 0; // TL
+        indices[i * 6 + 1] = base + 1; // TR
+        indices[i * 6 + 2] = base + 2; // BL
+        indices[i * 6 + 3] = base + 1; // TR
+        indices[i * 6 + 4] = base + 3; // BR
+        indices[i * 6 + 5] = base + 2; // BL
+    }
+    return mem;
+}
+
 // -------------------------
 // SpriteBatch implementation
 // -------------------------
@@ -64,35 +207,177 @@ SpriteBatch::~SpriteBatch() {
     shutdown();
 }
 
-bool SpriteBatch::init(const char* vsPath, const char* fsPath, uint32_t maxSprites) {
-    // Load shaders
-    bgfx::ShaderHandle vsh = loadShader(vsPath);
-    bgfx::ShaderHandle fsh = loadShader(fsPath);
-    
-    if (!bgfx::isValid(vsh) || !bgfx::isValid(fsh)) {
-        if (bgfx::isValid(vsh)) bgfx::destroy(vsh);
-        if (bgfx::isValid(fsh)) bgfx::destroy(fsh);
-        std::fprintf(stderr, "SpriteBatch: Failed to load shaders\n");
+bool SpriteBatch::init(const char* vsPath, const char* fsPath, uint32_t maxSprites,
+                       Geometry geometry, VertexFormat format) {
+    if (geometry == Geometry::Instanced &&
+        !(bgfx::getCaps()->supported & BGFX_CAPS_INSTANCING)) {
+        std::fprintf(stderr, "SpriteBatch: Instancing not supported by renderer\n");
+        return false;
+    }
+    if (geometry == Geometry::Instanced && format == VertexFormat::Compact) {
+        std::fprintf(stderr, "SpriteBatch: Compact vertices need Geometry::Vertices\n");
         return false;
     }
     
-    m_program = bgfx::createProgram(vsh, fsh, true);
+    m_program = loadProgram(vsPath, fsPath);
     if (!bgfx::isValid(m_program)) {
-        std::fprintf(stderr, "SpriteBatch: Failed to create program\n");
         return false;
     }
+    m_programSource = { vsPath, fsPath };
+    m_geometry = geometry;
+    m_vertexFormat = format;
     
     // Create sampler uniform
     m_texUniform = bgfx::createUniform("s_texColor", bgfx::UniformType::Sampler);
     
-    // Reserve sprite storage
+    // Static index buffer shared by every batch (16-bit while it fits)
+    if (maxSprites * 4 <= 65536) {
+        m_indexBuffer = bgfx::createIndexBuffer(buildQuadIndices<uint16_t>(maxSprites));
+    } else {
+        m_indexBuffer = bgfx::createIndexBuffer(buildQuadIndices<uint32_t>(maxSprites),
+                                                BGFX_BUFFER_INDEX32);
+    }
+    if (!bgfx::isValid(m_indexBuffer)) {
+        std::fprintf(stderr, "SpriteBatch: Failed to create index buffer\n");
+        return false;
+    }
+    
+    // Reserve sprite storage (and worst-case one streaming run per sprite)
     m_maxSprites = maxSprites;
     m_sprites.reserve(maxSprites);
+    m_runs.reserve(maxSprites);
+    
+    // Unit quad expanded by vs_sprite_inst (corner offsets in 0..1)
+    if (geometry == Geometry::Instanced) {
+        static const float unitQuad[4][3] = {
+            { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, // TL, TR
+            { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f, 0.0f }, // BL, BR
+        };
+        bgfx::VertexLayout quadLayout;
+        quadLayout.begin()
+            .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
+        .end();
+        m_unitQuad = bgfx::createVertexBuffer(bgfx::makeRef(unitQuad, sizeof(unitQuad)), quadLayout);
+    }
+    
+    // 1x1 white texture so gradients can fall back to the sprite program
+    const uint32_t white = 0xFFFFFFFF;
+    m_whiteTexture = bgfx::createTexture2D(1, 1, false, 1, bgfx::TextureFormat::BGRA8,
+                                           BGFX_TEXTURE_NONE | BGFX_SAMPLER_POINT,
+                                           bgfx::copy(&white, sizeof(white)));
+    
+    std::printf("SpriteBatch: Initialized (max %u sprites%s)\n", maxSprites,
+                geometry == Geometry::Instanced ? ", instanced" :
+                format == VertexFormat::Compact ? ", compact vertices" : "");
+    return true;
+}
+
+bool SpriteBatch::enableTextureSlots(const char* vsPath, const char* fsPath, uint8_t slots) {
+    if (m_begun) {
+        std::fprintf(stderr, "SpriteBatch: enableTextureSlots() called inside begin()/end()\n");
+        return false;
+    }
+    
+    const bgfx::Caps* caps = bgfx::getCaps();
+    if (slots > MAX_TEXTURE_SLOTS) slots = MAX_TEXTURE_SLOTS;
+    if (caps && slots > caps->limits.maxTextureSamplers) {
+        slots = (uint8_t)caps->limits.maxTextureSamplers;
+    }
+    if (slots < 2) {
+        std::fprintf(stderr, "SpriteBatch: Texture slots need at least 2 samplers\n");
+        return false;
+    }
+    
+    bgfx::ProgramHandle program = loadProgram(vsPath, fsPath);
+    if (!bgfx::isValid(program)) {
+        return false;
+    }
+    
+    if (bgfx::isValid(m_slotProgram)) {
+        bgfx::destroy(m_slotProgram);
+    }
+    m_slotProgram = program;
+    m_slotSource = { vsPath, fsPath };
+    
+    // Sampler names match fs_sprite_slots.sc
+    for (uint8_t i = 0; i < MAX_TEXTURE_SLOTS; ++i) {
+        if (!bgfx::isValid(m_slotUniforms[i])) {
+            char name[16];
+            std::snprintf(name, sizeof(name), "s_texSlot%u", (unsigned)i);
+            m_slotUniforms[i] = bgfx::createUniform(name, bgfx::UniformType::Sampler);
+        }
+    }
+    
+    m_slotCount = slots;
+    std::printf("SpriteBatch: Texture slots enabled (%u per draw)\n", (unsigned)slots);
+    return true;
+}
+
+bool SpriteBatch::enableGradients(const char* vsPath, const char* fsPath) {
+    if (m_begun) {
+        std::fprintf(stderr, "SpriteBatch: enableGradients() called inside begin()/end()\n");
+        return false;
+    }
+    
+    bgfx::ProgramHandle program = loadProgram(vsPath, fsPath);
+    if (!bgfx::isValid(program)) {
+        return false;
+    }
+    
+    if (bgfx::isValid(m_gradientProgram)) {
+        bgfx::destroy(m_gradientProgram);
+    }
+    m_gradientProgram = program;
+    m_gradientSource = { vsPath, fsPath };
+    return true;
+}
+
+bool SpriteBatch::enableTileGrids(const char* vsPath, const char* fsPath) {
+    if (m_begun) {
+        std::fprintf(stderr, "SpriteBatch: enableTileGrids() called inside begin()/end()\n");
+        return false;
+    }
+    
+    bgfx::ProgramHandle program = loadProgram(vsPath, fsPath);
+    if (!bgfx::isValid(program)) {
+        return false;
+    }
+    
+    if (bgfx::isValid(m_tileProgram)) {
+        bgfx::destroy(m_tileProgram);
+    }
+    m_tileProgram = program;
+    m_tileSource = { vsPath, fsPath };
     
-    std::printf("SpriteBatch: Initialized (max %u sprites)\n", maxSprites);
+    if (!bgfx::isValid(m_tileUniform)) {
+        m_tileUniform = bgfx::createUniform("u_tileGrid", bgfx::UniformType::Vec4, TILE_GRID_UNIFORMS);
+    }
     return true;
 }
 
+bool SpriteBatch::reloadShaders() {
+    if (m_begun) {
+        std::fprintf(stderr, "SpriteBatch: reloadShaders() called inside begin()/end()\n");
+        return false;
+    }
+    
+    bool ok = reloadProgram(m_program, m_programSource.vs, m_programSource.fs);
+    ok &= reloadProgram(m_slotProgram, m_slotSource.vs, m_slotSource.fs);
+    ok &= reloadProgram(m_gradientProgram, m_gradientSource.vs, m_gradientSource.fs);
+    ok &= reloadProgram(m_tileProgram, m_tileSource.vs, m_tileSource.fs);
+    
+    std::printf("SpriteBatch: Reloaded shaders%s\n", ok ? "" : " (some failed)");
+    return ok;
+}
+
+bgfx::ProgramHandle SpriteBatch::gradientProgram() const {
+    if (bgfx::isValid(m_gradientProgram)) return m_gradientProgram;
+    
+    // The sprite program only takes gradient (float) vertices with the float format
+    if (m_geometry == Geometry::Vertices && m_vertexFormat == VertexFormat::Float) return m_program;
+    return BGFX_INVALID_HANDLE;
+}
+
 void SpriteBatch::shutdown() {
     if (bgfx::isValid(m_program)) {
         bgfx::destroy(m_program);
@@ -102,10 +387,61 @@ void SpriteBatch::shutdown() {
         bgfx::destroy(m_texUniform);
         m_texUniform = BGFX_INVALID_HANDLE;
     }
+    if (bgfx::isValid(m_slotProgram)) {
+        bgfx::destroy(m_slotProgram);
+        m_slotProgram = BGFX_INVALID_HANDLE;
+    }
+    for (bgfx::UniformHandle& uniform : m_slotUniforms) {
+        if (bgfx::isValid(uniform)) {
+            bgfx::destroy(uniform);
+            uniform = BGFX_INVALID_HANDLE;
+        }
+    }
+    m_slotCount = 1;
+    if (bgfx::isValid(m_indexBuffer)) {
+        bgfx::destroy(m_indexBuffer);
+        m_indexBuffer = BGFX_INVALID_HANDLE;
+    }
+    if (bgfx::isValid(m_unitQuad)) {
+        bgfx::destroy(m_unitQuad);
+        m_unitQuad = BGFX_INVALID_HANDLE;
+    }
+    if (bgfx::isValid(m_gradientProgram)) {
+        bgfx::destroy(m_gradientProgram);
+        m_gradientProgram = BGFX_INVALID_HANDLE;
+    }
+    if (bgfx::isValid(m_whiteTexture)) {
+        bgfx::destroy(m_whiteTexture);
+        m_whiteTexture = BGFX_INVALID_HANDLE;
+    }
+    if (bgfx::isValid(m_tileProgram)) {
+        bgfx::destroy(m_tileProgram);
+        m_tileProgram = BGFX_INVALID_HANDLE;
+    }
+    if (bgfx::isValid(m_tileUniform)) {
+        bgfx::destroy(m_tileUniform);
+        m_tileUniform = BGFX_INVALID_HANDLE;
+    }
+    for (const TileGrid& grid : m_tileGrids) {
+        bgfx::destroy(grid.vertices);
+    }
+    m_tileGrids.clear();
     m_sprites.clear();
+    m_runs.clear();
+    m_gradientVerts.clear();
+    m_tileGridDraws.clear();
 }
 
-void SpriteBatch::begin(bgfx::ViewId viewId, uint16_t screenWidth, uint16_t screenHeight) {
+void SpriteBatch::setStreaming(bool enabled) {
+    if (m_begun) {
+        std::fprintf(stderr, "SpriteBatch: setStreaming() called inside begin()/end()\n");
+        return;
+    }
+    m_streaming = enabled;
+}
+
+void SpriteBatch::begin(bgfx::ViewId viewId, uint16_t screenWidth, uint16_t screenHeight,
+                        bool depthTest) {
     if (m_begun) {
         std::fprintf(stderr, "SpriteBatch: begin() called without end()\n");
         return;
@@ -115,21 +451,33 @@ void SpriteBatch::begin(bgfx::ViewId viewId, uint16_t screenWidth, uint16_t scre
     m_viewId = viewId;
     m_screenW = screenWidth;
     m_screenH = screenHeight;
+    m_depthTest = depthTest;
     
     // Clear sprite queue
     m_sprites.clear();
+    m_runs.clear();
+    m_gradientVerts.clear();
+    m_tileGridDraws.clear();
     m_currentDepth = 0.0f;
+    m_alpha = 255;
+    m_layer = 0;
+    m_blendMode = BlendMode::Alpha;
+    m_cullRect = Rect(0.0f, 0.0f, (float)screenWidth, (float)screenHeight);
+    m_nextOrder = 0;
+    m_closeRun = false;
     
     // Reset stats
     m_stats = Stats{};
     
     // Set up orthographic projection using bgfx helper
-    // (0,0) at top-left, (screenWidth, screenHeight) at bottom-right
+    // (0,0) at top-left, (screenWidth, screenHeight) at bottom-right.
+    // Vertices sit at z = 0; depth-tested draws are moved to their depth
+    // by the model transform (see submitDraw)
     float ortho[16];
     bx::mtxOrtho(ortho, 
         0.0f, (float)screenWidth,    // left, right
         (float)screenHeight, 0.0f,   // bottom, top (flipped for top-left origin)
-        0.0f, 1000.0f,               // near, far
+        0.0f, 1.0f,                  // near, far
         0.0f,                        // offset
         bgfx::getCaps()->homogeneousDepth);  // API-specific depth
     
@@ -138,6 +486,14 @@ void SpriteBatch::begin(bgfx::ViewId viewId, uint16_t screenWidth, uint16_t scre
     bx::mtxIdentity(identity);
     
     bgfx::setViewTransform(viewId, identity, ortho);
+    
+    // Keep painter's order across programs (sprites, slots, gradients) and
+    // encoders: every submit's depth is its order position (see drawKey)
+    bgfx::setViewMode(viewId, bgfx::ViewMode::DepthAscending);
+    
+    if (streams()) {
+        reserveStream();
+    }
 }
 
 void SpriteBatch::draw(const TextureHandle& texture, float x, float y, Color color) {
@@ -149,22 +505,9 @@ void SpriteBatch::draw(const TextureHandle& texture, float x, float y,
                        float width, float height, Color color) {
     if (!texture.isValid()) return;
     
-    // Full texture UV
-    const float u0 = 0.0f, v0 = 0.0f;
-    const float u1 = 1.0f, v1 = 1.0f;
-    
-    const float x0 = x, y0 = y;
-    const float x1 = x + width, y1 = y + height;
-    const uint32_t c = color.toABGR();
-    
-    SpriteVertex verts[4] = {
-        { x0, y0, m_currentDepth, u0, v0, c }, // TL
-        { x1, y0, m_currentDepth, u1, v0, c }, // TR
-        { x0, y1, m_currentDepth, u0, v1, c }, // BL
-        { x1, y1, m_currentDepth, u1, v1, c }, // BR
-    };
-    
-    addQuad(texture.texture, verts, m_currentDepth);
+    // Full image UV (sub-rect when the texture lives in an atlas page)
+    emitSprite(texture.texture, x, y, width, height, 0.0f, 0.0f, 0.0f,
+               texture.u0, texture.v0, texture.u1, texture.v1, color.toABGR());
 }
 
 void SpriteBatch::draw(const TextureHandle& texture, float x, float y,
@@ -173,43 +516,8 @@ void SpriteBatch::draw(const TextureHandle& texture, float x, float y,
                        Color color) {
     if (!texture.isValid()) return;
     
-    // Compute rotated corners
-    const float ox = width * originX;
-    const float oy = height * originY;
-    
-    const float cosR = std::cos(rotation);
-    const float sinR = std::sin(rotation);
-    
-    // Corner offsets from origin (before rotation)
-    // TL, TR, BL, BR
-    float corners[4][2] = {
-        { -ox,         -oy },
-        { width - ox,  -oy },
-        { -ox,         height - oy },
-        { width - ox,  height - oy }
-    };
-    
-    // Rotate and translate
-    const uint32_t c = color.toABGR();
-    SpriteVertex verts[4];
-    
-    for (int i = 0; i < 4; ++i) {
-        float cx = corners[i][0];
-        float cy = corners[i][1];
-        
-        verts[i].x = x + ox + (cx * cosR - cy * sinR);
-        verts[i].y = y + oy + (cx * sinR + cy * cosR);
-        verts[i].z = m_currentDepth;
-        verts[i].color = c;
-    }
-    
-    // UVs
-    verts[0].u = 0.0f; verts[0].v = 0.0f; // TL
-    verts[1].u = 1.0f; verts[1].v = 0.0f; // TR
-    verts[2].u = 0.0f; verts[2].v = 1.0f; // BL
-    verts[3].u = 1.0f; verts[3].v = 1.0f; // BR
-    
-    addQuad(texture.texture, verts, m_currentDepth);
+    emitSprite(texture.texture, x, y, width, height, rotation, originX, originY,
+               texture.u0, texture.v0, texture.u1, texture.v1, color.toABGR());
 }
 
 void SpriteBatch::drawRegion(const TextureHandle& texture, float x, float y,
@@ -223,27 +531,11 @@ void SpriteBatch::drawRegion(const TextureHandle& texture, float x, float y,
                               const Rect& srcRect, Color color) {
     if (!texture.isValid()) return;
     
-    // Convert pixel UV rect to normalized UV
-    const float texW = (float)texture.width;
-    const float texH = (float)texture.height;
-    
-    const float u0 = srcRect.x / texW;
-    const float v0 = srcRect.y / texH;
-    const float u1 = (srcRect.x + srcRect.w) / texW;
-    const float v1 = (srcRect.y + srcRect.h) / texH;
-    
-    const float x0 = x, y0 = y;
-    const float x1 = x + dstWidth, y1 = y + dstHeight;
-    const uint32_t c = color.toABGR();
+    float u0, v0, u1, v1;
+    regionUVs(texture, srcRect, u0, v0, u1, v1);
     
-    SpriteVertex verts[4] = {
-        { x0, y0, m_currentDepth, u0, v0, c },
-        { x1, y0, m_currentDepth, u1, v0, c },
-        { x0, y1, m_currentDepth, u0, v1, c },
-        { x1, y1, m_currentDepth, u1, v1, c },
-    };
-    
-    addQuad(texture.texture, verts, m_currentDepth);
+    emitSprite(texture.texture, x, y, dstWidth, dstHeight, 0.0f, 0.0f, 0.0f,
+               u0, v0, u1, v1, color.toABGR());
 }
 
 void SpriteBatch::drawRegion(const TextureHandle& texture, float x, float y,
@@ -253,63 +545,315 @@ void SpriteBatch::drawRegion(const TextureHandle& texture, float x, float y,
                               Color color) {
     if (!texture.isValid()) return;
     
-    const float texW = (float)texture.width;
-    const float texH = (float)texture.height;
+    float u0, v0, u1, v1;
+    regionUVs(texture, srcRect, u0, v0, u1, v1);
+    
+    emitSprite(texture.texture, x, y, dstWidth, dstHeight, rotation, originX, originY,
+               u0, v0, u1, v1, color.toABGR());
+}
+
+void SpriteBatch::drawGradientRect(float x, float y, float width, float height,
+                                   Color topColor, Color bottomColor,
+                                   uint8_t bands) {
+    if (!bgfx::isValid(gradientProgram())) return;
+    if (isCulled(m_cullRect, x, y, width, height, 0.0f, 0.0f, 0.0f)) {
+        m_stats.culledSprites++;
+        return;
+    }
     
-    const float u0 = srcRect.x / texW;
-    const float v0 = srcRect.y / texH;
-    const float u1 = (srcRect.x + srcRect.w) / texW;
-    const float v1 = (srcRect.y + srcRect.h) / texH;
+    const float x1 = x + width, y1 = y + height;
+    const float corners[4][2] = { { x, y }, { x1, y }, { x, y1 }, { x1, y1 } };
+    uint32_t top = topColor.toABGR();
+    uint32_t bottom = bottomColor.toABGR();
+    if (m_alpha != 255) {
+        top = fadeColor(top);
+        bottom = fadeColor(bottom);
+    }
     
-    const float ox = dstWidth * originX;
-    const float oy = dstHeight * originY;
+    // u carries the band count, v runs 0..1 down the gradient
+    SpriteVertex verts[4];
+    writeQuad(verts, corners, 0.0f, (float)bands, 0.0f, (float)bands, 1.0f, top, 0.0f);
+    verts[2].color = bottom;
+    verts[3].color = bottom;
+    
+    if (streams()) {
+        // Gradient quads live beside the stream; the run keeps their place
+        if (m_gradientVerts.size() / 4 >= m_maxSprites) {
+            flushStream();
+            reserveStream();
+        }
+        
+        const uint32_t quad = (uint32_t)(m_gradientVerts.size() / 4);
+        if (m_runs.empty() || !m_runs.back().gradient || m_runs.back().blend != drawBlend() || m_closeRun) {
+            DrawRun& run = m_runs.emplace_back();
+            run.firstQuad = quad;
+            run.quadCount = 0;
+            run.textureCount = 0;
+            run.gradient = true;
+            run.blend = drawBlend();
+            run.order = m_nextOrder++;
+            m_closeRun = false;
+        }
+        m_runs.back().quadCount++;
+        m_gradientVerts.insert(m_gradientVerts.end(), verts, verts + 4);
+    } else {
+        if (m_sprites.size() >= m_maxSprites) {
+            flush();
+        }
+        
+        SpriteItem& item = m_sprites.emplace_back();
+        item.texture = BGFX_INVALID_HANDLE;
+        item.key = sortKey(item.texture);
+        std::memcpy(item.vertices, verts, sizeof(verts));
+    }
+    
+    m_currentDepth += 0.001f;
+}
+
+bool SpriteBatch::drawTileGrid(const TextureHandle& texture, uint16_t cols, uint16_t rows,
+                               const TileGridParams& params, const Rect& srcRect,
+                               Color color) {
+    if (!hasTileGrids() || !texture.isValid()) return false;
+    
+    // Tiles index the shared quad index buffer
+    const uint32_t tileCount = (uint32_t)cols * rows;
+    if (tileCount == 0 || tileCount > m_maxSprites) return false;
+    
+    const bgfx::VertexBufferHandle vertices = tileGridVertices(cols, rows);
+    if (!bgfx::isValid(vertices)) return false;
+    
+    float u0, v0, u1, v1;
+    regionUVs(texture, srcRect, u0, v0, u1, v1);
+    
+    uint32_t abgr = color.toABGR();
+    if (m_alpha != 255) abgr = fadeColor(abgr);
+    
+    TileGridDraw draw;
+    draw.texture = texture.texture;
+    draw.vertices = vertices;
+    draw.tileCount = tileCount;
+    draw.blend = drawBlend();
+    
+    const float uniforms[TILE_GRID_UNIFORMS][4] = {
+        { params.x, params.y, params.tileWidth, params.tileHeight },
+        { u0, v0, u1 - u0, v1 - v0 },
+        { params.limitX, params.limitY, params.waveAmplitude, params.waveFrequency },
+        { params.wavePhase, 0.0f, 0.0f, 0.0f },
+        { (float)(abgr & 0xFF) / 255.0f, (float)((abgr >> 8) & 0xFF) / 255.0f,
+          (float)((abgr >> 16) & 0xFF) / 255.0f, (float)(abgr >> 24) / 255.0f },
+    };
+    std::memcpy(draw.uniforms, uniforms, sizeof(uniforms));
+    
+    if (streams()) {
+        // Queued as its own run so it lands between the quads around it
+        DrawRun& run = m_runs.emplace_back();
+        run.firstQuad = 0;
+        run.quadCount = 0;
+        run.textureCount = 0;
+        run.tileGrid = (int32_t)m_tileGridDraws.size();
+        run.order = m_nextOrder++;
+        m_tileGridDraws.push_back(draw);
+        m_closeRun = false;
+    } else {
+        // Everything queued so far has a lower depth, so submit it first
+        flush();
+        bgfx::Encoder* encoder = bgfx::begin();
+        submitTileGrid(encoder, draw, m_nextOrder++);
+        bgfx::end(encoder);
+        m_stats.drawCalls++;
+    }
+    
+    m_currentDepth += 0.001f;
+    return true;
+}
+
+bgfx::VertexBufferHandle SpriteBatch::tileGridVertices(uint16_t cols, uint16_t rows) {
+    for (const TileGrid& grid : m_tileGrids) {
+        if (grid.cols == cols && grid.rows == rows) return grid.vertices;
+    }
+    
+    // 4 vertices per tile in quad index order (TL, TR, BL, BR)
+    const uint32_t tileCount = (uint32_t)cols * rows;
+    const bgfx::Memory* mem = bgfx::alloc(tileCount * 4 * 4 * (uint32_t)sizeof(float));
+    float* dst = reinterpret_cast<float*>(mem->data);
+    for (uint16_t row = 0; row < rows; ++row) {
+        for (uint16_t col = 0; col < cols; ++col) {
+            static const float corners[4][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+            for (const auto& corner : corners) {
+                *dst++ = (float)col;
+                *dst++ = (float)row;
+                *dst++ = corner[0];
+                *dst++ = corner[1];
+            }
+        }
+    }
+    
+    const bgfx::VertexBufferHandle vertices = bgfx::createVertexBuffer(mem, tileGridLayout());
+    if (!bgfx::isValid(vertices)) {
+        std::fprintf(stderr, "SpriteBatch: Failed to create tile grid buffer\n");
+        return BGFX_INVALID_HANDLE;
+    }
+    m_tileGrids.push_back({ cols, rows, vertices });
+    return vertices;
+}
+
+void SpriteBatch::regionUVs(const TextureHandle& texture, const Rect& srcRect,
+                            float& u0, float& v0, float& u1, float& v1) {
+    // Convert the pixel rect to normalized UV within the image's own region,
+    // which is the whole texture unless it was packed into an atlas page
+    const float scaleU = (texture.u1 - texture.u0) / (float)texture.width;
+    const float scaleV = (texture.v1 - texture.v0) / (float)texture.height;
+    
+    u0 = texture.u0 + srcRect.x * scaleU;
+    v0 = texture.v0 + srcRect.y * scaleV;
+    u1 = texture.u0 + (srcRect.x + srcRect.w) * scaleU;
+    v1 = texture.v0 + (srcRect.y + srcRect.h) * scaleV;
+}
+
+bool SpriteBatch::isCulled(const Rect& cull, float x, float y, float width, float height,
+                           float rotation, float originX, float originY) {
+    float minX, minY, maxX, maxY;
+    if (rotation == 0.0f) {
+        // Negative sizes mirror the sprite
+        minX = std::min(x, x + width);
+        maxX = std::max(x, x + width);
+        minY = std::min(y, y + height);
+        maxY = std::max(y, y + height);
+    } else {
+        // Any rotation stays within the farthest corner's distance from the pivot
+        const float ox = width * originX;
+        const float oy = height * originY;
+        const float rx = std::max(std::fabs(ox), std::fabs(width - ox));
+        const float ry = std::max(std::fabs(oy), std::fabs(height - oy));
+        const float r = std::sqrt(rx * rx + ry * ry);
+        minX = x + ox - r;
+        maxX = x + ox + r;
+        minY = y + oy - r;
+        maxY = y + oy + r;
+    }
+    
+    return maxX <= cull.x || minX >= cull.x + cull.w ||
+           maxY <= cull.y || minY >= cull.y + cull.h;
+}
+
+void SpriteBatch::rotatedCorners(float x, float y, float width, float height,
+                                 float rotation, float originX, float originY,
+                                 float out[4][2]) {
+    const float ox = width * originX;
+    const float oy = height * originY;
     
     const float cosR = std::cos(rotation);
     const float sinR = std::sin(rotation);
     
-    float corners[4][2] = {
-        { -ox,            -oy },
-        { dstWidth - ox,  -oy },
-        { -ox,            dstHeight - oy },
-        { dstWidth - ox,  dstHeight - oy }
+    // Corner offsets from origin (before rotation)
+    // TL, TR, BL, BR
+    const float corners[4][2] = {
+        { -ox,         -oy },
+        { width - ox,  -oy },
+        { -ox,         height - oy },
+        { width - ox,  height - oy }
     };
     
-    float uvs[4][2] = {
-        { u0, v0 }, { u1, v0 }, { u0, v1 }, { u1, v1 }
-    };
+    // Rotate and translate
+    for (int i = 0; i < 4; ++i) {
+        const float cx = corners[i][0];
+        const float cy = corners[i][1];
+        out[i][0] = x + ox + (cx * cosR - cy * sinR);
+        out[i][1] = y + oy + (cx * sinR + cy * cosR);
+    }
+}
+
+void SpriteBatch::emitSprite(bgfx::TextureHandle texture,
+                             float x, float y, float width, float height,
+                             float rotation, float originX, float originY,
+                             float u0, float v0, float u1, float v1,
+                             uint32_t color) {
+    if (isCulled(m_cullRect, x, y, width, height, rotation, originX, originY)) {
+        m_stats.culledSprites++;
+        return;
+    }
+    if (m_alpha != 255) color = fadeColor(color);
     
-    const uint32_t c = color.toABGR();
-    SpriteVertex verts[4];
+    float slot = 0.0f;
+    void* dst = allocQuad(texture, slot);
+    if (!dst) return;
     
-    for (int i = 0; i < 4; ++i) {
-        float cx = corners[i][0];
-        float cy = corners[i][1];
+    if (m_geometry == Geometry::Instanced) {
+        // One record per sprite; the vertex shader rotates and expands it
+        *static_cast<SpriteInstance*>(dst) = SpriteInstance::make(
+            x, y, width, height, rotation, originX, originY,
+            u0, v0, u1, v1, color, slot);
+    } else {
+        float corners[4][2];
+        if (rotation == 0.0f) {
+            const float x1 = x + width, y1 = y + height;
+            corners[0][0] = x;  corners[0][1] = y;  // TL
+            corners[1][0] = x1; corners[1][1] = y;  // TR
+            corners[2][0] = x;  corners[2][1] = y1; // BL
+            corners[3][0] = x1; corners[3][1] = y1; // BR
+        } else {
+            rotatedCorners(x, y, width, height, rotation, originX, originY, corners);
+        }
         
-        verts[i].x = x + ox + (cx * cosR - cy * sinR);
-        verts[i].y = y + oy + (cx * sinR + cy * cosR);
-        verts[i].z = m_currentDepth;
-        verts[i].u = uvs[i][0];
-        verts[i].v = uvs[i][1];
-        verts[i].color = c;
+        // Streamed quads are written in the final GPU layout; queued quads are
+        // stored as SpriteVertex and converted (with their slot) in flush()
+        if (m_streaming) {
+            writeGpuQuad(dst, corners, 0.0f, u0, v0, u1, v1, color, slot);
+        } else {
+            writeQuad(static_cast<SpriteVertex*>(dst), corners, 0.0f,
+                      u0, v0, u1, v1, color, slot);
+        }
     }
     
-    addQuad(texture.texture, verts, m_currentDepth);
+    // Depth orders queued sprites; later ones draw on top
+    m_currentDepth += 0.001f;
+}
+
+int SpriteBatch::bindSlot(DrawRun& run, bgfx::TextureHandle texture) {
+    return run.bind(texture, m_slotCount, m_stats.textureSwaps);
 }
 
-void SpriteBatch::addQuad(bgfx::TextureHandle texture, const SpriteVertex verts[4], float depth) {
+void* SpriteBatch::allocQuad(bgfx::TextureHandle texture, float& slot) {
+    if (streams()) {
+        // Full (or never reserved): submit what we have and grab a new buffer
+        if (m_streamCount >= m_streamCapacity) {
+            flushStream();
+            reserveStream();
+            if (m_streamCapacity == 0) return nullptr;
+        }
+        
+        // Only run boundaries are recorded; vertices go straight to the GPU buffer
+        const bool joinable = !m_runs.empty() && !m_runs.back().gradient &&
+                              m_runs.back().tileGrid < 0 &&
+                              m_runs.back().blend == drawBlend() && !m_closeRun;
+        int s = joinable ? bindSlot(m_runs.back(), texture) : -1;
+        if (s < 0) {
+            DrawRun& run = m_runs.emplace_back();
+            run.firstQuad = m_streamCount;
+            run.quadCount = 0;
+            run.textureCount = 0;
+            run.blend = drawBlend();
+            run.order = m_nextOrder++;
+            m_closeRun = false;
+            s = bindSlot(run, texture);
+        }
+        m_runs.back().quadCount++;
+        slot = (float)s;
+        
+        const size_t quadBytes = (m_geometry == Geometry::Instanced)
+            ? sizeof(SpriteInstance)
+            : (size_t)vertexLayout().getStride() * 4;
+        return m_streamVerts + (size_t)(m_streamCount++) * quadBytes;
+    }
+    
     if (m_sprites.size() >= m_maxSprites) {
         flush();
     }
     
-    SpriteItem item;
+    SpriteItem& item = m_sprites.emplace_back();
     item.texture = texture;
-    item.depth = depth;
-    std::memcpy(item.vertices, verts, sizeof(item.vertices));
-    
-    m_sprites.push_back(item);
-    
-    // Increment depth slightly so sprites drawn later appear on top
-    m_currentDepth += 0.001f;
+    item.key = sortKey(texture);
+    return item.vertices;
 }
 
 void SpriteBatch::end() {
@@ -318,92 +862,573 @@ void SpriteBatch::end() {
         return;
     }
     
-    flush();
+    if (streams()) {
+        flushStream();
+    } else {
+        flush();
+    }
     m_begun = false;
 }
 
-void SpriteBatch::flush() {
-    if (m_sprites.empty()) return;
+// Render state of every sprite program, by blend mode
+static uint64_t blendState(SpriteBatch::BlendMode blend) {
+    using BlendMode = SpriteBatch::BlendMode;
+    
+    constexpr uint64_t write = BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A;
+    switch (blend) {
+        case BlendMode::Premultiplied:
+            return write | BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_ONE, BGFX_STATE_BLEND_INV_SRC_ALPHA);
+        case BlendMode::Additive:
+            return write | BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_ONE);
+        case BlendMode::Multiply:
+            // Premultiplied src: dst * (src.rgb + 1 - a) = dst * mix(1, rgb, a)
+            return write | BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_DST_COLOR, BGFX_STATE_BLEND_INV_SRC_ALPHA);
+        case BlendMode::Opaque:
+            return write;
+        case BlendMode::Alpha:
+        default:
+            return write | BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA);
+    }
+}
+
+// Point sampling (pixel art) and clamping
+static constexpr uint32_t SPRITE_SAMPLER_FLAGS =
+    BGFX_SAMPLER_MIN_POINT |
+    BGFX_SAMPLER_MAG_POINT |
+    BGFX_SAMPLER_MIP_POINT |
+    BGFX_SAMPLER_U_CLAMP |
+    BGFX_SAMPLER_V_CLAMP;
+
+void SpriteBatch::submitRun(bgfx::Encoder* encoder, const DrawRun& run,
+                            const bgfx::TransientVertexBuffer* tvb, uint32_t sub) const {
+    if (run.gradient) {
+        const bgfx::ProgramHandle program = gradientProgram();
+        encoder->setVertexBuffer(0, tvb, run.firstQuad * 4, run.quadCount * 4);
+        encoder->setIndexBuffer(m_indexBuffer, 0, run.quadCount * 6);
+        if (program.idx == m_program.idx) {
+            encoder->setTexture(0, m_texUniform, m_whiteTexture);
+        }
+        submitDraw(encoder, program, run.blend, run.order, sub);
+        return;
+    }
     
-    // Sort by depth to maintain draw order (back to front)
-    // Note: We intentionally do NOT sort by texture here because that would
-    // break the painter's algorithm (things drawn later should appear on top).
-    // The trade-off is more draw calls, but correct layering.
-    std::stable_sort(m_sprites.begin(), m_sprites.end(),
-        [](const SpriteItem& a, const SpriteItem& b) {
-            return a.depth < b.depth;
-        });
+    if (m_geometry == Geometry::Instanced) {
+        // Unit quad expanded per instance
+        encoder->setVertexBuffer(0, m_unitQuad);
+        encoder->setIndexBuffer(m_indexBuffer, 0, 6);
+        encoder->setInstanceDataBuffer(&m_instanceBuffer, run.firstQuad, run.quadCount);
+    } else {
+        encoder->setVertexBuffer(0, tvb, run.firstQuad * 4, run.quadCount * 4);
+        encoder->setIndexBuffer(m_indexBuffer, 0, run.quadCount * 6);
+    }
     
-    const bgfx::VertexLayout& layout = SpriteVertex::getLayout();
+    if (usesSlots()) {
+        // Unused slots repeat the first texture so every sampler is bound
+        for (uint8_t i = 0; i < m_slotCount; ++i) {
+            const bgfx::TextureHandle tex = (i < run.textureCount) ? run.textures[i] : run.textures[0];
+            encoder->setTexture(i, m_slotUniforms[i], tex, SPRITE_SAMPLER_FLAGS);
+        }
+    } else {
+        encoder->setTexture(0, m_texUniform, run.textures[0], SPRITE_SAMPLER_FLAGS);
+    }
     
-    bgfx::TextureHandle currentTexture = BGFX_INVALID_HANDLE;
-    std::vector<SpriteVertex> batchVerts;
-    batchVerts.reserve(m_sprites.size() * 6); // 6 verts per quad (2 triangles)
+    submitDraw(encoder, usesSlots() ? m_slotProgram : m_program, run.blend, run.order, sub);
+}
+
+void SpriteBatch::submitTileGrid(bgfx::Encoder* encoder, const TileGridDraw& draw,
+                                 uint32_t order) const {
+    encoder->setVertexBuffer(0, draw.vertices);
+    encoder->setIndexBuffer(m_indexBuffer, 0, draw.tileCount * 6);
+    encoder->setUniform(m_tileUniform, draw.uniforms, TILE_GRID_UNIFORMS);
+    encoder->setTexture(0, m_texUniform, draw.texture, SPRITE_SAMPLER_FLAGS);
+    submitDraw(encoder, m_tileProgram, draw.blend, order, 0);
+}
+
+void SpriteBatch::submitDraw(bgfx::Encoder* encoder, bgfx::ProgramHandle program,
+                             BlendMode blend, uint32_t order, uint32_t sub) const {
+    uint64_t state = blendState(blend);
+    uint32_t key = drawKey(order, sub);
     
-    auto submitBatch = [&]() {
-        if (batchVerts.empty() || !bgfx::isValid(currentTexture)) return;
+    if (m_depthTest) {
+        // Opaque draws go first, nearest first, so whatever they cover
+        // (opaque or not) fails the depth test instead of being shaded
+        float model[16];
+        bx::mtxTranslate(model, 0.0f, 0.0f, drawDepth(order, sub));
+        encoder->setTransform(model);
         
-        const uint32_t numVerts = (uint32_t)batchVerts.size();
+        state |= BGFX_STATE_DEPTH_TEST_LEQUAL;
+        if (blend == BlendMode::Opaque) {
+            state |= BGFX_STATE_WRITE_Z;
+            key = opaqueKey(order, sub);
+        } else {
+            key |= TRANSLUCENT_KEYS;
+        }
+    }
+    
+    encoder->setState(state);
+    encoder->submit(m_viewId, program, key);
+}
+
+void SpriteBatch::reserveStream() {
+    m_streamVerts = nullptr;
+    m_streamCapacity = 0;
+    m_streamCount = 0;
+    
+    // Take as much of the batch size as the transient pool can give us
+    if (m_geometry == Geometry::Instanced) {
+        const uint16_t stride = (uint16_t)sizeof(SpriteInstance);
+        const uint32_t count = bgfx::getAvailInstanceDataBuffer(m_maxSprites, stride);
+        if (count == 0) {
+            std::fprintf(stderr, "SpriteBatch: Not enough instance data space\n");
+            return;
+        }
         
-        // Check transient buffer availability
+        bgfx::allocInstanceDataBuffer(&m_instanceBuffer, count, stride);
+        m_streamVerts = m_instanceBuffer.data;
+        m_streamCapacity = count;
+        return;
+    }
+    
+    const bgfx::VertexLayout& layout = vertexLayout();
+    const uint32_t quads = bgfx::getAvailTransientVertexBuffer(m_maxSprites * 4, layout) / 4;
+    if (quads == 0) {
+        std::fprintf(stderr, "SpriteBatch: Not enough transient VB space\n");
+        return;
+    }
+    
+    bgfx::allocTransientVertexBuffer(&m_streamTvb, quads * 4, layout);
+    m_streamVerts = m_streamTvb.data;
+    m_streamCapacity = quads;
+}
+
+void SpriteBatch::flushStream() {
+    PROFILE_SCOPE(SpriteFlush);
+    
+    // Gradient quads get their own small buffer in the plain sprite layout
+    bgfx::TransientVertexBuffer gradientTvb;
+    bool haveGradients = false;
+    if (!m_gradientVerts.empty()) {
+        const bgfx::VertexLayout& layout = SpriteVertex::getLayout();
+        const uint32_t numVerts = (uint32_t)m_gradientVerts.size();
         if (bgfx::getAvailTransientVertexBuffer(numVerts, layout) < numVerts) {
             std::fprintf(stderr, "SpriteBatch: Not enough transient VB space\n");
-            return;
+        } else {
+            bgfx::allocTransientVertexBuffer(&gradientTvb, numVerts, layout);
+            std::memcpy(gradientTvb.data, m_gradientVerts.data(), numVerts * sizeof(SpriteVertex));
+            haveGradients = true;
+        }
+    }
+    
+    bgfx::Encoder* encoder = bgfx::begin();
+    for (const DrawRun& run : m_runs) {
+        if (run.tileGrid >= 0) {
+            submitTileGrid(encoder, m_tileGridDraws[run.tileGrid], run.order);
+        } else if (!run.gradient) {
+            submitRun(encoder, run, &m_streamTvb);
+        } else if (haveGradients) {
+            submitRun(encoder, run, &gradientTvb);
+        } else {
+            continue;
         }
-        
-        bgfx::TransientVertexBuffer tvb;
-        bgfx::allocTransientVertexBuffer(&tvb, numVerts, layout);
-        std::memcpy(tvb.data, batchVerts.data(), numVerts * sizeof(SpriteVertex));
-        
-        bgfx::setVertexBuffer(0, &tvb);
-        
-        // Set texture with point sampling (pixel art) and clamping
-        const uint32_t samplerFlags =
-            BGFX_SAMPLER_MIN_POINT |
-            BGFX_SAMPLER_MAG_POINT |
-            BGFX_SAMPLER_MIP_POINT |
-            BGFX_SAMPLER_U_CLAMP |
-            BGFX_SAMPLER_V_CLAMP;
-        
-        bgfx::setTexture(0, m_texUniform, currentTexture, samplerFlags);
-        
-        // Enable alpha blending
-        bgfx::setState(
-            BGFX_STATE_WRITE_RGB |
-            BGFX_STATE_WRITE_A |
-            BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_SRC_ALPHA, BGFX_STATE_BLEND_INV_SRC_ALPHA)
-        );
-        
-        bgfx::submit(m_viewId, m_program);
-        
         m_stats.drawCalls++;
-        batchVerts.clear();
-    };
+    }
+    bgfx::end(encoder);
+    m_stats.spriteCount += m_streamCount + (uint32_t)(m_gradientVerts.size() / 4);
     
+    // The reserved buffer is consumed; the next draw reserves a fresh one
+    m_runs.clear();
+    m_gradientVerts.clear();
+    m_tileGridDraws.clear();
+    m_streamVerts = nullptr;
+    m_streamCapacity = 0;
+    m_streamCount = 0;
+}
+
+void SpriteBatch::flush() {
+    if (m_sprites.empty()) return;
+    PROFILE_SCOPE(SpriteFlush);
+    
+    // Back to front by layer and depth, reordered by texture only where
+    // painter's order can't tell the difference
+    const uint32_t spriteCount = (uint32_t)m_sprites.size();
+    const uint32_t* order = sortQueue();
+    
+    // Gradients keep float vertices (u carries the band count) in a buffer
+    // of their own; everything else goes to one buffer in the GPU layout
+    uint32_t gradientCount = 0;
     for (const SpriteItem& sprite : m_sprites) {
-        // Texture changed? Flush current batch
-        if (sprite.texture.idx != currentTexture.idx) {
-            submitBatch();
-            currentTexture = sprite.texture;
-            m_stats.textureSwaps++;
+        if (!bgfx::isValid(sprite.texture)) gradientCount++;
+    }
+    const uint32_t quadCount = spriteCount - gradientCount;
+    
+    const bgfx::VertexLayout& layout = vertexLayout();
+    const bgfx::VertexLayout& gradientLayout = SpriteVertex::getLayout();
+    bgfx::TransientVertexBuffer tvb{};
+    bgfx::TransientVertexBuffer gradientTvb{};
+    if (bgfx::getAvailTransientVertexBuffer(quadCount * 4, layout) < quadCount * 4) {
+        std::fprintf(stderr, "SpriteBatch: Not enough transient VB space\n");
+        m_sprites.clear();
+        return;
+    }
+    if (quadCount > 0) {
+        bgfx::allocTransientVertexBuffer(&tvb, quadCount * 4, layout);
+    }
+    if (bgfx::getAvailTransientVertexBuffer(gradientCount * 4, gradientLayout) < gradientCount * 4) {
+        std::fprintf(stderr, "SpriteBatch: Not enough transient VB space\n");
+        m_sprites.clear();
+        return;
+    }
+    if (gradientCount > 0) {
+        bgfx::allocTransientVertexBuffer(&gradientTvb, gradientCount * 4, gradientLayout);
+    }
+    
+    bgfx::Encoder* encoder = bgfx::begin();
+    
+    DrawRun run;
+    run.firstQuad = 0;
+    run.quadCount = 0;
+    run.textureCount = 0;
+    run.order = m_nextOrder++;
+    uint32_t written = 0;         // Sprites written to tvb so far
+    uint32_t gradientsWritten = 0; // Gradients written to gradientTvb so far
+    
+    auto submit = [&]() {
+        submitRun(encoder, run, run.gradient ? &gradientTvb : &tvb);
+        m_stats.drawCalls++;
+    };
+    auto startRun = [&](bool gradient, BlendMode blend) {
+        if (run.quadCount > 0) {
+            submit();
+            run.order = m_nextOrder++;
         }
+        run.firstQuad = gradient ? gradientsWritten : written;
+        run.quadCount = 0;
+        run.textureCount = 0;
+        run.gradient = gradient;
+        run.blend = blend;
+    };
+    
+    // One loop per vertex layout, so converting a quad doesn't branch on it
+    withGpuVertex([&](auto* type) {
+        using Vertex = std::remove_pointer_t<decltype(type)>;
         
-        // Convert quad (4 verts) to 2 triangles (6 verts)
-        // Triangle 1: TL, TR, BL
-        // Triangle 2: TR, BR, BL
-        batchVerts.push_back(sprite.vertices[0]); // TL
-        batchVerts.push_back(sprite.vertices[1]); // TR
-        batchVerts.push_back(sprite.vertices[2]); // BL
+        for (uint32_t n = 0; n < spriteCount; ++n) {
+            const SpriteItem& sprite = m_sprites[order[n]];
+            
+            // Gradients and sprites never share a run, nor do blend modes
+            const bool gradient = !bgfx::isValid(sprite.texture);
+            const BlendMode blend = keyBlend(sprite.key);
+            if (gradient != run.gradient || blend != run.blend) {
+                startRun(gradient, blend);
+            }
+            
+            // 4 verts per quad; the index buffer supplies the two triangles
+            if (gradient) {
+                SpriteVertex* dst = reinterpret_cast<SpriteVertex*>(gradientTvb.data) + gradientsWritten * 4;
+                std::memcpy(dst, sprite.vertices, sizeof(sprite.vertices));
+                gradientsWritten++;
+            } else {
+                // Texture not in the run and no free slot? Submit and start a new run
+                int slot = bindSlot(run, sprite.texture);
+                if (slot < 0) {
+                    startRun(false, blend);
+                    slot = bindSlot(run, sprite.texture);
+                }
+                
+                convertQuad(reinterpret_cast<Vertex*>(tvb.data) + written * 4, sprite.vertices, (float)slot);
+                written++;
+            }
+            run.quadCount++;
+            
+            m_stats.spriteCount++;
+        }
+    });
+    
+    // Flush remaining
+    if (run.quadCount > 0) {
+        submit();
+    }
+    bgfx::end(encoder);
+    
+    m_sprites.clear();
+}
+
+// Stable LSD radix sort of order[] by the low `digits` bytes of keys[]
+// (kept alongside), one byte per pass. Bytes every key shares are skipped,
+// so a single layer and a few thousand sprites take two passes.
+static void radixSort(uint64_t* keys, uint32_t* order, uint32_t count,
+                      uint32_t digits, FrameArena& arena) {
+    constexpr uint32_t MAX_DIGITS = 8;
+    digits = std::min(digits, MAX_DIGITS);
+    
+    // All histograms in one read of the keys
+    uint32_t counts[MAX_DIGITS][256] = {};
+    for (uint32_t i = 0; i < count; ++i) {
+        for (uint32_t d = 0; d < digits; ++d) {
+            counts[d][(keys[i] >> (d * 8)) & 0xFF]++;
+        }
+    }
+    
+    uint64_t* srcKeys = keys;
+    uint32_t* src = order;
+    uint64_t* dstKeys = arena.allocateArray<uint64_t>(count);
+    uint32_t* dst = arena.allocateArray<uint32_t>(count);
+    
+    for (uint32_t d = 0; d < digits; ++d) {
+        const uint32_t shift = d * 8;
+        uint32_t* offsets = counts[d];
+        if (offsets[(srcKeys[0] >> shift) & 0xFF] == count) continue;
         
-        batchVerts.push_back(sprite.vertices[1]); // TR
-        batchVerts.push_back(sprite.vertices[3]); // BR
-        batchVerts.push_back(sprite.vertices[2]); // BL
+        uint32_t sum = 0;
+        for (uint32_t b = 0; b < 256; ++b) {
+            const uint32_t c = offsets[b];
+            offsets[b] = sum;
+            sum += c;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t slot = offsets[(srcKeys[i] >> shift) & 0xFF]++;
+            dstKeys[slot] = srcKeys[i];
+            dst[slot] = src[i];
+        }
+        std::swap(srcKeys, dstKeys);
+        std::swap(src, dst);
+    }
+    
+    if (src != order) {
+        std::memcpy(order, src, count * sizeof(uint32_t));
+    }
+}
+
+const uint32_t* SpriteBatch::sortQueue() const {
+    const uint32_t count = (uint32_t)m_sprites.size();
+    FrameArena& arena = FrameArena::get();
+    uint32_t* order = arena.allocateArray<uint32_t>(count);
+    std::iota(order, order + count, 0u);
+    
+    // Layer and depth decide painter's order. Depth grows with submission
+    // order, so the queue is already sorted unless layers go backwards
+    uint64_t* keys = arena.allocateArray<uint64_t>(count);
+    bool sorted = true;
+    for (uint32_t i = 0; i < count; ++i) {
+        keys[i] = m_sprites[i].key >> KEY_ORDER_SHIFT;
+        sorted = sorted && (i == 0 || keys[i - 1] <= keys[i]);
+    }
+    if (!sorted) {
+        radixSort(keys, order, count, (64 - KEY_ORDER_SHIFT) / 8, arena);
+    }
+    
+    reorderGroups(order, count);
+    return order;
+}
+
+// Longest stretch of sprites reorderGroups() sorts together
+static constexpr uint32_t MAX_REORDER_GROUP = 32;
+
+void SpriteBatch::reorderGroups(uint32_t* order, uint32_t count) const {
+    // Sprites that overlap none of their neighbours look the same in any
+    // order, so each stretch of pairwise disjoint sprites is sorted by blend
+    // state and texture (insertion sort keeps ties in painter's order)
+    auto sortGroup = [this](uint32_t* group, uint32_t size) {
+        for (uint32_t i = 1; i < size; ++i) {
+            const uint32_t index = group[i];
+            const uint64_t state = m_sprites[index].key & KEY_STATE_MASK;
+            uint32_t j = i;
+            for (; j > 0 && (m_sprites[group[j - 1]].key & KEY_STATE_MASK) > state; --j) {
+                group[j] = group[j - 1];
+            }
+            group[j] = index;
+        }
+    };
+    
+    struct Bounds {
+        float x0, y0, x1, y1;
+    };
+    Bounds bounds[MAX_REORDER_GROUP];
+    uint32_t groupStart = 0;
+    uint32_t groupSize = 0;
+    
+    for (uint32_t n = 0; n < count; ++n) {
+        const SpriteVertex* v = m_sprites[order[n]].vertices;
+        Bounds b = { v[0].x, v[0].y, v[0].x, v[0].y };
+        for (int i = 1; i < 4; ++i) {
+            b.x0 = std::min(b.x0, v[i].x);
+            b.y0 = std::min(b.y0, v[i].y);
+            b.x1 = std::max(b.x1, v[i].x);
+            b.y1 = std::max(b.y1, v[i].y);
+        }
         
-        m_stats.spriteCount++;
+        // Sharing an edge isn't overlapping
+        bool disjoint = groupSize < MAX_REORDER_GROUP;
+        for (uint32_t i = 0; disjoint && i < groupSize; ++i) {
+            const Bounds& o = bounds[i];
+            disjoint = b.x1 <= o.x0 || b.x0 >= o.x1 || b.y1 <= o.y0 || b.y0 >= o.y1;
+        }
+        if (!disjoint) {
+            sortGroup(order + groupStart, groupSize);
+            groupStart = n;
+            groupSize = 0;
+        }
+        bounds[groupSize++] = b;
+    }
+    sortGroup(order + groupStart, groupSize);
+}
+
+uint32_t SpriteBatch::reserveRecorders(uint32_t count) {
+    if (!m_begun) {
+        std::fprintf(stderr, "SpriteBatch: reserveRecorders() called outside begin()/end()\n");
+        return 0;
     }
     
-    // Flush remaining
-    submitBatch();
+    // Queued sprites take their positions at flush(), so give them theirs now;
+    // streamed runs already have one and only need closing
+    if (!streams()) flush();
+    m_closeRun = true;
     
-    m_sprites.clear();
+    const uint32_t first = m_nextOrder;
+    m_nextOrder += count;
+    return first;
+}
+
+void SpriteBatch::merge(Recorder& recorder) {
+    if (recorder.m_batch != this) return;
+    
+    // Left over when the recording thread got no encoder
+    if (!recorder.m_runs.empty()) {
+        bgfx::Encoder* encoder = bgfx::begin();
+        for (size_t i = 0; i < recorder.m_runs.size(); ++i) {
+            submitRun(encoder, recorder.m_runs[i], &recorder.m_tvb, (uint32_t)i);
+            recorder.m_stats.drawCalls++;
+        }
+        bgfx::end(encoder);
+        recorder.m_runs.clear();
+    }
+    
+    m_stats.spriteCount += recorder.m_stats.spriteCount;
+    m_stats.drawCalls += recorder.m_stats.drawCalls;
+    m_stats.textureSwaps += recorder.m_stats.textureSwaps;
+    m_stats.culledSprites += recorder.m_stats.culledSprites;
+    recorder.m_batch = nullptr;
+}
+
+// -------------------------
+// Recorder
+// -------------------------
+
+bool SpriteBatch::Recorder::begin(const SpriteBatch& batch, uint32_t order, uint32_t maxSprites) {
+    if (m_recording) {
+        std::fprintf(stderr, "SpriteBatch: Recorder begin() called without end()\n");
+        return false;
+    }
+    
+    m_batch = &batch;
+    m_recording = true;
+    m_order = order;
+    m_alpha = batch.m_alpha;
+    m_blend = batch.drawBlend();
+    m_cullRect = batch.m_cullRect;
+    m_stride = 0;
+    m_capacity = 0;
+    m_count = 0;
+    m_dropped = 0;
+    m_runs.clear();
+    m_stats = Stats{};
+    
+    if (!batch.m_begun || !batch.supportsRecorders()) return false;
+    
+    // Runs index the batch's quad index buffer, which holds maxSprites quads
+    maxSprites = std::min(maxSprites, batch.m_maxSprites);
+    if (maxSprites == 0) return true;
+    
+    // Transient allocation is thread safe; another recorder may take space
+    // between these two calls, so the granted size is read back
+    const bgfx::VertexLayout& layout = batch.vertexLayout();
+    const uint32_t quads = bgfx::getAvailTransientVertexBuffer(maxSprites * 4, layout) / 4;
+    if (quads > 0) {
+        bgfx::allocTransientVertexBuffer(&m_tvb, quads * 4, layout);
+        m_stride = layout.getStride();
+        m_capacity = m_tvb.size / (m_stride * 4);
+    }
+    if (m_capacity == 0) {
+        std::fprintf(stderr, "SpriteBatch: Not enough transient VB space for recorder\n");
+        return false;
+    }
+    return true;
+}
+
+void SpriteBatch::Recorder::draw(const TextureHandle& texture, float x, float y,
+                                 float width, float height, Color color) {
+    if (!texture.isValid()) return;
+    emitQuad(texture.texture, x, y, width, height,
+             texture.u0, texture.v0, texture.u1, texture.v1, color.toABGR());
+}
+
+void SpriteBatch::Recorder::drawRegion(const TextureHandle& texture, float x, float y,
+                                       float dstWidth, float dstHeight, const Rect& srcRect,
+                                       Color color) {
+    if (!texture.isValid()) return;
+    
+    float u0, v0, u1, v1;
+    regionUVs(texture, srcRect, u0, v0, u1, v1);
+    emitQuad(texture.texture, x, y, dstWidth, dstHeight, u0, v0, u1, v1, color.toABGR());
+}
+
+void SpriteBatch::Recorder::emitQuad(bgfx::TextureHandle texture,
+                                     float x, float y, float width, float height,
+                                     float u0, float v0, float u1, float v1,
+                                     uint32_t color) {
+    if (!m_recording) return;
+    if (isCulled(m_cullRect, x, y, width, height, 0.0f, 0.0f, 0.0f)) {
+        m_stats.culledSprites++;
+        return;
+    }
+    if (m_count >= m_capacity) {
+        m_dropped++;
+        return;
+    }
+    
+    // Same run rules as the batch's stream: a new run once the slots are full
+    int slot = m_runs.empty() ? -1
+        : m_runs.back().bind(texture, m_batch->m_slotCount, m_stats.textureSwaps);
+    if (slot < 0) {
+        DrawRun& run = m_runs.emplace_back();
+        run.firstQuad = m_count;
+        run.quadCount = 0;
+        run.textureCount = 0;
+        run.blend = m_blend;
+        run.order = m_order;
+        slot = run.bind(texture, m_batch->m_slotCount, m_stats.textureSwaps);
+    }
+    m_runs.back().quadCount++;
+    
+    if (m_alpha != 255) color = fadeColor(color, m_alpha, m_blend);
+    
+    const float x1 = x + width, y1 = y + height;
+    const float corners[4][2] = { { x, y }, { x1, y }, { x, y1 }, { x1, y1 } };
+    uint8_t* dst = m_tvb.data + (size_t)(m_count++) * m_stride * 4;
+    m_batch->writeGpuQuad(dst, corners, 0.0f, u0, v0, u1, v1, color, (float)slot);
+}
+
+void SpriteBatch::Recorder::end() {
+    if (!m_recording) {
+        std::fprintf(stderr, "SpriteBatch: Recorder end() called without begin()\n");
+        return;
+    }
+    m_recording = false;
+    
+    if (m_dropped > 0) {
+        std::fprintf(stderr, "SpriteBatch: Recorder full, dropped %u sprites\n", m_dropped);
+    }
+    m_stats.spriteCount = m_count;
+    if (m_runs.empty()) return;
+    
+    // Run i of the recorder sorts as sub-position i of its order
+    bgfx::Encoder* encoder = bgfx::begin(true);
+    if (!encoder) return; // merge() submits them
+    
+    for (size_t i = 0; i < m_runs.size(); ++i) {
+        m_batch->submitRun(encoder, m_runs[i], &m_tvb, (uint32_t)i);
+        m_stats.drawCalls++;
+    }
+    bgfx::end(encoder);
+    m_runs.clear();
 }
@@ -13,29 +13,177 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include "ThreadPool.h"
+#include "PixelConvert.h"
+
 #include <cstdio>
 #include <cstring>
 #include <cmath>
+#include <climits>
+#include <atomic>
+#include <bit>
+
+// Cooked cache layout (little-endian, written by writeCookedCache):
+//   CookedHeader
+//   CookedEntry[entryCount]
+//   Name bytes (not terminated)
+//   Payloads, 16-byte aligned, BGRA8 rows (width * height * 4 bytes)
+static constexpr char COOKED_MAGIC[4] = { 'P', 'X', 'C', 'K' };
+static constexpr uint32_t COOKED_VERSION = 1;
+static constexpr uint32_t COOKED_FORMAT_BGRA8 = 0;
+static constexpr uint64_t COOKED_ALIGN = 16;
+
+// Sheets at least this big generate their frames in parallel
+static constexpr size_t PARALLEL_SHEET_PIXELS = 16 * 1024;
+
+static_assert(std::endian::native == std::endian::little,
+              "Sheet generation writes 0xAARRGGBB words as BGRA bytes");
+
+struct CookedHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct CookedEntry {
+    uint64_t contentHash;
+    uint64_t dataOffset;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint16_t width;
+    uint16_t height;
+    uint32_t format;
+};
+
+static_assert(sizeof(CookedHeader) == 16, "CookedHeader layout is part of the file format");
+static_assert(sizeof(CookedEntry) == 32, "CookedEntry layout is part of the file format");
+
+// FNV-1a, used for cooked content hashes
+static constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+
+static uint64_t fnv1a(const void* data, size_t size, uint64_t hash = FNV_OFFSET) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static bool hashFile(const std::string& path, uint64_t& outHash) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    
+    uint8_t buffer[64 * 1024];
+    uint64_t hash = FNV_OFFSET;
+    size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        hash = fnv1a(buffer, read, hash);
+    }
+    std::fclose(file);
+    
+    outHash = hash;
+    return true;
+}
+
+// Version of the built-in pattern behind createTestSpriteSheet(colors)
+static constexpr uint32_t TEST_PATTERN_VERSION = 1;
+
+// Generated sheets are keyed by their parameters and generator version
+static uint64_t sheetHash(uint16_t frameWidth, uint16_t frameHeight, int frameCount, uint32_t version,
+                          const std::vector<uint32_t>* colors) {
+    const uint32_t params[4] = { frameWidth, frameHeight, (uint32_t)frameCount, version };
+    uint64_t hash = fnv1a(params, sizeof(params));
+    if (colors) {
+        hash = fnv1a("colors", 6, hash);
+        if (!colors->empty()) hash = fnv1a(colors->data(), colors->size() * sizeof(uint32_t), hash);
+    }
+    return hash;
+}
+
+// Shared with decode jobs; outlives the manager if a job is still running
+struct TextureManager::AsyncState {
+    std::mutex mutex;
+    std::deque<DecodedImage> decoded;
+    std::atomic<bool> cancelled{false};
+};
+
+TextureManager::TextureManager() = default;
 
 TextureManager::~TextureManager() {
+    if (m_async) {
+        m_async->cancelled = true;
+    }
+    m_loader.reset(); // Joins workers (cancelled jobs return immediately)
     clear();
 }
 
 TextureManager::TextureManager(TextureManager&& other) noexcept
     : m_cache(std::move(other.m_cache))
+    , m_hotReload(other.m_hotReload)
+    , m_atlasEnabled(other.m_atlasEnabled)
+    , m_atlasPageSize(other.m_atlasPageSize)
+    , m_atlasMaxEntry(other.m_atlasMaxEntry)
+    , m_pages(std::move(other.m_pages))
+    , m_loader(std::move(other.m_loader))
+    , m_async(std::move(other.m_async))
+    , m_pending(std::move(other.m_pending))
+    , m_cookedFile(std::move(other.m_cookedFile))
+    , m_cookedEntries(std::move(other.m_cookedEntries))
+    , m_cookRecording(other.m_cookRecording)
+    , m_cookList(std::move(other.m_cookList))
 {
     other.m_cache.clear();
+    other.m_pages.clear();
+    other.m_pending.clear();
+    other.m_cookedEntries.clear();
+    other.m_cookList.clear();
 }
 
 TextureManager& TextureManager::operator=(TextureManager&& other) noexcept {
     if (this != &other) {
         clear();
         m_cache = std::move(other.m_cache);
+        m_hotReload = other.m_hotReload;
+        m_atlasEnabled = other.m_atlasEnabled;
+        m_atlasPageSize = other.m_atlasPageSize;
+        m_atlasMaxEntry = other.m_atlasMaxEntry;
+        m_pages = std::move(other.m_pages);
+        m_loader = std::move(other.m_loader);
+        m_async = std::move(other.m_async);
+        m_pending = std::move(other.m_pending);
+        m_cookedFile = std::move(other.m_cookedFile);
+        m_cookedEntries = std::move(other.m_cookedEntries);
+        m_cookRecording = other.m_cookRecording;
+        m_cookList = std::move(other.m_cookList);
         other.m_cache.clear();
+        other.m_pages.clear();
+        other.m_pending.clear();
+        other.m_cookedEntries.clear();
+        other.m_cookList.clear();
     }
     return *this;
 }
 
+void TextureManager::enableAtlas(uint16_t pageSize, uint16_t maxEntrySize) {
+    const bgfx::Caps* caps = bgfx::getCaps();
+    if (caps && pageSize > caps->limits.maxTextureSize) {
+        pageSize = (uint16_t)caps->limits.maxTextureSize;
+    }
+    
+    // Leave room for the extruded border
+    if (maxEntrySize > pageSize - 2) {
+        maxEntrySize = pageSize - 2;
+    }
+    
+    m_atlasEnabled = true;
+    m_atlasPageSize = pageSize;
+    m_atlasMaxEntry = maxEntrySize;
+    
+    std::printf("TextureManager: Atlas enabled (%ux%u pages, entries up to %upx)\n",
+                pageSize, pageSize, maxEntrySize);
+}
+
 TextureHandle TextureManager::load(const std::string& path) {
     // Check cache first
     auto it = m_cache.find(path);
@@ -43,6 +191,14 @@ TextureHandle TextureManager::load(const std::string& path) {
         return it->second;
     }
     
+    // Cooked cache: no decode when the source is unchanged (or not shipped)
+    if (!m_cookedEntries.empty()) {
+        uint64_t contentHash;
+        const bool haveSource = hashFile(path, contentHash);
+        TextureHandle cooked = createFromCooked(path, haveSource ? &contentHash : nullptr);
+        if (cooked.isValid()) return cooked;
+    }
+    
     // Load image with stb_image
     int width, height, channels;
     
@@ -57,43 +213,183 @@ TextureHandle TextureManager::load(const std::string& path) {
     }
     
     // Convert RGBA to BGRA for bgfx (Metal prefers BGRA)
-    const size_t pixelCount = (size_t)width * (size_t)height;
-    for (size_t i = 0; i < pixelCount; ++i) {
-        unsigned char* p = pixels + i * 4;
-        std::swap(p[0], p[2]); // Swap R and B
+    PixelConvert::swapRedBlue(pixels, (size_t)width * (size_t)height);
+    
+    if (m_cookRecording) {
+        uint64_t contentHash;
+        if (hashFile(path, contentHash)) {
+            recordCooked(path, contentHash, (uint16_t)width, (uint16_t)height, pixels);
+        }
     }
     
-    // Create bgfx texture
-    const bgfx::Memory* mem = bgfx::copy(pixels, (uint32_t)(width * height * 4));
+    TextureHandle handle = createTexture(path, (uint16_t)width, (uint16_t)height, pixels);
     stbi_image_free(pixels);
     
-    bgfx::TextureHandle tex = bgfx::createTexture2D(
-        (uint16_t)width,
-        (uint16_t)height,
-        false,  // no mipmaps (pixel art looks better without)
-        1,      // single layer
-        bgfx::TextureFormat::BGRA8,
-        BGFX_TEXTURE_NONE,  // flags set at sample time
-        mem
-    );
+    if (handle.isValid()) {
+        std::printf("TextureManager: Loaded '%s' (%dx%d%s)\n", path.c_str(), width, height,
+                    handle.isAtlased() ? ", atlased" : "");
+    }
     
-    if (!bgfx::isValid(tex)) {
-        std::fprintf(stderr, "TextureManager: Failed to create texture for '%s'\n", path.c_str());
-        return TextureHandle{};
+    return handle;
+}
+
+TextureHandle TextureManager::loadAsync(const std::string& path, LoadCallback onLoaded) {
+    // Already loaded (or loading): hand out the same handle
+    auto it = m_cache.find(path);
+    if (it != m_cache.end()) {
+        auto pending = m_pending.find(path);
+        if (pending != m_pending.end()) {
+            if (onLoaded) pending->second.callbacks.push_back(std::move(onLoaded));
+        } else if (onLoaded) {
+            onLoaded(it->second);
+        }
+        return it->second;
     }
     
-    TextureHandle handle;
-    handle.texture = tex;
-    handle.width   = (uint16_t)width;
-    handle.height  = (uint16_t)height;
+    // Cooked entries are ready without a decode, unless the PNG changed since
+    // cooking: a stale entry decodes in the background like any other file
+    auto cooked = m_cookedEntries.find(path);
+    if (cooked != m_cookedEntries.end()) {
+        uint64_t contentHash;
+        const bool haveSource = hashFile(path, contentHash);
+        TextureHandle handle = createFromCooked(path, haveSource ? &contentHash : nullptr);
+        if (handle.isValid()) {
+            if (onLoaded) onLoaded(handle);
+            return handle;
+        }
+    }
+    
+    // Cooking records synchronously
+    if (m_cookRecording) {
+        TextureHandle handle = load(path);
+        if (onLoaded) onLoaded(handle);
+        return handle;
+    }
     
-    m_cache[path] = handle;
+    // Only the header is read here, so size and atlas placement are final
+    int width, height, channels;
+    if (!stbi_info(path.c_str(), &width, &height, &channels)) {
+        std::fprintf(stderr, "TextureManager: Failed to load '%s': %s\n",
+                     path.c_str(), stbi_failure_reason());
+        if (onLoaded) onLoaded(TextureHandle{});
+        return TextureHandle{};
+    }
+    
+    AtlasSlot slot;
+    TextureHandle handle = createTexture(path, (uint16_t)width, (uint16_t)height, nullptr, &slot);
+    if (!handle.isValid()) {
+        if (onLoaded) onLoaded(TextureHandle{});
+        return handle;
+    }
     
-    std::printf("TextureManager: Loaded '%s' (%dx%d)\n", path.c_str(), width, height);
+    PendingLoad& pending = m_pending[path];
+    pending.handle = handle;
+    pending.slot = slot;
+    if (onLoaded) pending.callbacks.push_back(std::move(onLoaded));
+    
+    // Decode and swizzle off-thread; processUploads() picks up the result
+    workers();
+    std::shared_ptr<AsyncState> state = m_async;
+    const bgfx::TextureHandle texture = handle.texture;
+    m_loader->submit([state, path, texture] {
+        if (state->cancelled) return;
+        
+        DecodedImage image;
+        image.path = path;
+        image.texture = texture;
+        image.pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 4);
+        if (image.pixels) {
+            PixelConvert::swapRedBlue(image.pixels, (size_t)image.width * (size_t)image.height);
+        }
+        
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->decoded.push_back(std::move(image));
+    });
     
     return handle;
 }
 
+ThreadPool& TextureManager::workers() {
+    if (!m_loader) {
+        m_loader = std::make_unique<ThreadPool>(WORKER_THREADS);
+        m_async = std::make_shared<AsyncState>();
+    }
+    return *m_loader;
+}
+
+void TextureManager::processUploads(uint32_t maxBytes) {
+    if (!m_async) return;
+    
+    uint32_t uploaded = 0;
+    for (;;) {
+        DecodedImage image;
+        {
+            std::lock_guard<std::mutex> lock(m_async->mutex);
+            if (m_async->decoded.empty()) break;
+            
+            // Always make progress, then stay within the byte budget
+            const DecodedImage& next = m_async->decoded.front();
+            const uint32_t bytes = (uint32_t)next.width * (uint32_t)next.height * 4;
+            if (uploaded > 0 && uploaded + bytes > maxBytes) break;
+            
+            image = std::move(m_async->decoded.front());
+            m_async->decoded.pop_front();
+            uploaded += bytes;
+        }
+        
+        // Dropped by unload()/clear() while decoding, or reloaded since
+        auto it = m_pending.find(image.path);
+        if (it == m_pending.end() || it->second.handle.texture.idx != image.texture.idx) {
+            if (image.pixels) stbi_image_free(image.pixels);
+            continue;
+        }
+        
+        PendingLoad pending = std::move(it->second);
+        m_pending.erase(it);
+        const TextureHandle& handle = pending.handle;
+        
+        if (!image.pixels || image.width != handle.width || image.height != handle.height) {
+            std::fprintf(stderr, "TextureManager: Failed to decode '%s'\n", image.path.c_str());
+            if (image.pixels) stbi_image_free(image.pixels);
+            for (LoadCallback& callback : pending.callbacks) callback(TextureHandle{});
+            continue;
+        }
+        
+        if (pending.slot.used) {
+            uploadToAtlas(handle.texture, pending.slot, handle.width, handle.height, image.pixels);
+            stbi_image_free(image.pixels);
+        } else {
+            // Hand the decoded buffer to bgfx without another copy
+            const bgfx::Memory* mem = bgfx::makeRef(
+                image.pixels, (uint32_t)handle.width * handle.height * 4,
+                [](void* ptr, void*) { stbi_image_free(ptr); });
+            bgfx::updateTexture2D(handle.texture, 0, 0, 0, 0, handle.width, handle.height, mem);
+        }
+        
+        std::printf("TextureManager: Loaded '%s' (%dx%d%s, async)\n", image.path.c_str(),
+                    image.width, image.height, handle.isAtlased() ? ", atlased" : "");
+        
+        for (LoadCallback& callback : pending.callbacks) callback(handle);
+    }
+}
+
+void TextureManager::waitForLoads() {
+    if (!m_loader) return;
+    
+    while (!m_pending.empty()) {
+        m_loader->waitIdle();
+        processUploads(UINT32_MAX);
+        
+        // Anything still pending has no decode job left (e.g. superseded)
+        bool queued;
+        {
+            std::lock_guard<std::mutex> lock(m_async->mutex);
+            queued = !m_async->decoded.empty();
+        }
+        if (!queued) break;
+    }
+}
+
 TextureHandle TextureManager::createSolidColor(const std::string& name, 
                                                 uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
     // Check cache first
@@ -105,70 +401,177 @@ TextureHandle TextureManager::createSolidColor(const std::string& name,
     // Create 1x1 BGRA pixel
     uint8_t pixel[4] = { b, g, r, a }; // BGRA order
     
-    const bgfx::Memory* mem = bgfx::copy(pixel, 4);
-    
-    bgfx::TextureHandle tex = bgfx::createTexture2D(
-        1, 1,
-        false, 1,
-        bgfx::TextureFormat::BGRA8,
-        BGFX_TEXTURE_NONE,
-        mem
-    );
-    
-    if (!bgfx::isValid(tex)) {
-        std::fprintf(stderr, "TextureManager: Failed to create solid color texture '%s'\n", name.c_str());
-        return TextureHandle{};
+    return createTexture(name, 1, 1, pixel);
+}
+
+TextureHandle TextureManager::createFromRGBA(const std::string& name, uint16_t width, uint16_t height, const uint8_t* pixels) {
+    // Check cache first
+    auto it = m_cache.find(name);
+    if (it != m_cache.end()) {
+        return it->second;
     }
     
+    // Convert RGBA to BGRA (scratch buffer is reused between calls)
+    const size_t pixelCount = (size_t)width * height;
+    m_convertScratch.resize(pixelCount * 4);
+    PixelConvert::swapRedBlue(pixels, m_convertScratch.data(), pixelCount);
+    
+    return createTexture(name, width, height, m_convertScratch.data());
+}
+
+TextureHandle TextureManager::createTexture(const std::string& name, uint16_t width, uint16_t height,
+                                            const uint8_t* bgra, AtlasSlot* outSlot,
+                                            bool referencePixels) {
     TextureHandle handle;
-    handle.texture = tex;
-    handle.width   = 1;
-    handle.height  = 1;
+    handle.width  = width;
+    handle.height = height;
     
+    AtlasSlot slot;
+    const bool fitsAtlas = m_atlasEnabled &&
+                           width <= m_atlasMaxEntry && height <= m_atlasMaxEntry;
+    
+    if (fitsAtlas && packIntoAtlas(width + 2, height + 2, handle.texture, slot.x, slot.y)) {
+        slot.used = true;
+        uploadToAtlas(handle.texture, slot, width, height, bgra);
+        
+        const float invPage = 1.0f / (float)m_atlasPageSize;
+        handle.u0 = (slot.x + 1) * invPage;
+        handle.v0 = (slot.y + 1) * invPage;
+        handle.u1 = (slot.x + 1 + width) * invPage;
+        handle.v1 = (slot.y + 1 + height) * invPage;
+    } else {
+        // Without pixels the texture stays mutable so the real image can be
+        // uploaded later; it starts out transparent. Hot reload keeps every
+        // texture mutable and uploads its pixels the same way.
+        const uint32_t size = (uint32_t)width * height * 4;
+        const bool updatable = !bgra || m_hotReload;
+        const bgfx::Memory* mem = nullptr;
+        if (!updatable) {
+            mem = referencePixels ? bgfx::makeRef(bgra, size) : bgfx::copy(bgra, size);
+        }
+        
+        handle.texture = bgfx::createTexture2D(
+            width,
+            height,
+            false,  // no mipmaps (pixel art looks better without)
+            1,      // single layer
+            bgfx::TextureFormat::BGRA8,
+            BGFX_TEXTURE_NONE,  // flags set at sample time
+            mem
+        );
+        
+        if (!bgfx::isValid(handle.texture)) {
+            std::fprintf(stderr, "TextureManager: Failed to create texture '%s'\n", name.c_str());
+            return TextureHandle{};
+        }
+        
+        if (bgra && updatable) {
+            bgfx::updateTexture2D(handle.texture, 0, 0, 0, 0, width, height, bgfx::copy(bgra, size));
+        } else if (!bgra) {
+            const bgfx::Memory* clear = bgfx::alloc(size);
+            std::memset(clear->data, 0, clear->size);
+            bgfx::updateTexture2D(handle.texture, 0, 0, 0, 0, width, height, clear);
+        }
+    }
+    
+    if (outSlot) *outSlot = slot;
     m_cache[name] = handle;
     
     return handle;
 }
 
-TextureHandle TextureManager::createFromRGBA(const std::string& name, uint16_t width, uint16_t height, const uint8_t* pixels) {
-    // Check cache first
-    auto it = m_cache.find(name);
-    if (it != m_cache.end()) {
-        return it->second;
+void TextureManager::uploadToAtlas(bgfx::TextureHandle page, const AtlasSlot& slot,
+                                   uint16_t width, uint16_t height, const uint8_t* bgra) {
+    // Upload into the page with a 1px border copied from the edge pixels
+    // (fully transparent when there are no pixels yet)
+    const uint32_t paddedW = width + 2u;
+    const uint32_t paddedH = height + 2u;
+    const bgfx::Memory* mem = bgfx::alloc(paddedW * paddedH * 4);
+    
+    if (!bgra) {
+        std::memset(mem->data, 0, mem->size);
+    } else {
+        for (uint32_t y = 0; y < paddedH; ++y) {
+            const uint32_t srcY = (y == 0) ? 0 : (y > height ? height - 1u : y - 1u);
+            const uint8_t* srcRow = bgra + (size_t)srcY * width * 4;
+            uint8_t* dstRow = mem->data + (size_t)y * paddedW * 4;
+            
+            std::memcpy(dstRow, srcRow, 4);                                     // Left
+            std::memcpy(dstRow + 4, srcRow, (size_t)width * 4);                 // Interior
+            std::memcpy(dstRow + (paddedW - 1) * 4, srcRow + (width - 1) * 4, 4); // Right
+        }
     }
     
-    // Convert RGBA to BGRA
-    std::vector<uint8_t> bgra(width * height * 4);
-    for (size_t i = 0; i < width * height; ++i) {
-        bgra[i * 4 + 0] = pixels[i * 4 + 2]; // B
-        bgra[i * 4 + 1] = pixels[i * 4 + 1]; // G
-        bgra[i * 4 + 2] = pixels[i * 4 + 0]; // R
-        bgra[i * 4 + 3] = pixels[i * 4 + 3]; // A
+    bgfx::updateTexture2D(page, 0, 0, slot.x, slot.y,
+                          (uint16_t)paddedW, (uint16_t)paddedH, mem);
+}
+
+bool TextureManager::packIntoAtlas(uint16_t w, uint16_t h, bgfx::TextureHandle& outPage,
+                                   uint16_t& outX, uint16_t& outY) {
+    for (AtlasPage& page : m_pages) {
+        if (allocateInPage(page, w, h, outX, outY)) {
+            outPage = page.texture;
+            return true;
+        }
     }
     
-    const bgfx::Memory* mem = bgfx::copy(bgra.data(), (uint32_t)bgra.size());
-    
-    bgfx::TextureHandle tex = bgfx::createTexture2D(
-        width, height,
+    // No room anywhere: start a new page (no initial data, filled by updates)
+    AtlasPage page;
+    page.texture = bgfx::createTexture2D(
+        m_atlasPageSize, m_atlasPageSize,
         false, 1,
         bgfx::TextureFormat::BGRA8,
-        BGFX_TEXTURE_NONE,
-        mem
+        BGFX_TEXTURE_NONE
     );
     
-    if (!bgfx::isValid(tex)) {
-        std::fprintf(stderr, "TextureManager: Failed to create texture '%s'\n", name.c_str());
-        return TextureHandle{};
+    if (!bgfx::isValid(page.texture)) {
+        std::fprintf(stderr, "TextureManager: Failed to create atlas page\n");
+        return false;
     }
     
-    TextureHandle handle;
-    handle.texture = tex;
-    handle.width   = width;
-    handle.height  = height;
+    m_pages.push_back(std::move(page));
+    std::printf("TextureManager: Created atlas page %zu\n", m_pages.size() - 1);
     
-    m_cache[name] = handle;
+    if (!allocateInPage(m_pages.back(), w, h, outX, outY)) {
+        return false;
+    }
+    outPage = m_pages.back().texture;
+    return true;
+}
+
+bool TextureManager::allocateInPage(AtlasPage& page, uint16_t w, uint16_t h,
+                                    uint16_t& outX, uint16_t& outY) {
+    const int pageSize = m_atlasPageSize;
+    
+    // Tightest existing shelf with horizontal room
+    AtlasShelf* best = nullptr;
+    for (AtlasShelf& shelf : page.shelves) {
+        if (shelf.height >= h && pageSize - shelf.cursorX >= w &&
+            (!best || shelf.height < best->height)) {
+            best = &shelf;
+        }
+    }
     
-    return handle;
+    // Don't bury a short image in a much taller shelf if a new one fits
+    const bool roomForShelf = pageSize - page.usedHeight >= h;
+    if (!best || (best->height > h * 2 && roomForShelf)) {
+        if (!roomForShelf) return false;
+        page.shelves.push_back({ page.usedHeight, h, 0 });
+        page.usedHeight += h;
+        best = &page.shelves.back();
+    }
+    
+    outX = best->cursorX;
+    outY = best->y;
+    best->cursorX += w;
+    return true;
+}
+
+bool TextureManager::isAtlasPage(bgfx::TextureHandle texture) const {
+    for (const AtlasPage& page : m_pages) {
+        if (page.texture.idx == texture.idx) return true;
+    }
+    return false;
 }
 
 // Helper: HSV to RGB
@@ -203,6 +606,12 @@ TextureHandle TextureManager::createTestSpriteSheet(
         return it->second;
     }
     
+    const uint64_t contentHash = sheetHash(frameWidth, frameHeight, frameCount, TEST_PATTERN_VERSION, &colors);
+#ifdef NDEBUG
+    TextureHandle cooked = createFromCooked(name, &contentHash);
+    if (cooked.isValid()) return cooked;
+#endif
+    
     uint16_t totalWidth = frameWidth * frameCount;
     std::vector<uint8_t> pixels(totalWidth * frameHeight * 4);
     
@@ -236,15 +645,23 @@ TextureHandle TextureManager::createTestSpriteSheet(
                 int diag = (x + y + frame * 4) % 16;
                 if (diag < 4) intensity *= 0.7f;
                 
-                pixels[idx + 0] = (uint8_t)(r * intensity);
+                pixels[idx + 0] = (uint8_t)(b * intensity);
                 pixels[idx + 1] = (uint8_t)(g * intensity);
-                pixels[idx + 2] = (uint8_t)(b * intensity);
+                pixels[idx + 2] = (uint8_t)(r * intensity);
                 pixels[idx + 3] = 255;
             }
         }
     }
     
-    return createFromRGBA(name, totalWidth, frameHeight, pixels.data());
+#ifndef NDEBUG
+    verifyCooked(name, contentHash, totalWidth, frameHeight, pixels.data());
+#endif
+    if (m_cookRecording) {
+        recordCooked(name, contentHash, totalWidth, frameHeight, pixels.data());
+    }
+    
+    // Written as BGRA already, no conversion pass needed
+    return createTexture(name, totalWidth, frameHeight, pixels.data());
 }
 
 TextureHandle TextureManager::createTestSpriteSheet(
@@ -252,7 +669,26 @@ TextureHandle TextureManager::createTestSpriteSheet(
     uint16_t frameWidth,
     uint16_t frameHeight,
     int frameCount,
+    uint32_t version,
     std::function<uint32_t(int frame, int x, int y)> generator
+) {
+    return createSpriteSheetFrames(name, frameWidth, frameHeight, frameCount, version,
+        [&generator, frameWidth, frameHeight](int frame, uint32_t* pixels, size_t stride) {
+            for (int y = 0; y < frameHeight; ++y) {
+                for (int x = 0; x < frameWidth; ++x) {
+                    pixels[(size_t)y * stride + x] = generator(frame, x, y);
+                }
+            }
+        });
+}
+
+TextureHandle TextureManager::createSpriteSheetFrames(
+    const std::string& name,
+    uint16_t frameWidth,
+    uint16_t frameHeight,
+    int frameCount,
+    uint32_t version,
+    const FrameGenerator& generator
 ) {
     // Check cache first
     auto it = m_cache.find(name);
@@ -260,26 +696,40 @@ TextureHandle TextureManager::createTestSpriteSheet(
         return it->second;
     }
     
-    uint16_t totalWidth = frameWidth * frameCount;
-    std::vector<uint8_t> pixels(totalWidth * frameHeight * 4);
-    
-    for (int frame = 0; frame < frameCount; ++frame) {
-        for (int y = 0; y < frameHeight; ++y) {
-            for (int x = 0; x < frameWidth; ++x) {
-                int px = frame * frameWidth + x;
-                int idx = (y * totalWidth + px) * 4;
-                
-                uint32_t color = generator(frame, x, y);
-                
-                pixels[idx + 0] = (color >> 16) & 0xFF; // R
-                pixels[idx + 1] = (color >> 8) & 0xFF;  // G
-                pixels[idx + 2] = color & 0xFF;         // B
-                pixels[idx + 3] = (color >> 24) & 0xFF; // A
-            }
+    // Debug builds generate anyway, to catch cooks older than the generator
+    const uint64_t contentHash = sheetHash(frameWidth, frameHeight, frameCount, version, nullptr);
+#ifdef NDEBUG
+    TextureHandle cooked = createFromCooked(name, &contentHash);
+    if (cooked.isValid()) return cooked;
+#endif
+    
+    // 0xAARRGGBB stored little-endian is BGRA in memory, so frames are
+    // written straight into the upload layout
+    const uint16_t totalWidth = frameWidth * frameCount;
+    std::vector<uint32_t> pixels((size_t)totalWidth * frameHeight);
+    
+    auto fillFrame = [&](size_t frame) {
+        generator((int)frame, pixels.data() + frame * frameWidth, totalWidth);
+    };
+    
+    // Frames are independent; spread bigger sheets over the worker pool
+    if (frameCount > 1 && pixels.size() >= PARALLEL_SHEET_PIXELS) {
+        workers().parallelFor((size_t)frameCount, fillFrame);
+    } else {
+        for (int frame = 0; frame < frameCount; ++frame) {
+            fillFrame((size_t)frame);
         }
     }
     
-    return createFromRGBA(name, totalWidth, frameHeight, pixels.data());
+    const uint8_t* bgra = reinterpret_cast<const uint8_t*>(pixels.data());
+#ifndef NDEBUG
+    verifyCooked(name, contentHash, totalWidth, frameHeight, bgra);
+#endif
+    if (m_cookRecording) {
+        recordCooked(name, contentHash, totalWidth, frameHeight, bgra);
+    }
+    
+    return createTexture(name, totalWidth, frameHeight, bgra);
 }
 
 TextureHandle TextureManager::get(const std::string& path) const {
@@ -290,21 +740,259 @@ TextureHandle TextureManager::get(const std::string& path) const {
     return TextureHandle{};
 }
 
+bool TextureManager::reload(const std::string& path, const std::string& sourcePath) {
+    auto it = m_cache.find(path);
+    if (it == m_cache.end() || m_pending.count(path)) return false;
+    
+    // Atlas pages are always updatable; standalone textures only with hot reload
+    const TextureHandle& handle = it->second;
+    const bool atlased = isAtlasPage(handle.texture);
+    if (!atlased && !m_hotReload) {
+        std::fprintf(stderr, "TextureManager: Can't reload '%s' without enableHotReload()\n", path.c_str());
+        return false;
+    }
+    
+    const std::string& file = sourcePath.empty() ? path : sourcePath;
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(file.c_str(), &width, &height, &channels, 4);
+    if (!pixels) {
+        std::fprintf(stderr, "TextureManager: Failed to reload '%s': %s\n",
+                     file.c_str(), stbi_failure_reason());
+        return false;
+    }
+    
+    // Handles carry the size (and atlas region), so only same-size images swap in place
+    if (width != handle.width || height != handle.height) {
+        std::fprintf(stderr, "TextureManager: '%s' changed size (%ux%u -> %dx%d), restart to reload it\n",
+                     path.c_str(), handle.width, handle.height, width, height);
+        stbi_image_free(pixels);
+        return false;
+    }
+    
+    PixelConvert::swapRedBlue(pixels, (size_t)width * (size_t)height);
+    
+    if (atlased) {
+        // Padded slot origin, one texel up-left of the image
+        AtlasSlot slot;
+        slot.x = (uint16_t)(std::lround(handle.u0 * m_atlasPageSize) - 1);
+        slot.y = (uint16_t)(std::lround(handle.v0 * m_atlasPageSize) - 1);
+        slot.used = true;
+        uploadToAtlas(handle.texture, slot, handle.width, handle.height, pixels);
+        stbi_image_free(pixels);
+    } else {
+        const bgfx::Memory* mem = bgfx::makeRef(
+            pixels, (uint32_t)handle.width * handle.height * 4,
+            [](void* ptr, void*) { stbi_image_free(ptr); });
+        bgfx::updateTexture2D(handle.texture, 0, 0, 0, 0, handle.width, handle.height, mem);
+    }
+    
+    std::printf("TextureManager: Reloaded '%s' (%dx%d%s)\n", path.c_str(), width, height,
+                atlased ? ", atlased" : "");
+    return true;
+}
+
 void TextureManager::unload(const std::string& path) {
     auto it = m_cache.find(path);
     if (it != m_cache.end()) {
-        if (bgfx::isValid(it->second.texture)) {
+        // Atlased images share their page; only standalone textures are destroyed
+        if (bgfx::isValid(it->second.texture) && !isAtlasPage(it->second.texture)) {
             bgfx::destroy(it->second.texture);
         }
         m_cache.erase(it);
+        m_pending.erase(path);
     }
 }
 
 void TextureManager::clear() {
     for (auto& [path, handle] : m_cache) {
-        if (bgfx::isValid(handle.texture)) {
+        if (bgfx::isValid(handle.texture) && !isAtlasPage(handle.texture)) {
             bgfx::destroy(handle.texture);
         }
     }
     m_cache.clear();
+    m_pending.clear();
+    
+    for (AtlasPage& page : m_pages) {
+        if (bgfx::isValid(page.texture)) {
+            bgfx::destroy(page.texture);
+        }
+    }
+    m_pages.clear();
+}
+
+// -------------------------
+// Cooked cache
+// -------------------------
+
+bool TextureManager::openCookedCache(const std::string& path) {
+    closeCookedCache();
+    
+    if (!m_cookedFile.open(path)) {
+        std::printf("TextureManager: No cooked cache at '%s'\n", path.c_str());
+        return false;
+    }
+    
+    const uint8_t* data = m_cookedFile.data();
+    const size_t size = m_cookedFile.size();
+    
+    CookedHeader header;
+    if (size < sizeof(header)) {
+        std::fprintf(stderr, "TextureManager: Cooked cache '%s' is truncated\n", path.c_str());
+        m_cookedFile.close();
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    
+    if (std::memcmp(header.magic, COOKED_MAGIC, sizeof(COOKED_MAGIC)) != 0 ||
+        header.version != COOKED_VERSION) {
+        std::fprintf(stderr, "TextureManager: Cooked cache '%s' has an unknown format (re-cook)\n",
+                     path.c_str());
+        m_cookedFile.close();
+        return false;
+    }
+    
+    const uint64_t tableEnd = sizeof(header) + (uint64_t)header.entryCount * sizeof(CookedEntry);
+    if (tableEnd > size) {
+        std::fprintf(stderr, "TextureManager: Cooked cache '%s' is truncated\n", path.c_str());
+        m_cookedFile.close();
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < header.entryCount; ++i) {
+        CookedEntry entry;
+        std::memcpy(&entry, data + sizeof(header) + (size_t)i * sizeof(entry), sizeof(entry));
+        
+        const uint64_t payload = (uint64_t)entry.width * entry.height * 4;
+        if (entry.format != COOKED_FORMAT_BGRA8 || entry.width == 0 || entry.height == 0 ||
+            (uint64_t)entry.nameOffset + entry.nameLength > size ||
+            entry.dataOffset + payload > size) {
+            std::fprintf(stderr, "TextureManager: Skipping bad cooked entry %u\n", i);
+            continue;
+        }
+        
+        CookedRecord record;
+        record.contentHash = entry.contentHash;
+        record.pixels = data + entry.dataOffset;
+        record.width = entry.width;
+        record.height = entry.height;
+        
+        const std::string name(reinterpret_cast<const char*>(data + entry.nameOffset), entry.nameLength);
+        m_cookedEntries[name] = record;
+    }
+    
+    std::printf("TextureManager: Cooked cache '%s' (%zu textures)\n", path.c_str(), m_cookedEntries.size());
+    return true;
+}
+
+void TextureManager::closeCookedCache() {
+    m_cookedEntries.clear();
+    m_cookedFile.close();
+}
+
+TextureHandle TextureManager::createFromCooked(const std::string& name, const uint64_t* contentHash) {
+    auto it = m_cookedEntries.find(name);
+    if (it == m_cookedEntries.end()) return TextureHandle{};
+    
+    const CookedRecord& record = it->second;
+    if (contentHash && *contentHash != record.contentHash) {
+        std::printf("TextureManager: Cooked '%s' is stale, rebuilding\n", name.c_str());
+        return TextureHandle{};
+    }
+    
+    // Standalone textures reference the mapping directly (no copy)
+    return createTexture(name, record.width, record.height, record.pixels, nullptr, true);
+}
+
+void TextureManager::setCookRecording(bool enabled) {
+    m_cookRecording = enabled;
+    if (!enabled) m_cookList.clear();
+}
+
+void TextureManager::recordCooked(const std::string& name, uint64_t contentHash,
+                                  uint16_t width, uint16_t height,
+                                  const uint8_t* bgra) {
+    CookedImage image;
+    image.name = name;
+    image.contentHash = contentHash;
+    image.width = width;
+    image.height = height;
+    image.bgra.assign(bgra, bgra + (size_t)width * height * 4);
+    
+    m_cookList.push_back(std::move(image));
+}
+
+void TextureManager::verifyCooked(const std::string& name, uint64_t contentHash,
+                                  uint16_t width, uint16_t height,
+                                  const uint8_t* bgra) const {
+    // A different key is already ignored; the same key with different pixels
+    // would be served as-is by release builds
+    auto it = m_cookedEntries.find(name);
+    if (it == m_cookedEntries.end() || it->second.contentHash != contentHash) return;
+    
+    const CookedRecord& record = it->second;
+    if (record.width != width || record.height != height ||
+        std::memcmp(record.pixels, bgra, (size_t)width * height * 4) != 0) {
+        std::fprintf(stderr, "TextureManager: Cooked '%s' is stale: its generator changed without a "
+                             "version bump (bump it and re-cook)\n", name.c_str());
+    }
+}
+
+bool TextureManager::writeCookedCache(const std::string& path) const {
+    auto align = [](uint64_t offset) { return (offset + COOKED_ALIGN - 1) & ~(COOKED_ALIGN - 1); };
+    
+    // Lay out names then payloads after the entry table
+    std::vector<CookedEntry> entries(m_cookList.size());
+    uint64_t offset = sizeof(CookedHeader) + entries.size() * sizeof(CookedEntry);
+    for (size_t i = 0; i < m_cookList.size(); ++i) {
+        entries[i].nameOffset = (uint32_t)offset;
+        entries[i].nameLength = (uint32_t)m_cookList[i].name.size();
+        offset += m_cookList[i].name.size();
+    }
+    for (size_t i = 0; i < m_cookList.size(); ++i) {
+        const CookedImage& image = m_cookList[i];
+        offset = align(offset);
+        entries[i].contentHash = image.contentHash;
+        entries[i].dataOffset = offset;
+        entries[i].width = image.width;
+        entries[i].height = image.height;
+        entries[i].format = COOKED_FORMAT_BGRA8;
+        offset += image.bgra.size();
+    }
+    
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::fprintf(stderr, "TextureManager: Failed to open '%s' for writing\n", path.c_str());
+        return false;
+    }
+    
+    CookedHeader header;
+    std::memcpy(header.magic, COOKED_MAGIC, sizeof(COOKED_MAGIC));
+    header.version = COOKED_VERSION;
+    header.entryCount = (uint32_t)entries.size();
+    header.reserved = 0;
+    
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (!entries.empty()) {
+        ok = ok && std::fwrite(entries.data(), sizeof(CookedEntry), entries.size(), file) == entries.size();
+    }
+    for (const CookedImage& image : m_cookList) {
+        ok = ok && std::fwrite(image.name.data(), 1, image.name.size(), file) == image.name.size();
+    }
+    
+    static const uint8_t zeros[COOKED_ALIGN] = {};
+    for (size_t i = 0; i < m_cookList.size() && ok; ++i) {
+        const long position = std::ftell(file);
+        const size_t padding = (size_t)(entries[i].dataOffset - (uint64_t)position);
+        ok = std::fwrite(zeros, 1, padding, file) == padding &&
+             std::fwrite(m_cookList[i].bgra.data(), 1, m_cookList[i].bgra.size(), file) == m_cookList[i].bgra.size();
+    }
+    
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok) {
+        std::fprintf(stderr, "TextureManager: Failed to write '%s'\n", path.c_str());
+        return false;
+    }
+    
+    std::printf("TextureManager: Cooked %zu textures into '%s'\n", m_cookList.size(), path.c_str());
+    return true;
 }
@@ -0,0 +1,112 @@
+/*
+ * ThreadPool.cpp
+ *
+ * Fixed-size worker pool implementation.
+ */
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) {
+        const unsigned hw = std::thread::hardware_concurrency();
+        threadCount = (hw > 1) ? hw - 1 : 1;
+    }
+
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_jobReady.notify_all();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_jobReady.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_jobs.empty() && m_running == 0; });
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+    if (count == 1 || m_workers.empty()) {
+        for (size_t i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    // Shared so helpers that start after everything finished exit cleanly
+    struct Progress {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto progress = std::make_shared<Progress>();
+
+    auto run = [progress, &body, count] {
+        size_t i;
+        while ((i = progress->next.fetch_add(1)) < count) {
+            body(i);
+            if (progress->done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(progress->mutex);
+                progress->finished.notify_all();
+            }
+        }
+    };
+
+    const size_t helpers = std::min(m_workers.size(), count - 1);
+    for (size_t h = 0; h < helpers; ++h) {
+        submit(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(progress->mutex);
+    progress->finished.wait(lock, [&] { return progress->done.load() == count; });
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobReady.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+
+            // Drain the queue before exiting so submitted work always runs
+            if (m_jobs.empty()) return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            m_running++;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_running--;
+            if (m_jobs.empty() && m_running == 0) {
+                m_idle.notify_all();
+            }
+        }
+    }
+}
@@ -4,250 +4,218 @@
  * Step 5: Added Scene and SceneManager for organizing game screens.
  * 
  * Architecture:
- *   - 640x360 offscreen canvas (pixel-perfect game rendering)
+ *   - Offscreen canvas, 640x360 by default (pixel-perfect game rendering)
  *   - SpriteBatch for efficient batched 2D drawing
  *   - Animation system for sprite sheet animations
  *   - Scene system for managing different game screens
- *   - Integer-scaled blit to window with letterboxing
+ *   - RenderPipeline: integer-scaled (or sharp bilinear) blit to the window,
+ *     or straight to the backbuffer at exact multiples
+ * 
+ * Command line:
+ *   --canvas WxH   Canvas size in pixels
+ *   --sharp        Sharp bilinear upscale (fills the window)
+ *   --renderer R   auto, vulkan, d3d12, d3d11, metal or noop
+ *   --hot-reload   Reload edited PNGs in assets and shaders while running
  * 
  * Controls:
  *   - SPACE or Click: Switch between scenes
+ *   - F1: Toggle profiler overlay
+ *   - F2 / F3: Toggle profiler capture (profile.csv / profile.json)
  *   - ESC: Quit
  */
 
 #include <SDL.h>
-#include <SDL_metal.h>
 
 #include <bgfx/bgfx.h>
-#include <bgfx/platform.h>
 
+#include "Platform.h"
+#include "HotReload.h"
 #include "TextureManager.h"
 #include "SpriteBatch.h"
 #include "Animation.h"
 #include "Scene.h"
 #include "SailingScene.h"
 #include "PortScene.h"
+#include "FrameArena.h"
+#include "Profiler.h"
+#include "LayerCache.h"
+#include "FixedTimestep.h"
+#include "JobSystem.h"
+#include "RenderPipeline.h"
 
 #include <cstdio>
 #include <cstdint>
-#include <cmath>
-#include <vector>
-#include <fstream>
+#include <cstring>
 #include <memory>
+#include <string>
 
 // -------------------------
 // Constants
 // -------------------------
-static constexpr uint32_t GAME_W = 640;
-static constexpr uint32_t GAME_H = 360;
-
-static constexpr uint16_t VIEW_GAME = 0;
-static constexpr uint16_t VIEW_BLIT = 1;
+static constexpr uint32_t MAX_CANVAS_SIZE = 4095; // Compact vertex positions clamp at 32767/8 px
 
-// -------------------------
-// File helpers
-// -------------------------
-static std::vector<uint8_t> readFileBytes(const char* path) {
-    std::ifstream f(path, std::ios::binary);
-    if (!f) return {};
-    f.seekg(0, std::ios::end);
-    const std::streamsize size = f.tellg();
-    f.seekg(0, std::ios::beg);
-    std::vector<uint8_t> data((size_t)size);
-    if (!f.read(reinterpret_cast<char*>(data.data()), size)) return {};
-    return data;
-}
+// Cached layers redraw on their own views, before the game view composites them
+static constexpr uint16_t VIEW_LAYERS = 0;
+static constexpr uint16_t VIEW_GAME = VIEW_LAYERS + LayerCache::DEFAULT_LAYERS;
+static constexpr uint16_t VIEW_BLIT = VIEW_GAME + 1;
 
-static bgfx::ShaderHandle loadShader(const char* path) {
-    auto bytes = readFileBytes(path);
-    if (bytes.empty()) {
-        std::fprintf(stderr, "Failed to read shader: %s\n", path);
-        return BGFX_INVALID_HANDLE;
-    }
-    const bgfx::Memory* mem = bgfx::copy(bytes.data(), (uint32_t)bytes.size());
-    return bgfx::createShader(mem);
-}
+static constexpr const char* COOKED_CACHE_PATH = "assets/textures.cooked";
 
-static bgfx::ProgramHandle loadProgram(const char* vsPath, const char* fsPath) {
-    bgfx::ShaderHandle vsh = loadShader(vsPath);
-    bgfx::ShaderHandle fsh = loadShader(fsPath);
-    if (!bgfx::isValid(vsh) || !bgfx::isValid(fsh)) {
-        if (bgfx::isValid(vsh)) bgfx::destroy(vsh);
-        if (bgfx::isValid(fsh)) bgfx::destroy(fsh);
-        return BGFX_INVALID_HANDLE;
-    }
-    return bgfx::createProgram(vsh, fsh, true);
-}
+// Simulation rate, independent of the display rate (render interpolates)
+static constexpr float SIM_HZ = 60.0f;
+static constexpr int MAX_SIM_STEPS = 5; // Per frame; a longer stall is dropped, not replayed
 
 // -------------------------
-// Blit quad vertex
+// Command line
 // -------------------------
-struct BlitVertex {
-    float x, y, z;
-    float u, v;
-
-    static bgfx::VertexLayout layout() {
-        bgfx::VertexLayout l;
-        l.begin()
-            .add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
-            .add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
-        .end();
-        return l;
+static void parseArgs(int argc, char** argv, Platform::Config& platform, RenderPipeline::Config& config,
+                      bool& hotReload) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--canvas") == 0 && i + 1 < argc) {
+            unsigned w = 0, h = 0;
+            if (std::sscanf(argv[++i], "%ux%u", &w, &h) == 2 &&
+                w > 0 && h > 0 && w <= MAX_CANVAS_SIZE && h <= MAX_CANVAS_SIZE) {
+                config.canvasWidth = (uint16_t)w;
+                config.canvasHeight = (uint16_t)h;
+            } else {
+                std::fprintf(stderr, "Ignoring invalid canvas size: %s\n", argv[i]);
+            }
+        } else if (std::strcmp(argv[i], "--sharp") == 0) {
+            config.upscale = RenderPipeline::Upscale::SharpBilinear;
+        } else if (std::strcmp(argv[i], "--renderer") == 0 && i + 1 < argc) {
+            if (!Platform::parseRenderer(argv[++i], platform.renderer)) {
+                std::fprintf(stderr, "Ignoring unknown renderer: %s\n", argv[i]);
+            }
+        } else if (std::strcmp(argv[i], "--hot-reload") == 0) {
+            hotReload = true;
+        }
     }
-};
-
-// -------------------------
-// Letterbox + integer scaling
-// -------------------------
-struct RectPx { int x, y, w, h; };
-
-static RectPx computeIntegerScaledRect(int backW, int backH) {
-    const int scaleX = backW / (int)GAME_W;
-    const int scaleY = backH / (int)GAME_H;
-    const int scale = (scaleX < scaleY) ? scaleX : scaleY;
-    const int s = (scale <= 0) ? 1 : scale;
-    const int w = (int)GAME_W * s;
-    const int h = (int)GAME_H * s;
-    return { (backW - w) / 2, (backH - h) / 2, w, h };
 }
 
-static void rectToClipQuad(const RectPx& r, int backW, int backH, BlitVertex out[4]) {
-    auto pxToClipX = [&](float px) { return (px / (float)backW) * 2.0f - 1.0f; };
-    auto pxToClipY = [&](float py) { return 1.0f - (py / (float)backH) * 2.0f; };
-
-    const float x0 = pxToClipX((float)r.x);
-    const float y0 = pxToClipY((float)r.y);
-    const float x1 = pxToClipX((float)(r.x + r.w));
-    const float y1 = pxToClipY((float)(r.y + r.h));
-
-    out[0] = { x0, y0, 0.0f, 0.0f, 0.0f };
-    out[1] = { x1, y0, 0.0f, 1.0f, 0.0f };
-    out[2] = { x0, y1, 0.0f, 0.0f, 1.0f };
-    out[3] = { x1, y1, 0.0f, 1.0f, 1.0f };
-}
+int main(int argc, char** argv) {
+    Platform::Config platformConfig;
+    platformConfig.title = "Pixel Sim Engine - Step 5 (Scene System)";
+    RenderPipeline::Config canvasConfig;
+    bool hotReloadEnabled = false;
+    parseArgs(argc, argv, platformConfig, canvasConfig, hotReloadEnabled);
 
-int main(int, char**) {
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) != 0) {
-        std::fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
+    // Window, native handles and renderer (Metal / D3D / Vulkan per platform)
+    Platform platform;
+    if (!platform.init(platformConfig)) {
         return 1;
     }
-
-    SDL_Window* window = SDL_CreateWindow(
-        "Pixel Sim Engine - Step 5 (Scene System)",
-        SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-        1280, 720,
-        SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI
-    );
-
-    if (!window) {
-        std::fprintf(stderr, "SDL_CreateWindow failed: %s\n", SDL_GetError());
-        SDL_Quit();
+    auto shader = [&](const char* name) { return platform.shaderPath(name); };
+
+    // --- Canvas and upscale to the window ---
+    RenderPipeline pipeline;
+    const char* blitShader = (canvasConfig.upscale == RenderPipeline::Upscale::SharpBilinear)
+        ? "fs_blit_sharp" : "fs_blit";
+    if (!pipeline.init(shader("vs_blit").c_str(), shader(blitShader).c_str(), canvasConfig,
+                       VIEW_GAME, VIEW_BLIT,
+                       (uint16_t)platform.backWidth(), (uint16_t)platform.backHeight())) {
+        std::fprintf(stderr, "Failed to initialize render pipeline.\n");
+        platform.shutdown();
         return 1;
     }
+    const uint16_t canvasW = pipeline.canvasWidth();
+    const uint16_t canvasH = pipeline.canvasHeight();
+    std::printf("Canvas %ux%u%s\n", canvasW, canvasH,
+                pipeline.isDirect() ? " (direct to backbuffer)" : "");
 
-#if defined(__APPLE__)
-    void* metal_view = SDL_Metal_CreateView(window);
-    if (!metal_view) {
-        std::fprintf(stderr, "SDL_Metal_CreateView failed: %s\n", SDL_GetError());
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return 1;
+    // --- Initialize sprite system ---
+    TextureManager textures;
+    SpriteBatch sprites;
+    
+    // Small sprites and procedural sheets share atlas pages (fewer texture swaps)
+    textures.enableAtlas();
+    
+    // Textures stay updatable in place so edited PNGs can replace them
+    if (hotReloadEnabled) {
+        textures.enableHotReload();
     }
-
-    void* metal_layer = SDL_Metal_GetLayer(metal_view);
-    if (!metal_layer) {
-        std::fprintf(stderr, "SDL_Metal_GetLayer failed: %s\n", SDL_GetError());
-        SDL_Metal_DestroyView(metal_view);
-        SDL_DestroyWindow(window);
-        SDL_Quit();
+    
+    // Pre-decoded textures from pixel_sim_cook (optional; falls back to decoding)
+    textures.openCookedCache(COOKED_CACHE_PATH);
+    
+    // Canvas coordinates and atlas UVs fit 16 bits: half the vertex bandwidth
+    if (!sprites.init(shader("vs_sprite_compact").c_str(), shader("fs_sprite").c_str(),
+                      SpriteBatch::DEFAULT_MAX_SPRITES, SpriteBatch::Geometry::Vertices,
+                      SpriteBatch::VertexFormat::Compact)) {
+        std::fprintf(stderr, "Failed to initialize SpriteBatch.\n");
+        pipeline.shutdown();
+        platform.shutdown();
         return 1;
     }
+    
+    // Scenes draw in painter's order, so write vertices straight to the GPU
+    sprites.setStreaming(true);
+    
+    // Bind several textures per draw so interleaved layers don't split batches
+    if (!sprites.enableTextureSlots(shader("vs_sprite_slots_compact").c_str(),
+                                    shader("fs_sprite_slots").c_str())) {
+        std::fprintf(stderr, "Texture slots unavailable, using one texture per draw.\n");
+    }
+    
+    // Dithered gradient fills (sky, ocean base)
+    if (!sprites.enableGradients(shader("vs_sprite").c_str(), shader("fs_gradient").c_str())) {
+        std::fprintf(stderr, "Gradient shader unavailable, using smooth fills.\n");
+    }
+    
+    // Parallax layers as one cached grid draw each
+    if (!sprites.enableTileGrids(shader("vs_tile_grid").c_str(), shader("fs_sprite").c_str())) {
+        std::fprintf(stderr, "Tile grid shader unavailable, drawing parallax tiles as sprites.\n");
+    }
 
-    bgfx::renderFrame();
-    bgfx::PlatformData pd{};
-    pd.nwh = metal_layer;
-    bgfx::setPlatformData(pd);
-#else
-#   error "This sample is macOS-specific for now."
+    // --- Development: pick up edited textures and shaders ---
+    HotReload hotReload;
+    if (hotReloadEnabled) {
+        HotReload::Config reloadConfig;
+#if defined(ENGINE_ASSET_SOURCE_DIR)
+        reloadConfig.textureDir = ENGINE_ASSET_SOURCE_DIR; // Not the build directory's copy
 #endif
-
-    int backW = 0, backH = 0;
-    SDL_GL_GetDrawableSize(window, &backW, &backH);
-    if (backW <= 0 || backH <= 0) SDL_GetWindowSize(window, &backW, &backH);
-
-    bgfx::Init init;
-    init.type = bgfx::RendererType::Metal;
-    init.vendorId = BGFX_PCI_ID_NONE;
-    init.resolution.width  = (uint32_t)backW;
-    init.resolution.height = (uint32_t)backH;
-    init.resolution.reset  = BGFX_RESET_VSYNC;
-    init.platformData = pd;
-
-    if (!bgfx::init(init)) {
-        std::fprintf(stderr, "bgfx::init failed\n");
-#if defined(__APPLE__)
-        SDL_Metal_DestroyView(metal_view);
+        reloadConfig.shaderDir = Platform::shaderDirectory(platform.renderer());
+#if defined(ENGINE_SHADER_SOURCE_DIR)
+        reloadConfig.shaderSourceDir = ENGINE_SHADER_SOURCE_DIR;
+        reloadConfig.rebuildCommand = std::string("\"") + ENGINE_CMAKE_COMMAND + "\" --build \"" +
+                                      ENGINE_BINARY_DIR + "\" --target shaders";
 #endif
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return 1;
+        if (!hotReload.init(reloadConfig, textures, sprites)) {
+            std::fprintf(stderr, "Hot reload unavailable.\n");
+        }
     }
 
-    // --- Offscreen render target ---
-    bgfx::TextureHandle gameColorTex = bgfx::createTexture2D(
-        (uint16_t)GAME_W, (uint16_t)GAME_H, false, 1,
-        bgfx::TextureFormat::BGRA8, BGFX_TEXTURE_RT
-    );
-    bgfx::FrameBufferHandle gameFbo = bgfx::createFrameBuffer(1, &gameColorTex, true);
+    // --- Profiler HUD ---
+    Profiler& profiler = Profiler::get();
+    profiler.initOverlay(textures);
 
-    // --- Load blit program ---
-    bgfx::ProgramHandle blitProgram = loadProgram("shaders/bin/vs_blit.bin", "shaders/bin/fs_blit.bin");
-    if (!bgfx::isValid(blitProgram)) {
-        std::fprintf(stderr, "Failed to load blit shader program.\n");
-        bgfx::shutdown();
-#if defined(__APPLE__)
-        SDL_Metal_DestroyView(metal_view);
-#endif
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return 1;
+    // --- Static layer cache (same size as the game canvas) ---
+    LayerCache layerCache;
+    if (!layerCache.init(canvasW, canvasH, VIEW_LAYERS)) {
+        std::fprintf(stderr, "Layer cache unavailable, scenes draw every layer each frame.\n");
     }
 
-    bgfx::UniformHandle u_tex = bgfx::createUniform("s_tex", bgfx::UniformType::Sampler);
-    const bgfx::VertexLayout blitLayout = BlitVertex::layout();
-
-    // --- Initialize sprite system ---
-    TextureManager textures;
-    SpriteBatch sprites;
-    
-    if (!sprites.init("shaders/bin/vs_sprite.bin", "shaders/bin/fs_sprite.bin")) {
-        std::fprintf(stderr, "Failed to initialize SpriteBatch.\n");
-        bgfx::shutdown();
-#if defined(__APPLE__)
-        SDL_Metal_DestroyView(metal_view);
-#endif
-        SDL_DestroyWindow(window);
-        SDL_Quit();
-        return 1;
-    }
+    // --- Frame job workers (scene/subsystem updates) ---
+    JobSystem jobs;
+    std::printf("JobSystem: %zu workers\n", jobs.workerCount());
 
     // --- Initialize scene system ---
     SceneManager scenes;
+    scenes.setLayerCache(&layerCache);
+    scenes.setJobSystem(&jobs);
+    scenes.setCanvasSize(canvasW, canvasH);
     
     // Start with the sailing scene
     scenes.switchTo(std::make_unique<SailingScene>(textures));
 
-    // View setup
-    bgfx::setViewClear(VIEW_GAME, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x000000ff, 1.0f, 0);
-    bgfx::setViewClear(VIEW_BLIT, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0x000000ff, 1.0f, 0);
-
     // Timing
     uint32_t frameCount = 0;
     Uint64 lastTicks = SDL_GetPerformanceCounter();
     const Uint64 frequency = SDL_GetPerformanceFrequency();
+    FixedTimestep timestep(1.0f / SIM_HZ, MAX_SIM_STEPS);
     
     std::printf("\n=== Pixel Sim Engine ===\n");
     std::printf("Press SPACE or Click to switch scenes\n");
+    std::printf("Press F1 for the profiler, F2/F3 to capture CSV/JSON\n");
     std::printf("Press ESC to quit\n\n");
     
     bool running = true;
@@ -256,6 +224,8 @@ int main(int, char**) {
         float deltaTime = (float)(currentTicks - lastTicks) / (float)frequency;
         lastTicks = currentTicks;
         
+        profiler.beginFrame();
+        
         // Event handling
         SDL_Event e;
         while (SDL_PollEvent(&e)) {
@@ -266,80 +236,89 @@ int main(int, char**) {
             if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) {
                 running = false;
             }
+            
+            if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F1) {
+                profiler.toggleOverlay();
+            }
+            
+            if (e.type == SDL_KEYDOWN &&
+                (e.key.keysym.sym == SDLK_F2 || e.key.keysym.sym == SDLK_F3)) {
+                if (profiler.isCapturing()) {
+                    profiler.stopCapture();
+                } else {
+                    profiler.startCapture(e.key.keysym.sym == SDLK_F2 ? "profile.csv" : "profile.json");
+                }
+            }
 
             if (e.type == SDL_WINDOWEVENT &&
                 (e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
                  e.window.event == SDL_WINDOWEVENT_RESIZED)) {
-                SDL_GL_GetDrawableSize(window, &backW, &backH);
-                if (backW <= 0 || backH <= 0) SDL_GetWindowSize(window, &backW, &backH);
-                bgfx::reset((uint32_t)backW, (uint32_t)backH, BGFX_RESET_VSYNC);
+                platform.resize();
+                pipeline.resize((uint16_t)platform.backWidth(), (uint16_t)platform.backHeight());
+                layerCache.invalidateAll();
             }
             
             // Pass events to scene
             scenes.handleEvent(e);
         }
 
-        // --- Update scene ---
-        scenes.update(deltaTime);
+        // --- Upload textures decoded in the background ---
+        textures.processUploads();
+        
+        // --- Swap in edited textures and shaders (cached layers redraw) ---
+        if (hotReload.update()) {
+            layerCache.invalidateAll();
+        }
+
+        // --- Update scene (fixed steps) ---
+        const int steps = timestep.advance(deltaTime);
+        for (int i = 0; i < steps; ++i) {
+            scenes.update(timestep.step());
+        }
+
+        // --- Redraw cached layers that changed ---
+        layerCache.render(sprites, deltaTime);
 
         // --- Render to game canvas ---
-        bgfx::setViewFrameBuffer(VIEW_GAME, gameFbo);
-        bgfx::setViewRect(VIEW_GAME, 0, 0, (uint16_t)GAME_W, (uint16_t)GAME_H);
-        bgfx::touch(VIEW_GAME);
-        
-        sprites.begin(VIEW_GAME, (uint16_t)GAME_W, (uint16_t)GAME_H);
+        pipeline.beginFrame();
+        sprites.begin(pipeline.canvasView(), canvasW, canvasH, pipeline.hasDepth());
         
         // Let the scene render
-        scenes.render(sprites);
+        scenes.render(sprites, timestep.alpha());
+        
+        // HUD shows the previous frame's numbers
+        profiler.drawOverlay(sprites, 6, 6);
         
         sprites.end();
+        profiler.recordBatch(sprites.getStats());
 
-        // --- Blit to backbuffer ---
-        bgfx::setViewFrameBuffer(VIEW_BLIT, BGFX_INVALID_HANDLE);
-        bgfx::setViewRect(VIEW_BLIT, 0, 0, (uint16_t)backW, (uint16_t)backH);
-
-        const RectPx dst = computeIntegerScaledRect(backW, backH);
-        BlitVertex quad[4];
-        rectToClipQuad(dst, backW, backH, quad);
-
-        bgfx::TransientVertexBuffer tvb;
-        if (bgfx::getAvailTransientVertexBuffer(4, blitLayout) >= 4) {
-            bgfx::allocTransientVertexBuffer(&tvb, 4, blitLayout);
-            std::memcpy(tvb.data, quad, sizeof(quad));
-
-            bgfx::setVertexBuffer(0, &tvb);
+        // --- Scale to the window ---
+        pipeline.present();
 
-            const uint32_t samplerFlags =
-                BGFX_SAMPLER_MIN_POINT | BGFX_SAMPLER_MAG_POINT |
-                BGFX_SAMPLER_MIP_POINT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP;
-
-            bgfx::setTexture(0, u_tex, gameColorTex, samplerFlags);
-            bgfx::setState(BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A | BGFX_STATE_PT_TRISTRIP);
-            bgfx::submit(VIEW_BLIT, blitProgram);
+        {
+            PROFILE_SCOPE(BgfxFrame);
+            bgfx::frame();
         }
-
-        bgfx::frame();
+        profiler.recordArena(FrameArena::get().getStats());
+        FrameArena::get().nextFrame();
+        profiler.endFrame();
         frameCount++;
         
-        // Print FPS every 5 seconds
+        // Print frame time percentiles every 300 frames
         if (frameCount % 300 == 0) {
-            std::printf("[Frame %u] Running...\n", frameCount);
+            std::printf("[Frame %u] p50 %.2f ms, p99 %.2f ms\n", frameCount,
+                        profiler.frameTimePercentile(50.0f), profiler.frameTimePercentile(99.0f));
         }
     }
 
     // Cleanup
+    profiler.stopCapture();
+    hotReload.shutdown();
+    layerCache.shutdown();
     sprites.shutdown();
     textures.clear();
-    bgfx::destroy(u_tex);
-    bgfx::destroy(blitProgram);
-    bgfx::destroy(gameFbo);
-    bgfx::shutdown();
-
-#if defined(__APPLE__)
-    SDL_Metal_DestroyView(metal_view);
-#endif
-    SDL_DestroyWindow(window);
-    SDL_Quit();
+    pipeline.shutdown();
+    platform.shutdown();
     
     std::printf("Goodbye!\n");
     return 0;
@@ -0,0 +1,63 @@
+/*
+ * CookTextures.cpp - Offline texture cook step for the Pixel Sim Engine
+ *
+ * Builds every scene headless (Noop renderer) with TextureManager
+ * recording enabled, then writes the decoded PNGs and generated sprite
+ * sheets into one cooked cache file. The engine maps that file at
+ * startup instead of decoding and generating the images again.
+ *
+ * Usage (from the directory containing assets/):
+ *   ./pixel_sim_cook [output]   // default assets/textures.cooked
+ */
+
+#include <bgfx/bgfx.h>
+#include <bgfx/platform.h>
+
+#include "TextureManager.h"
+#include "SailingScene.h"
+#include "PortScene.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+static constexpr const char* DEFAULT_OUTPUT = "assets/textures.cooked";
+
+int main(int argc, char** argv) {
+    const std::string output = (argc > 1) ? argv[1] : DEFAULT_OUTPUT;
+
+    // Single-threaded bgfx; textures are created but never drawn
+    bgfx::renderFrame();
+
+    bgfx::Init init;
+    init.type = bgfx::RendererType::Noop;
+    init.vendorId = BGFX_PCI_ID_NONE;
+    init.resolution.width  = 16;
+    init.resolution.height = 16;
+    init.resolution.reset  = BGFX_RESET_NONE;
+
+    if (!bgfx::init(init)) {
+        std::fprintf(stderr, "bgfx::init failed\n");
+        return 1;
+    }
+
+    bool ok;
+    {
+        TextureManager textures;
+        textures.setCookRecording(true);
+
+        // Every scene's full asset set
+        std::unique_ptr<Scene> scenes[] = {
+            std::make_unique<SailingScene>(textures),
+            std::make_unique<PortScene>(textures),
+        };
+        for (auto& scene : scenes) {
+            scene->finishLoading();
+        }
+
+        ok = textures.writeCookedCache(output);
+    }
+
+    bgfx::shutdown();
+    return ok ? 0 : 1;
+}